@@ -0,0 +1,120 @@
+#include "alloc_tracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+#if MINECRAFT_COUNT_ALLOCATIONS
+constexpr size_t kAllocHeaderBytes = alignof(std::max_align_t);
+
+thread_local uint64_t t_heap_allocations = 0;
+thread_local FramePhase t_alloc_phase = FramePhase::Other;
+
+std::array<std::atomic<uint64_t>, kFramePhaseCount> g_allocations{};
+std::array<std::atomic<uint64_t>, kFramePhaseCount> g_frees{};
+std::array<std::atomic<uint64_t>, kFramePhaseCount> g_alloc_bytes{};
+std::atomic<size_t> g_live_bytes{0};
+std::atomic<size_t> g_peak_live_bytes{0};
+
+void RecordAllocation(size_t bytes) {
+  const size_t phase = static_cast<size_t>(t_alloc_phase);
+  ++t_heap_allocations;
+  g_allocations[phase].fetch_add(1, std::memory_order_relaxed);
+  g_alloc_bytes[phase].fetch_add(bytes, std::memory_order_relaxed);
+  const size_t live =
+      g_live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  size_t peak = g_peak_live_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !g_peak_live_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+void RecordFree(size_t bytes) {
+  const size_t phase = static_cast<size_t>(t_alloc_phase);
+  g_frees[phase].fetch_add(1, std::memory_order_relaxed);
+  g_live_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+#endif
+
+AllocStats g_frame_start_stats;
+AllocStats g_last_frame_stats;
+}  // namespace
+
+#if MINECRAFT_COUNT_ALLOCATIONS
+void* operator new(size_t bytes) {
+  void* block = std::malloc(bytes + kAllocHeaderBytes);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *static_cast<size_t*>(block) = bytes;
+  RecordAllocation(bytes);
+  return static_cast<std::byte*>(block) + kAllocHeaderBytes;
+}
+
+void operator delete(void* data) noexcept {
+  if (!data) {
+    return;
+  }
+  std::byte* block = static_cast<std::byte*>(data) - kAllocHeaderBytes;
+  RecordFree(*reinterpret_cast<size_t*>(block));
+  std::free(block);
+}
+
+void operator delete(void* data, size_t) noexcept {
+  ::operator delete(data);
+}
+#endif
+
+uint64_t GetThreadHeapAllocations() {
+#if MINECRAFT_COUNT_ALLOCATIONS
+  return t_heap_allocations;
+#else
+  return 0;
+#endif
+}
+
+AllocStats GetAllocStats() {
+  AllocStats stats;
+#if MINECRAFT_COUNT_ALLOCATIONS
+  for (size_t i = 0; i < kFramePhaseCount; ++i) {
+    stats.phases[i].allocations =
+        g_allocations[i].load(std::memory_order_relaxed);
+    stats.phases[i].frees = g_frees[i].load(std::memory_order_relaxed);
+    stats.phases[i].bytes = g_alloc_bytes[i].load(std::memory_order_relaxed);
+  }
+  stats.live_bytes = g_live_bytes.load(std::memory_order_relaxed);
+  stats.peak_live_bytes = g_peak_live_bytes.load(std::memory_order_relaxed);
+#endif
+  return stats;
+}
+
+AllocStats DiffAllocStats(const AllocStats& now, const AllocStats& then) {
+  AllocStats diff = now;
+  for (size_t i = 0; i < kFramePhaseCount; ++i) {
+    diff.phases[i].allocations -= then.phases[i].allocations;
+    diff.phases[i].frees -= then.phases[i].frees;
+    diff.phases[i].bytes -= then.phases[i].bytes;
+  }
+  return diff;
+}
+
+void MarkAllocFrame() {
+  const AllocStats now = GetAllocStats();
+  g_last_frame_stats = DiffAllocStats(now, g_frame_start_stats);
+  g_frame_start_stats = now;
+}
+
+const AllocStats& GetLastFrameAllocStats() {
+  return g_last_frame_stats;
+}
+
+FramePhase SwapAllocPhase(FramePhase phase) {
+#if MINECRAFT_COUNT_ALLOCATIONS
+  const FramePhase previous = t_alloc_phase;
+  t_alloc_phase = phase;
+  return previous;
+#else
+  return phase;
+#endif
+}
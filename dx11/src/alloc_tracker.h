@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "frame_phase.h"
+
+#ifndef MINECRAFT_COUNT_ALLOCATIONS
+#ifdef _DEBUG
+#define MINECRAFT_COUNT_ALLOCATIONS 1
+#else
+#define MINECRAFT_COUNT_ALLOCATIONS 0
+#endif
+#endif
+
+struct AllocCounters {
+  uint64_t allocations = 0;
+  uint64_t frees = 0;
+  uint64_t bytes = 0;
+};
+
+struct AllocStats {
+  std::array<AllocCounters, kFramePhaseCount> phases{};
+  size_t live_bytes = 0;
+  size_t peak_live_bytes = 0;
+};
+
+uint64_t GetThreadHeapAllocations();
+AllocStats GetAllocStats();
+AllocStats DiffAllocStats(const AllocStats& now, const AllocStats& then);
+void MarkAllocFrame();
+const AllocStats& GetLastFrameAllocStats();
+FramePhase SwapAllocPhase(FramePhase phase);
+
+struct ScopedAllocPhase {
+#if MINECRAFT_COUNT_ALLOCATIONS
+  explicit ScopedAllocPhase(FramePhase phase)
+      : previous(SwapAllocPhase(phase)) {}
+  ~ScopedAllocPhase() { SwapAllocPhase(previous); }
+
+  FramePhase previous;
+#else
+  explicit ScopedAllocPhase(FramePhase) {}
+#endif
+
+  ScopedAllocPhase(const ScopedAllocPhase&) = delete;
+  ScopedAllocPhase& operator=(const ScopedAllocPhase&) = delete;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "alloc_tracker.h"
+#include "world.h"
+
+constexpr int kMeshBenchRadiusChunks = 4;
+constexpr int kMeshBenchWaterLevel = 5;
+constexpr int kMeshBenchMaxHeight = 14;
+
+float NextBenchRandom(uint32_t& state);
+int GetBenchTerrainHeight(int x, int z);
+void FillBenchTerrain(Chunk& chunk);
+void FormatBenchAllocs(const AllocCounters& allocs, char* buffer,
+                       size_t size);
+void FormatBenchHeapDelta(size_t before, size_t after, char* buffer,
+                          size_t size);
+
+void RunCodecBenchmark();
+void RunEntityBenchmark();
+void RunFluidBenchmark();
+void RunLightBenchmark();
+void RunMeshBenchmark();
+void RunLodBenchmark();
+void RunChunkSizeBenchmark();
+void RunMeshCacheBenchmark();
+void RunLayoutBenchmark();
+void RunStreamBenchmark();
+bool RunSoakBenchmark(const char* report_path);
+bool RunSpatialBenchmark();
+bool RunVertexPoolBenchmark();
+void RunProfileBenchmark();
@@ -0,0 +1,67 @@
+#include "bench.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+
+#include "chunk_codec.h"
+
+namespace {
+constexpr int kCodecBenchIterations = 2000;
+
+void BenchmarkChunkCodec(const char* name, const VoxelChunk& chunk) {
+  std::array<uint8_t, kMaxEncodedChunkSize> buffer{};
+  VoxelChunk decoded;
+
+  size_t size = 0;
+  const auto encode_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kCodecBenchIterations; ++i) {
+    size = EncodeChunk(chunk, buffer.data(), buffer.size());
+  }
+  const auto encode_end = std::chrono::steady_clock::now();
+  bool ok = true;
+  for (int i = 0; i < kCodecBenchIterations; ++i) {
+    ok = ok && DecodeChunk(buffer.data(), size, decoded) == size;
+  }
+  const auto decode_end = std::chrono::steady_clock::now();
+  ok = ok && decoded.blocks == chunk.blocks;
+
+  const double megabytes = static_cast<double>(kChunkVolume) *
+                           kCodecBenchIterations / (1024.0 * 1024.0);
+  const double encode_seconds =
+      std::chrono::duration<double>(encode_end - encode_start).count();
+  const double decode_seconds =
+      std::chrono::duration<double>(decode_end - encode_end).count();
+  std::printf("%-10s %5zu bytes/chunk (%5.1f%% of raw) encode:%8.1fMB/s "
+              "decode:%8.1fMB/s%s\n",
+              name, size,
+              100.0 * static_cast<double>(size) / kChunkVolume,
+              megabytes / encode_seconds, megabytes / decode_seconds,
+              ok ? "" : " MISMATCH");
+}
+}  // namespace
+
+void RunCodecBenchmark() {
+  VoxelChunk air;
+  BenchmarkChunkCodec("air", air);
+
+  VoxelChunk flat;
+  GenerateFlatChunk(flat);
+  BenchmarkChunkCodec("flat", flat);
+
+  VoxelChunk edited = flat;
+  uint32_t seed = 0x12345678u;
+  for (int i = 0; i < 64; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    edited.blocks[seed % kChunkVolume] =
+        static_cast<BlockId>((seed >> 16) % kBlockIdCount);
+  }
+  BenchmarkChunkCodec("edited", edited);
+
+  VoxelChunk noise;
+  for (BlockId& id : noise.blocks) {
+    seed = seed * 1664525u + 1013904223u;
+    id = static_cast<BlockId>((seed >> 16) % kBlockIdCount);
+  }
+  BenchmarkChunkCodec("noise", noise);
+}
@@ -0,0 +1,72 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+float NextBenchRandom(uint32_t& state) {
+  state = state * 1664525u + 1013904223u;
+  return static_cast<float>(state >> 8) / 16777216.0f;
+}
+
+int GetBenchTerrainHeight(int x, int z) {
+  const float hills = 3.0f * std::sin(static_cast<float>(x) * 0.21f) +
+                      3.0f * std::cos(static_cast<float>(z) * 0.17f) +
+                      1.5f * std::sin(static_cast<float>(x + z) * 0.53f);
+  uint32_t hash = static_cast<uint32_t>(x) * 73856093u ^
+                  static_cast<uint32_t>(z) * 19349663u;
+  hash = (hash ^ (hash >> 13)) * 0x5bd1e995u;
+  const int jitter = static_cast<int>((hash >> 16) % 3) - 1;
+  return std::clamp(7 + static_cast<int>(hills) + jitter, 1,
+                    kMeshBenchMaxHeight);
+}
+
+void FillBenchTerrain(Chunk& chunk) {
+  for (int lz = 0; lz < kChunkSize; ++lz) {
+    for (int lx = 0; lx < kChunkSize; ++lx) {
+      const int height = GetBenchTerrainHeight(
+          chunk.coord.x * kChunkSize + lx, chunk.coord.z * kChunkSize + lz);
+      for (int ly = 0; ly < kChunkSize; ++ly) {
+        const int y = chunk.coord.y * kChunkSize + ly;
+        BlockId id = BlockId::Air;
+        if (y < height - 3) {
+          id = BlockId::Stone;
+        } else if (y < height) {
+          id = BlockId::Dirt;
+        } else if (y == height) {
+          id = BlockId::Grass;
+        } else if (y <= kMeshBenchWaterLevel) {
+          id = BlockId::Water;
+        } else if (y <= height + 2 && (lx / 4 + lz / 4) % 5 == 0 &&
+                   height > kMeshBenchWaterLevel) {
+          id = BlockId::Leaves;
+        }
+        chunk.voxels.Set(lx, ly, lz, id);
+      }
+    }
+  }
+}
+
+void FormatBenchAllocs(const AllocCounters& allocs, char* buffer,
+                       size_t size) {
+#if MINECRAFT_COUNT_ALLOCATIONS
+  std::snprintf(buffer, size, "%llu (%lluB)",
+                static_cast<unsigned long long>(allocs.allocations),
+                static_cast<unsigned long long>(allocs.bytes));
+#else
+  (void)allocs;
+  std::snprintf(buffer, size, "n/a");
+#endif
+}
+
+void FormatBenchHeapDelta(size_t before, size_t after, char* buffer,
+                          size_t size) {
+#if MINECRAFT_COUNT_ALLOCATIONS
+  std::snprintf(buffer, size, "%lldB",
+                static_cast<long long>(after) - static_cast<long long>(before));
+#else
+  (void)before;
+  (void)after;
+  std::snprintf(buffer, size, "n/a");
+#endif
+}
@@ -0,0 +1,94 @@
+#include "bench.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "entity.h"
+#include "job_system.h"
+
+namespace {
+constexpr int kEntityBenchCounts[] = {1000, 10000, 100000};
+constexpr int kEntityBenchWarmupSteps = 10;
+constexpr int kEntityBenchSteps = 60;
+constexpr int kEntityBenchItemEvery = 4;
+constexpr int kEntityBenchPerChunk = 16;
+constexpr float kEntityBenchStep = 1.0f / 60.0f;
+
+int GetEntityBenchRadius(int count) {
+  int radius = 1;
+  while (4 * radius * radius * kEntityBenchPerChunk < count) {
+    ++radius;
+  }
+  return radius;
+}
+
+void SpawnBenchEntities(EntityStore& store, int count) {
+  const float extent =
+      static_cast<float>(GetEntityBenchRadius(count) * kChunkSize);
+  uint32_t random = 0x1234567u;
+  for (int i = 0; i < count; ++i) {
+    const float x = (NextBenchRandom(random) * 2.0f - 1.0f) * (extent - 1.0f);
+    const float z = (NextBenchRandom(random) * 2.0f - 1.0f) * (extent - 1.0f);
+    const float y = static_cast<float>(GetBenchTerrainHeight(
+                        static_cast<int>(x), static_cast<int>(z))) +
+                    1.0f + NextBenchRandom(random) * 2.0f;
+    if (i % kEntityBenchItemEvery == 0) {
+      SpawnItem(store, {x, y, z}, BlockId::Dirt);
+    } else {
+      SpawnMob(store, {x, y, z});
+    }
+  }
+}
+
+double MeasureEntityUpdate(const World& world, JobSystem& jobs, int count,
+                           int& partitions) {
+  EntityStore store;
+  SpawnBenchEntities(store, count);
+  EntityStats stats;
+  for (int i = 0; i < kEntityBenchWarmupSteps; ++i) {
+    UpdateEntities(store, world, jobs, kEntityBenchStep, stats);
+  }
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kEntityBenchSteps; ++i) {
+    UpdateEntities(store, world, jobs, kEntityBenchStep, stats);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  partitions = stats.partition_count;
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         kEntityBenchSteps;
+}
+}  // namespace
+
+void RunEntityBenchmark() {
+  JobSystem serial;
+  InitJobSystem(serial, 0);
+  JobSystem parallel;
+  InitJobSystem(parallel, -1);
+
+  std::printf("workers:%d entities_per_chunk:%d\n", GetWorkerCount(parallel),
+              kEntityBenchPerChunk);
+  std::printf("%8s %7s %11s %11s %10s %11s %8s\n", "entities", "chunks",
+              "serial_ms", "parallel_ms", "partitions", "ents/ms", "speedup");
+  for (int count : kEntityBenchCounts) {
+    World world;
+    const int radius = GetEntityBenchRadius(count);
+    for (int z = -radius; z < radius; ++z) {
+      for (int x = -radius; x < radius; ++x) {
+        FillBenchTerrain(GetOrCreateChunk(world, {x, 0, z}));
+      }
+    }
+    int serial_partitions = 0;
+    int parallel_partitions = 0;
+    const double serial_ms =
+        MeasureEntityUpdate(world, serial, count, serial_partitions);
+    const double parallel_ms =
+        MeasureEntityUpdate(world, parallel, count, parallel_partitions);
+    std::printf("%8d %7zu %10.3fms %10.3fms %10d %11.0f %7.2fx\n", count,
+                world.chunks.size(), serial_ms, parallel_ms,
+                parallel_partitions,
+                parallel_ms > 0.0 ? count / parallel_ms : 0.0,
+                parallel_ms > 0.0 ? serial_ms / parallel_ms : 0.0);
+  }
+  ShutdownJobSystem(parallel);
+  ShutdownJobSystem(serial);
+}
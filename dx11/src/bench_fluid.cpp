@@ -0,0 +1,78 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "fluid.h"
+#include "job_system.h"
+
+namespace {
+constexpr int kFluidBenchRadiusChunks = 4;
+constexpr int kFluidBenchWallHeight = 4;
+constexpr int kFluidBenchSourceSpacing = 12;
+constexpr int kFluidBenchMaxSteps = 4000;
+}  // namespace
+
+void RunFluidBenchmark() {
+  World world;
+  world.record_changes = true;
+  for (int z = -kFluidBenchRadiusChunks; z < kFluidBenchRadiusChunks; ++z) {
+    for (int x = -kFluidBenchRadiusChunks; x < kFluidBenchRadiusChunks; ++x) {
+      GetOrCreateChunk(world, {x, 0, z});
+    }
+  }
+  const int extent = kFluidBenchRadiusChunks * kChunkSize - 1;
+  const int top = kGroundHeight + kFluidBenchWallHeight - 1;
+  for (int y = kGroundHeight; y <= top; ++y) {
+    for (int i = -extent; i <= extent; ++i) {
+      SetBlock(world, i, y, -extent, BlockId::Stone);
+      SetBlock(world, i, y, extent, BlockId::Stone);
+      SetBlock(world, -extent, y, i, BlockId::Stone);
+      SetBlock(world, extent, y, i, BlockId::Stone);
+    }
+  }
+  world.changes.clear();
+  for (int z = -extent + 1; z < extent; z += kFluidBenchSourceSpacing) {
+    for (int x = -extent + 1; x < extent; x += kFluidBenchSourceSpacing) {
+      SetBlock(world, x, top, z, BlockId::Water);
+    }
+  }
+
+  JobSystem jobs;
+  InitJobSystem(jobs, -1);
+  FluidState fluids;
+  FluidStats stats;
+  int steps = 0;
+  int64_t cell_updates = 0;
+  int64_t cell_writes = 0;
+  float total_ms = 0.0f;
+  float max_ms = 0.0f;
+  int max_cells = 0;
+  do {
+    UpdateFluids(fluids, world, jobs, 1.0f / kFluidStepRate, stats);
+    world.changes.clear();
+    ++steps;
+    cell_updates += stats.cell_updates;
+    cell_writes += stats.cell_writes;
+    total_ms += stats.update_ms;
+    max_ms = std::max(max_ms, stats.update_ms);
+    max_cells = std::max(max_cells, stats.active_cells);
+  } while (stats.active_chunks > 0 && steps < kFluidBenchMaxSteps);
+  ShutdownJobSystem(jobs);
+
+  int water = 0;
+  for (const auto& [coord, chunk] : world.chunks) {
+    for (BlockId id : chunk.voxels.blocks) {
+      water += (id == BlockId::Water) ? 1 : 0;
+    }
+  }
+  std::printf("steps:%d settled:%s water:%d updates:%lld writes:%lld "
+              "peak_active:%d total:%.1fms step_max:%.3fms "
+              "cells/s:%.0f\n",
+              steps, stats.active_chunks == 0 ? "yes" : "no", water,
+              static_cast<long long>(cell_updates),
+              static_cast<long long>(cell_writes), max_cells, total_ms, max_ms,
+              (total_ms > 0.0f) ? static_cast<double>(cell_updates) * 1000.0 /
+                                      static_cast<double>(total_ms)
+                                : 0.0);
+}
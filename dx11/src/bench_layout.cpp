@@ -0,0 +1,117 @@
+#include "bench.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "collision.h"
+#include "light.h"
+
+namespace {
+constexpr int kLayoutBenchMeshPasses = 4;
+constexpr int kLayoutBenchRays = 200000;
+constexpr int kLayoutBenchBodies = 2000;
+constexpr int kLayoutBenchBodySteps = 120;
+constexpr int kLayoutBenchStepRate = 60;
+constexpr int kLayoutBenchBoxes = 200000;
+constexpr float kLayoutBenchBoxSize = 2.6f;
+}  // namespace
+
+void RunLayoutBenchmark() {
+  World world;
+  for (int z = -kMeshBenchRadiusChunks; z < kMeshBenchRadiusChunks; ++z) {
+    for (int x = -kMeshBenchRadiusChunks; x < kMeshBenchRadiusChunks; ++x) {
+      FillBenchTerrain(GetOrCreateChunk(world, {x, 0, z}));
+    }
+  }
+  world.lighting = true;
+  const auto light_start = std::chrono::steady_clock::now();
+  for (auto& [coord, chunk] : world.chunks) {
+    InitChunkLight(world, chunk);
+  }
+  const auto light_end = std::chrono::steady_clock::now();
+
+  MeshGrid grid;
+  ChunkMeshData mesh;
+  size_t quads = 0;
+  const auto mesh_start = std::chrono::steady_clock::now();
+  for (int pass = 0; pass < kLayoutBenchMeshPasses; ++pass) {
+    for (const auto& [coord, chunk] : world.chunks) {
+      FillMeshGrid(world, chunk, 0, grid);
+      BuildVoxelMesh(grid, true, mesh);
+      quads += mesh.layers[0].size() / 6;
+    }
+  }
+  const auto mesh_end = std::chrono::steady_clock::now();
+
+  const float extent =
+      static_cast<float>(kMeshBenchRadiusChunks * kChunkSize) - 1.0f;
+  uint32_t random = 12345u;
+  int hits = 0;
+  const auto ray_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kLayoutBenchRays; ++i) {
+    const DirectX::XMFLOAT3 origin{(NextBenchRandom(random) * 2.0f - 1.0f) *
+                                       extent,
+                                   static_cast<float>(kMeshBenchMaxHeight) + 1.5f,
+                                   (NextBenchRandom(random) * 2.0f - 1.0f) *
+                                       extent};
+    const DirectX::XMFLOAT3 direction{NextBenchRandom(random) * 2.0f - 1.0f,
+                                      -NextBenchRandom(random) - 0.05f,
+                                      NextBenchRandom(random) * 2.0f - 1.0f};
+    hits += RaycastVoxel(world, origin, direction, 32.0f).hit ? 1 : 0;
+  }
+  const auto ray_end = std::chrono::steady_clock::now();
+
+  std::vector<BodyState> bodies(kLayoutBenchBodies);
+  for (BodyState& body : bodies) {
+    body.position = {(NextBenchRandom(random) * 1.6f - 0.8f) * extent,
+                     static_cast<float>(kMeshBenchMaxHeight) + 1.0f,
+                     (NextBenchRandom(random) * 1.6f - 0.8f) * extent};
+    body.velocity = {NextBenchRandom(random) * 8.0f - 4.0f, 0.0f,
+                     NextBenchRandom(random) * 8.0f - 4.0f};
+    body.radius = 0.3f;
+    body.height = 1.8f;
+    body.step_height = 0.6f;
+  }
+  const float dt = 1.0f / static_cast<float>(kLayoutBenchStepRate);
+  const auto body_start = std::chrono::steady_clock::now();
+  for (int step = 0; step < kLayoutBenchBodySteps; ++step) {
+    for (BodyState& body : bodies) {
+      IntegrateBody(body, world, -20.0f, dt);
+    }
+  }
+  const auto body_end = std::chrono::steady_clock::now();
+
+  int clear_boxes = 0;
+  const auto box_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kLayoutBenchBoxes; ++i) {
+    const float x = (NextBenchRandom(random) * 2.0f - 1.0f) * extent;
+    const float y = NextBenchRandom(random) *
+                    static_cast<float>(kMeshBenchMaxHeight + 2);
+    const float z = (NextBenchRandom(random) * 2.0f - 1.0f) * extent;
+    clear_boxes += IsAabbClear(world, {x, y, z, x + kLayoutBenchBoxSize,
+                                       y + kLayoutBenchBoxSize,
+                                       z + kLayoutBenchBoxSize})
+                       ? 1
+                       : 0;
+  }
+  const auto box_end = std::chrono::steady_clock::now();
+
+  const auto ms = [](auto begin, auto end) {
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+  };
+  std::printf("layout:%s light:%.1fms mesh:%.3fms/chunk quads:%zu "
+              "raycast:%.0fns/ray hits:%d collision:%.0fns/step "
+              "aabb:%.0fns/query clear:%d\n",
+              kChunkLayout == ChunkLayout::Morton ? "morton" : "linear",
+              ms(light_start, light_end),
+              ms(mesh_start, mesh_end) /
+                  static_cast<double>(world.chunks.size() *
+                                      kLayoutBenchMeshPasses),
+              quads / kLayoutBenchMeshPasses,
+              ms(ray_start, ray_end) * 1e6 / kLayoutBenchRays, hits,
+              ms(body_start, body_end) * 1e6 /
+                  (static_cast<double>(kLayoutBenchBodies) *
+                   kLayoutBenchBodySteps),
+              ms(box_start, box_end) * 1e6 / kLayoutBenchBoxes, clear_boxes);
+}
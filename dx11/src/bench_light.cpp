@@ -0,0 +1,48 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+constexpr int kLightBenchRadiusChunks = 4;
+constexpr int kLightBenchEdits = 2000;
+}  // namespace
+
+void RunLightBenchmark() {
+  World world;
+  world.lighting = true;
+  const auto init_start = std::chrono::steady_clock::now();
+  for (int z = -kLightBenchRadiusChunks; z < kLightBenchRadiusChunks; ++z) {
+    for (int x = -kLightBenchRadiusChunks; x < kLightBenchRadiusChunks; ++x) {
+      GetOrCreateChunk(world, {x, 0, z});
+    }
+  }
+  const auto init_end = std::chrono::steady_clock::now();
+  const double init_ms =
+      std::chrono::duration<double, std::milli>(init_end - init_start)
+          .count() /
+      static_cast<double>(world.chunks.size());
+
+  const BlockId edits[] = {BlockId::Stone, BlockId::Air, BlockId::Lava,
+                           BlockId::Air};
+  const int extent = kLightBenchRadiusChunks * kChunkSize - 1;
+  uint32_t seed = 0x2468ACEu;
+  double total_us = 0.0;
+  double max_us = 0.0;
+  for (int i = 0; i < kLightBenchEdits; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    const int x = static_cast<int>((seed >> 8) % (2 * extent)) - extent;
+    const int z = static_cast<int>((seed >> 20) % (2 * extent)) - extent;
+    const int y = kGroundHeight + static_cast<int>((seed >> 4) % 6);
+    const auto start = std::chrono::steady_clock::now();
+    SetBlock(world, x, y, z, edits[i % 4]);
+    const auto end = std::chrono::steady_clock::now();
+    const double us =
+        std::chrono::duration<double, std::micro>(end - start).count();
+    total_us += us;
+    max_us = std::max(max_us, us);
+  }
+  std::printf("chunk_init:%.3fms edits:%d edit_avg:%.1fus edit_max:%.1fus\n",
+              init_ms, kLightBenchEdits, total_us / kLightBenchEdits, max_us);
+}
@@ -0,0 +1,69 @@
+#include <cstdio>
+
+#include "bench.h"
+#include "chunk_pool.h"
+#include "command_line.h"
+
+namespace {
+struct BenchEntry {
+  const char* flag;
+  bool (*run)();
+};
+
+const char* g_soak_report_path = nullptr;
+
+bool RunSoakToReport() {
+  return RunSoakBenchmark(g_soak_report_path);
+}
+
+template <void (*Run)()>
+bool RunAlwaysPasses() {
+  Run();
+  return true;
+}
+
+constexpr BenchEntry kBenches[] = {
+    {"--codec-bench", RunAlwaysPasses<RunCodecBenchmark>},
+    {"--entity-bench", RunAlwaysPasses<RunEntityBenchmark>},
+    {"--fluid-bench", RunAlwaysPasses<RunFluidBenchmark>},
+    {"--light-bench", RunAlwaysPasses<RunLightBenchmark>},
+    {"--mesh-bench", RunAlwaysPasses<RunMeshBenchmark>},
+    {"--lod-bench", RunAlwaysPasses<RunLodBenchmark>},
+    {"--chunk-bench", RunAlwaysPasses<RunChunkSizeBenchmark>},
+    {"--mesh-cache-bench", RunAlwaysPasses<RunMeshCacheBenchmark>},
+    {"--layout-bench", RunAlwaysPasses<RunLayoutBenchmark>},
+    {"--stream-bench", RunAlwaysPasses<RunStreamBenchmark>},
+    {"--soak-bench", RunSoakToReport},
+    {"--spatial-bench", RunSpatialBenchmark},
+    {"--vertex-pool-bench", RunVertexPoolBenchmark},
+    {"--profile-bench", RunAlwaysPasses<RunProfileBenchmark>},
+};
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (HasArg(argc, argv, "--large-pages")) {
+    ChunkPoolConfig pool;
+    pool.large_pages = true;
+    ConfigureChunkPool(pool);
+  }
+  g_soak_report_path = ParseStringArg(argc, argv, "--soak-out", nullptr);
+  const bool run_all = HasArg(argc, argv, "--all");
+  bool ran = false;
+  bool passed = true;
+  for (const BenchEntry& bench : kBenches) {
+    if (run_all || HasArg(argc, argv, bench.flag)) {
+      passed = bench.run() && passed;
+      ran = true;
+    }
+  }
+  if (!ran) {
+    std::fprintf(stderr, "usage: %s [--all] [--large-pages] [--soak-out PATH]",
+                 argv[0]);
+    for (const BenchEntry& bench : kBenches) {
+      std::fprintf(stderr, " [%s]", bench.flag);
+    }
+    std::fprintf(stderr, "\n");
+    return 1;
+  }
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "alloc_tracker.h"
+#include "chunk_mesh_cache.h"
+#include "memory_stats.h"
+
+namespace {
+constexpr int kSoakBenchWarmupSteps = 256;
+constexpr int kSoakBenchSteps = 8192;
+constexpr int kSoakBenchReportSteps = 512;
+constexpr int kSoakBenchTurnSteps = 96;
+constexpr double kSoakBenchStepSeconds = 1.0 / 60.0;
+}  // namespace
+
+bool RunSoakBenchmark(const char* report_path) {
+  World world;
+  world.lighting = true;
+  ChunkMeshCache meshes;
+  InitChunkMeshCache(meshes);
+  uint64_t uploaded_vertices = 0;
+  const MeshUploadFn upload = [&](const MeshBuffer& mesh,
+                                  const std::vector<ChunkVertex>&) {
+    uploaded_vertices += mesh.vertex_count;
+    return true;
+  };
+  const float step = static_cast<float>(kChunkSize) * 0.5f;
+  DirectX::XMFLOAT3 camera{0.0f, 8.0f, 0.0f};
+  bool uploaded = true;
+  const auto fly = [&](int i) {
+    const float heading = static_cast<float>(i / kSoakBenchTurnSteps) * 2.4f;
+    camera.x += std::cos(heading) * step;
+    camera.z += std::sin(heading) * step;
+    StreamChunks(world, camera);
+    uploaded = UpdateChunkMeshCache(meshes, world, camera, upload) && uploaded;
+  };
+  const auto track_peaks = [](std::array<size_t, kMemoryCategoryCount>& peaks) {
+    const MemoryStats memory = GetMemoryStats();
+    for (size_t c = 0; c < kMemoryCategoryCount; ++c) {
+      peaks[c] = std::max(peaks[c], memory.categories[c].bytes);
+    }
+  };
+
+  FILE* report = stdout;
+  if (report_path) {
+    report = std::fopen(report_path, "w");
+    if (!report) {
+      std::fprintf(stderr, "Failed to open soak report %s\n", report_path);
+      return false;
+    }
+  }
+  std::array<size_t, kMemoryCategoryCount> warm_peaks{};
+  for (int i = 0; i < kSoakBenchWarmupSteps; ++i) {
+    fly(i);
+    track_peaks(warm_peaks);
+  }
+  const size_t warm_heap = GetAllocStats().live_bytes;
+  std::array<size_t, kMemoryCategoryCount> soak_peaks{};
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= kSoakBenchSteps; ++i) {
+    fly(kSoakBenchWarmupSteps + i);
+    track_peaks(soak_peaks);
+    if (i % kSoakBenchReportSteps == 0) {
+      WriteMemoryReport(report, i * kSoakBenchStepSeconds);
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+  if (report != stdout) {
+    std::fclose(report);
+  }
+
+  bool grew = false;
+  char heap_text[64];
+  FormatBenchHeapDelta(warm_heap, GetAllocStats().live_bytes, heap_text,
+                       sizeof(heap_text));
+  std::printf("soak:%d steps %.3fms/step chunks:%zu meshes:%zu "
+              "uploaded:%.1fMB heap_delta:%s\n",
+              kSoakBenchSteps,
+              std::chrono::duration<double, std::milli>(end - start).count() /
+                  kSoakBenchSteps,
+              world.chunks.size(), meshes.mesh_cache.size(),
+              static_cast<double>(uploaded_vertices * sizeof(ChunkVertex)) /
+                  (1024.0 * 1024.0),
+              heap_text);
+  for (size_t c = 0; c < kMemoryCategoryCount; ++c) {
+    const bool category_grew = soak_peaks[c] > warm_peaks[c];
+    grew = grew || category_grew;
+    std::printf("  %-13s warm_peak:%8.2fMB soak_peak:%8.2fMB %s\n",
+                GetMemoryCategoryName(static_cast<MemoryCategory>(c)),
+                static_cast<double>(warm_peaks[c]) / (1024.0 * 1024.0),
+                static_cast<double>(soak_peaks[c]) / (1024.0 * 1024.0),
+                category_grew ? "GREW" : "ok");
+  }
+  ClearChunkMeshCache(meshes);
+  std::printf("soak: result:%s\n", !grew && uploaded ? "ok" : "FAILED");
+  return !grew && uploaded;
+}
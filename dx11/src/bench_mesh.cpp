@@ -0,0 +1,218 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+#include "alloc_tracker.h"
+#include "light.h"
+
+namespace {
+constexpr std::array<int, 3> kLodBenchRadii = {8, 16, 32};
+constexpr int kChunkBenchExtentBlocks = 256;
+constexpr int kChunkBenchHeightBlocks = 32;
+
+void BenchmarkMeshCache(const char* name, const World& world) {
+  MeshGrid grid;
+  ChunkMeshData mesh;
+  std::unordered_map<uint64_t, size_t> cache;
+  int hits = 0;
+  size_t total_bytes = 0;
+  size_t unique_bytes = 0;
+  double mesh_ms = 0.0;
+  double hash_ms = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& [coord, chunk] : world.chunks) {
+    const auto fill_start = std::chrono::steady_clock::now();
+    FillMeshGrid(world, chunk, 0, grid);
+    const uint64_t key = HashMeshGrid(grid);
+    const auto fill_end = std::chrono::steady_clock::now();
+    hash_ms +=
+        std::chrono::duration<double, std::milli>(fill_end - fill_start).count();
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+      BuildVoxelMesh(grid, true, mesh);
+      size_t bytes = 0;
+      for (const std::vector<ChunkVertex>& layer : mesh.layers) {
+        bytes += layer.size() * sizeof(ChunkVertex);
+      }
+      it = cache.emplace(key, bytes).first;
+      unique_bytes += bytes;
+      mesh_ms += std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - fill_end)
+                     .count();
+    } else {
+      ++hits;
+    }
+    total_bytes += it->second;
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const int chunks = static_cast<int>(world.chunks.size());
+  const int misses = chunks - hits;
+  const double saved_ms =
+      misses > 0 ? mesh_ms / static_cast<double>(misses) * hits : 0.0;
+  std::printf("%s chunks:%d hits:%d hit_rate:%.1f%% hash:%.1fms mesh:%.1fms "
+              "total:%.1fms saved:%.1fms gpu:%zuKB saved:%zuKB\n",
+              name, chunks, hits, 100.0 * hits / std::max(chunks, 1), hash_ms,
+              mesh_ms,
+              std::chrono::duration<double, std::milli>(end - start).count(),
+              saved_ms, unique_bytes / 1024, (total_bytes - unique_bytes) / 1024);
+}
+}  // namespace
+
+void RunMeshBenchmark() {
+  World world;
+  for (int z = -kMeshBenchRadiusChunks; z < kMeshBenchRadiusChunks; ++z) {
+    for (int x = -kMeshBenchRadiusChunks; x < kMeshBenchRadiusChunks; ++x) {
+      FillBenchTerrain(GetOrCreateChunk(world, {x, 0, z}));
+    }
+  }
+  world.lighting = true;
+  for (auto& [coord, chunk] : world.chunks) {
+    InitChunkLight(world, chunk);
+  }
+
+  MeshGrid grid;
+  ChunkMeshData mesh;
+  ReserveMeshScratch(grid, mesh);
+  for (bool ambient_occlusion : {false, true}) {
+    std::array<size_t, kRenderLayerCount> quads{};
+    const AllocStats allocs_before = GetAllocStats();
+    const auto start = std::chrono::steady_clock::now();
+    {
+      const ScopedAllocPhase alloc_phase(FramePhase::UpdateChunkMeshes);
+      for (const auto& [coord, chunk] : world.chunks) {
+        FillMeshGrid(world, chunk, 0, grid);
+        BuildVoxelMesh(grid, ambient_occlusion, mesh);
+        for (size_t layer = 0; layer < quads.size(); ++layer) {
+          quads[layer] += mesh.layers[layer].size() / 6;
+        }
+      }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const AllocCounters allocs =
+        DiffAllocStats(GetAllocStats(), allocs_before)
+            .phases[static_cast<size_t>(FramePhase::UpdateChunkMeshes)];
+    char alloc_text[64];
+    FormatBenchAllocs(allocs, alloc_text, sizeof(alloc_text));
+    std::printf("ao:%s chunks:%zu quads:%zu opaque:%zu cutout:%zu "
+                "transparent:%zu mesh:%.3fms/chunk allocs:%s\n",
+                ambient_occlusion ? "on " : "off", world.chunks.size(),
+                quads[0] + quads[1] + quads[2], quads[0], quads[1], quads[2],
+                std::chrono::duration<double, std::milli>(end - start).count() /
+                    static_cast<double>(world.chunks.size()),
+                alloc_text);
+  }
+}
+
+void RunLodBenchmark() {
+  World world;
+  const int max_radius = kLodBenchRadii.back();
+  for (int z = -max_radius; z <= max_radius; ++z) {
+    for (int x = -max_radius; x <= max_radius; ++x) {
+      FillBenchTerrain(GetOrCreateChunk(world, {x, 0, z}));
+    }
+  }
+
+  MeshGrid grid;
+  ChunkMeshData mesh;
+  const Int3 camera_chunk{0, 0, 0};
+  for (int radius : kLodBenchRadii) {
+    for (bool use_lod : {false, true}) {
+      size_t vertices = 0;
+      int chunks = 0;
+      const auto start = std::chrono::steady_clock::now();
+      for (const auto& [coord, chunk] : world.chunks) {
+        if (std::abs(coord.x) > radius || std::abs(coord.z) > radius) {
+          continue;
+        }
+        const int lod = use_lod ? SelectChunkLod(coord, camera_chunk) : 0;
+        FillMeshGrid(world, chunk, lod, grid);
+        BuildVoxelMesh(grid, lod == 0, mesh);
+        for (const std::vector<ChunkVertex>& layer : mesh.layers) {
+          vertices += layer.size();
+        }
+        ++chunks;
+      }
+      const auto end = std::chrono::steady_clock::now();
+      std::printf("radius:%d lod:%s chunks:%d vertices:%zu mesh:%.1fms\n",
+                  radius, use_lod ? "on " : "off", chunks, vertices,
+                  std::chrono::duration<double, std::milli>(end - start)
+                      .count());
+    }
+  }
+}
+
+void RunChunkSizeBenchmark() {
+  const int extent = kChunkBenchExtentBlocks / kChunkSize / 2;
+  const int layers = std::max(kChunkBenchHeightBlocks / kChunkSize, 1);
+  World world;
+  for (int z = -extent; z < extent; ++z) {
+    for (int y = 0; y < layers; ++y) {
+      for (int x = -extent; x < extent; ++x) {
+        FillBenchTerrain(GetOrCreateChunk(world, {x, y, z}));
+      }
+    }
+  }
+  world.lighting = true;
+  for (auto& [coord, chunk] : world.chunks) {
+    InitChunkLight(world, chunk);
+  }
+
+  MeshGrid grid;
+  ChunkMeshData mesh;
+  size_t vertices = 0;
+  int draws = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& [coord, chunk] : world.chunks) {
+    FillMeshGrid(world, chunk, 0, grid);
+    BuildVoxelMesh(grid, true, mesh);
+    for (const std::vector<ChunkVertex>& layer : mesh.layers) {
+      vertices += layer.size();
+      draws += layer.empty() ? 0 : 1;
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const size_t chunks = world.chunks.size();
+  const double mesh_ms =
+      std::chrono::duration<double, std::milli>(end - start).count();
+  size_t chunk_bytes = 0;
+  for (const auto& [coord, chunk] : world.chunks) {
+    chunk_bytes += GetChunkMemoryBytes(chunk);
+  }
+  std::printf("chunk:%d^3 area:%dx%dx%d chunks:%zu draws:%d vertices:%zu "
+              "mesh:%.1fms (%.3fms/chunk) chunk_mem:%.1fMB mesh:%.1fMB\n",
+              kChunkSize, kChunkBenchExtentBlocks, layers * kChunkSize,
+              kChunkBenchExtentBlocks, chunks, draws, vertices, mesh_ms,
+              mesh_ms / static_cast<double>(chunks),
+              static_cast<double>(chunk_bytes) / (1024.0 * 1024.0),
+              static_cast<double>(vertices * sizeof(ChunkVertex)) /
+                  (1024.0 * 1024.0));
+}
+
+void RunMeshCacheBenchmark() {
+  World flat;
+  flat.lighting = true;
+  for (int z = -kMeshBenchRadiusChunks; z <= kMeshBenchRadiusChunks; ++z) {
+    for (int x = -kMeshBenchRadiusChunks; x <= kMeshBenchRadiusChunks; ++x) {
+      GetOrCreateChunk(flat, {x, 0, z});
+    }
+  }
+  BenchmarkMeshCache("flat", flat);
+
+  World hills;
+  for (int z = -kMeshBenchRadiusChunks; z <= kMeshBenchRadiusChunks; ++z) {
+    for (int x = -kMeshBenchRadiusChunks; x <= kMeshBenchRadiusChunks; ++x) {
+      FillBenchTerrain(GetOrCreateChunk(hills, {x, 0, z}));
+    }
+  }
+  hills.lighting = true;
+  for (auto& [coord, chunk] : hills.chunks) {
+    InitChunkLight(hills, chunk);
+  }
+  BenchmarkMeshCache("hills", hills);
+}
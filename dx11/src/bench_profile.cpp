@@ -0,0 +1,34 @@
+#include "bench.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "profiler.h"
+
+namespace {
+constexpr int kProfileBenchScopes = 1000000;
+
+double MeasureProfileScopes() {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kProfileBenchScopes; ++i) {
+    const ScopedProfile profile("ProfileBench");
+  }
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         kProfileBenchScopes;
+}
+}  // namespace
+
+void RunProfileBenchmark() {
+  SetProfilerThreadName("main");
+  SetProfilerEnabled(false);
+  const double disabled_ns = MeasureProfileScopes();
+  SetProfilerEnabled(true);
+  const double enabled_ns = MeasureProfileScopes();
+  const bool written = WriteChromeTrace("profile_bench.json");
+  SetProfilerEnabled(false);
+  std::printf("profile: disabled:%.1fns/scope enabled:%.1fns/scope "
+              "ring:%zu events trace:%s\n",
+              disabled_ns, enabled_ns, kProfileRingEvents,
+              written ? "profile_bench.json" : "failed");
+}
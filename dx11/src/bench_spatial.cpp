@@ -0,0 +1,108 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "spatial_hash.h"
+
+namespace {
+constexpr int kSpatialBenchCounts[] = {1000, 10000, 100000};
+constexpr int kSpatialBenchQueries = 2000;
+constexpr int kSpatialBenchPerChunk = 16;
+constexpr float kSpatialBenchRadius = 4.0f;
+constexpr float kSpatialBenchHeight = 32.0f;
+
+void QueryBruteForceRadius(const std::vector<float>& xs,
+                           const std::vector<float>& ys,
+                           const std::vector<float>& zs,
+                           const DirectX::XMFLOAT3& center, float radius,
+                           std::vector<uint32_t>& out) {
+  out.clear();
+  const float radius_sq = radius * radius;
+  for (size_t i = 0; i < xs.size(); ++i) {
+    const float dx = xs[i] - center.x;
+    const float dy = ys[i] - center.y;
+    const float dz = zs[i] - center.z;
+    if (dx * dx + dy * dy + dz * dz <= radius_sq) {
+      out.push_back(static_cast<uint32_t>(i));
+    }
+  }
+}
+}  // namespace
+
+bool RunSpatialBenchmark() {
+  std::printf("%8s %10s %12s %12s %9s %10s %s\n", "entities", "build_ms",
+              "hash_q/ms", "brute_q/ms", "speedup", "neighbors", "result");
+  bool passed = true;
+  for (int count : kSpatialBenchCounts) {
+    int chunks = 1;
+    while (chunks * chunks * kSpatialBenchPerChunk < count) {
+      ++chunks;
+    }
+    const float extent = static_cast<float>(chunks * kChunkSize);
+    uint32_t random = 0x5eed1234u;
+    std::vector<float> xs(static_cast<size_t>(count));
+    std::vector<float> ys(static_cast<size_t>(count));
+    std::vector<float> zs(static_cast<size_t>(count));
+    for (size_t i = 0; i < xs.size(); ++i) {
+      xs[i] = (NextBenchRandom(random) - 0.5f) * extent;
+      ys[i] = NextBenchRandom(random) * kSpatialBenchHeight;
+      zs[i] = (NextBenchRandom(random) - 0.5f) * extent;
+    }
+    std::vector<DirectX::XMFLOAT3> centers(kSpatialBenchQueries);
+    for (DirectX::XMFLOAT3& center : centers) {
+      const size_t index = static_cast<size_t>(
+          NextBenchRandom(random) * static_cast<float>(count - 1));
+      center = {xs[index], ys[index], zs[index]};
+    }
+
+    SpatialHash hash;
+    const auto build_start = std::chrono::steady_clock::now();
+    RebuildSpatialHash(hash, xs.data(), ys.data(), zs.data(), xs.size());
+    const auto build_end = std::chrono::steady_clock::now();
+
+    std::vector<std::vector<uint32_t>> hash_results(centers.size());
+    const auto hash_start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < centers.size(); ++q) {
+      QuerySpatialRadius(hash, centers[q], kSpatialBenchRadius,
+                         hash_results[q]);
+    }
+    const auto hash_end = std::chrono::steady_clock::now();
+
+    std::vector<std::vector<uint32_t>> brute_results(centers.size());
+    const auto brute_start = std::chrono::steady_clock::now();
+    for (size_t q = 0; q < centers.size(); ++q) {
+      QueryBruteForceRadius(xs, ys, zs, centers[q], kSpatialBenchRadius,
+                            brute_results[q]);
+    }
+    const auto brute_end = std::chrono::steady_clock::now();
+
+    bool matched = true;
+    size_t neighbors = 0;
+    for (size_t q = 0; q < centers.size(); ++q) {
+      std::sort(hash_results[q].begin(), hash_results[q].end());
+      matched = matched && hash_results[q] == brute_results[q];
+      neighbors += brute_results[q].size();
+    }
+    passed = passed && matched;
+
+    const double hash_ms =
+        std::chrono::duration<double, std::milli>(hash_end - hash_start)
+            .count();
+    const double brute_ms =
+        std::chrono::duration<double, std::milli>(brute_end - brute_start)
+            .count();
+    std::printf("%8d %9.3fms %12.0f %12.1f %8.1fx %10.1f %s\n", count,
+                std::chrono::duration<double, std::milli>(build_end -
+                                                          build_start)
+                    .count(),
+                hash_ms > 0.0 ? kSpatialBenchQueries / hash_ms : 0.0,
+                brute_ms > 0.0 ? kSpatialBenchQueries / brute_ms : 0.0,
+                hash_ms > 0.0 ? brute_ms / hash_ms : 0.0,
+                static_cast<double>(neighbors) / kSpatialBenchQueries,
+                matched ? "ok" : "MISMATCH");
+  }
+  return passed;
+}
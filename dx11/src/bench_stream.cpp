@@ -0,0 +1,53 @@
+#include "bench.h"
+
+#include <chrono>
+#include <cstdio>
+
+#include "alloc_tracker.h"
+#include "chunk_pool.h"
+
+namespace {
+constexpr int kStreamBenchWarmupSteps = 64;
+constexpr int kStreamBenchSteps = 512;
+}  // namespace
+
+void RunStreamBenchmark() {
+  World world;
+  const float step = static_cast<float>(kChunkSize);
+  DirectX::XMFLOAT3 camera{0.0f, 8.0f, 0.0f};
+  for (int i = 0; i < kStreamBenchWarmupSteps; ++i) {
+    camera.x += step;
+    StreamChunks(world, camera);
+  }
+  const uint64_t created = world.chunks_created;
+  const ChunkPoolStats warm = GetChunkPoolStats();
+  const AllocStats allocs_before = GetAllocStats();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kStreamBenchSteps; ++i) {
+    camera.x += (i / 64) % 2 == 0 ? step : -step;
+    camera.z += step;
+    StreamChunks(world, camera);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const AllocCounters allocs =
+      DiffAllocStats(GetAllocStats(), allocs_before)
+          .phases[static_cast<size_t>(FramePhase::StreamChunks)];
+  const ChunkPoolStats pool = GetChunkPoolStats();
+  char alloc_text[64];
+  FormatBenchAllocs(allocs, alloc_text, sizeof(alloc_text));
+  std::printf("stream:%.3fms/step allocs:%s chunks:%zu created:%llu "
+              "steady_created:%llu recycled:%llu slabs:%zu high_water:%zu "
+              "arenas:%zu (%.1fMB) steady_arenas:%zu heap_fallbacks:%llu "
+              "large_pages:%s\n",
+              std::chrono::duration<double, std::milli>(end - start).count() /
+                  kStreamBenchSteps,
+              alloc_text, world.chunks.size(),
+              static_cast<unsigned long long>(world.chunks_created),
+              static_cast<unsigned long long>(world.chunks_created - created),
+              static_cast<unsigned long long>(world.chunks_recycled),
+              pool.slabs_in_use, pool.slabs_high_water, pool.arena_count,
+              static_cast<double>(pool.arena_bytes) / (1024.0 * 1024.0),
+              pool.arena_count - warm.arena_count,
+              static_cast<unsigned long long>(pool.heap_fallbacks),
+              pool.large_pages ? "yes" : "no");
+}
@@ -0,0 +1,88 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "range_allocator.h"
+
+namespace {
+constexpr int kVertexPoolBenchMeshes = 2048;
+constexpr int kVertexPoolBenchOps = 200000;
+constexpr int kVertexPoolBenchValidateOps = 1000;
+constexpr float kVertexPoolBenchMaxWaste = 0.3f;
+}  // namespace
+
+bool RunVertexPoolBenchmark() {
+  World world;
+  for (int z = -kMeshBenchRadiusChunks; z < kMeshBenchRadiusChunks; ++z) {
+    for (int x = -kMeshBenchRadiusChunks; x < kMeshBenchRadiusChunks; ++x) {
+      FillBenchTerrain(GetOrCreateChunk(world, {x, 0, z}));
+    }
+  }
+  MeshGrid grid;
+  ChunkMeshData mesh;
+  std::vector<uint32_t> sizes;
+  for (const auto& [coord, chunk] : world.chunks) {
+    FillMeshGrid(world, chunk, 0, grid);
+    BuildVoxelMesh(grid, true, mesh);
+    for (const auto& layer : mesh.layers) {
+      if (!layer.empty()) {
+        sizes.push_back(static_cast<uint32_t>(layer.size()));
+      }
+    }
+  }
+
+  uint32_t random = 12345u;
+  const auto pick_size = [&]() {
+    const size_t index = static_cast<size_t>(NextBenchRandom(random) *
+                                             static_cast<float>(sizes.size()));
+    return sizes[std::min(index, sizes.size() - 1)];
+  };
+  VertexPagePool pool;
+  InitVertexPagePool(pool, kVertexPageVertices, kVertexPageGranule);
+  std::vector<VertexPageRange> live(kVertexPoolBenchMeshes);
+  bool valid = true;
+  for (VertexPageRange& range : live) {
+    valid = AllocateVertexPageRange(pool, pick_size(), range) && valid;
+  }
+  const size_t warm_pages = pool.pages.size();
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int op = 1; op <= kVertexPoolBenchOps; ++op) {
+    const size_t index = static_cast<size_t>(
+        NextBenchRandom(random) * static_cast<float>(live.size()));
+    VertexPageRange& range = live[std::min(index, live.size() - 1)];
+    FreeVertexPageRange(pool, range);
+    valid = AllocateVertexPageRange(pool, pick_size(), range) && valid;
+    if (op % kVertexPoolBenchValidateOps == 0) {
+      valid = valid && ValidateVertexPagePool(pool);
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const VertexPagePoolStats stats = GetVertexPagePoolStats(pool);
+  const bool compact = stats.waste <= kVertexPoolBenchMaxWaste;
+  for (VertexPageRange& range : live) {
+    FreeVertexPageRange(pool, range);
+  }
+  valid = valid && ValidateVertexPagePool(pool);
+  for (const RangeAllocator& page : pool.pages) {
+    valid = valid && page.used == 0 && page.free_list.size() == 1;
+  }
+  std::printf("vertex_pool: meshes:%zu sizes:%zu %.1fns/op pages:%zu "
+              "(warm %zu, %.1fMB) used:%.1f%% waste:%.1f%% (max %.0f%%) "
+              "free_ranges:%zu fragmentation:%.1f%% result:%s\n",
+              live.size(), sizes.size(),
+              std::chrono::duration<double, std::nano>(end - start).count() /
+                  kVertexPoolBenchOps,
+              stats.pages, warm_pages,
+              static_cast<double>(stats.capacity * sizeof(ChunkVertex)) /
+                  (1024.0 * 1024.0),
+              (1.0f - stats.waste) * 100.0f, stats.waste * 100.0f,
+              kVertexPoolBenchMaxWaste * 100.0f, stats.free_ranges,
+              stats.fragmentation * 100.0f,
+              valid && compact ? "ok" : "FAILED");
+  return valid && compact;
+}
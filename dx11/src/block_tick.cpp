@@ -0,0 +1,192 @@
+#include "block_tick.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "profiler.h"
+
+namespace {
+uint32_t HashTick(const Int3& coord, uint64_t tick, int salt) {
+  uint32_t value = static_cast<uint32_t>(coord.x) * 0x8DA6B343u ^
+                   static_cast<uint32_t>(coord.y) * 0xD8163841u ^
+                   static_cast<uint32_t>(coord.z) * 0xCB1AB31Fu ^
+                   static_cast<uint32_t>(tick) * 0x9E3779B9u ^
+                   static_cast<uint32_t>(salt) * 0x85EBCA6Bu;
+  value ^= value >> 16;
+  value *= 0x7FEB352Du;
+  value ^= value >> 15;
+  value *= 0x846CA68Bu;
+  value ^= value >> 16;
+  return value;
+}
+
+bool IsTickEarlier(const ScheduledTick& a, const ScheduledTick& b) {
+  return a.time > b.time || (a.time == b.time && a.order > b.order);
+}
+
+Int3 GetChunkBlock(const Chunk& chunk, int index) {
+  return {(chunk.coord.x << kChunkShift) | ChunkDims::Local(index, 0),
+          (chunk.coord.y << kChunkShift) | ChunkDims::Local(index, 1),
+          (chunk.coord.z << kChunkShift) | ChunkDims::Local(index, 2)};
+}
+
+int GetColor(const Int3& coord) {
+  return (coord.x & 1) | ((coord.y & 1) << 1) | ((coord.z & 1) << 2);
+}
+
+bool IsCovered(const World& world, const Int3& block) {
+  return GetBlock(world, block.x, block.y + 1, block.z) != BlockId::Air;
+}
+
+void TickGrassDecay(const World& world, const Int3& block,
+                    BlockTickOutput& output) {
+  if (GetBlock(world, block.x, block.y, block.z) == BlockId::Grass &&
+      IsCovered(world, block)) {
+    output.changes.push_back({block, BlockId::Dirt});
+  }
+}
+
+void TickGrassSpread(const World& world, const Int3& block, uint32_t random,
+                     BlockTickOutput& output) {
+  if (IsCovered(world, block)) {
+    output.changes.push_back({block, BlockId::Dirt});
+    return;
+  }
+  const Int3 target{block.x + static_cast<int>(random % 3) - 1,
+                    block.y + static_cast<int>((random / 3) % 3) - 1,
+                    block.z + static_cast<int>((random / 9) % 3) - 1};
+  if (GetBlock(world, target.x, target.y, target.z) == BlockId::Dirt &&
+      !IsCovered(world, target)) {
+    output.changes.push_back({target, BlockId::Grass});
+  }
+}
+
+void TickChunk(const BlockTickState& state, const World& world, Chunk& chunk,
+               BlockTickOutput& output) {
+  std::vector<ScheduledTick>& ticks = chunk.scheduled_ticks;
+  while (!ticks.empty() && ticks.front().time <= state.game_tick) {
+    std::pop_heap(ticks.begin(), ticks.end(), IsTickEarlier);
+    const ScheduledTick tick = ticks.back();
+    ticks.pop_back();
+    TickGrassDecay(world, GetChunkBlock(chunk, tick.index), output);
+    ++output.scheduled_ticks;
+  }
+
+  if (chunk.random_tick_blocks == 0) {
+    return;
+  }
+  for (int i = 0; i < kRandomTicksPerChunk; ++i) {
+    const uint32_t random = HashTick(chunk.coord, state.game_tick, i);
+    const int index = static_cast<int>(random % kChunkVolume);
+    if (!HasRandomTicks(chunk.voxels.blocks[static_cast<size_t>(index)])) {
+      continue;
+    }
+    TickGrassSpread(world, GetChunkBlock(chunk, index), random / kChunkVolume,
+                    output);
+    ++output.random_ticks;
+  }
+}
+
+void RunBlockTick(BlockTickState& state, World& world, JobSystem& jobs,
+                  BlockTickStats& stats) {
+  for (auto& color : state.colors) {
+    color.clear();
+  }
+  for (size_t i = world.tick_chunks.size(); i-- > 0;) {
+    Chunk& chunk = *world.tick_chunks[i];
+    if (chunk.scheduled_ticks.empty() && chunk.random_tick_blocks == 0) {
+      RemoveTickChunk(world, chunk);
+      continue;
+    }
+    const bool scheduled = !chunk.scheduled_ticks.empty() &&
+                           chunk.scheduled_ticks.front().time <= state.game_tick;
+    if (!scheduled && chunk.random_tick_blocks == 0) {
+      continue;
+    }
+    state.colors[static_cast<size_t>(GetColor(chunk.coord))].push_back(&chunk);
+  }
+
+  for (auto& color : state.colors) {
+    if (color.empty()) {
+      continue;
+    }
+    if (state.outputs.size() < color.size()) {
+      state.outputs.resize(color.size());
+    }
+    ParallelFor(jobs, static_cast<int>(color.size()), [&](int i) {
+      BlockTickOutput& output = state.outputs[static_cast<size_t>(i)];
+      output.changes.clear();
+      output.scheduled_ticks = 0;
+      output.random_ticks = 0;
+      TickChunk(state, world, *color[static_cast<size_t>(i)], output);
+    });
+    for (size_t i = 0; i < color.size(); ++i) {
+      const BlockTickOutput& output = state.outputs[i];
+      for (const BlockChange& change : output.changes) {
+        if (SetBlock(world, change.block.x, change.block.y, change.block.z,
+                     change.id)) {
+          ++stats.block_changes;
+        }
+      }
+      stats.scheduled_ticks += output.scheduled_ticks;
+      stats.random_ticks += output.random_ticks;
+    }
+    stats.active_chunks += static_cast<int>(color.size());
+  }
+}
+
+void ScheduleChangedNeighbors(BlockTickState& state, World& world,
+                              size_t begin) {
+  for (size_t i = begin; i < world.changes.size(); ++i) {
+    const BlockChange change = world.changes[i];
+    if (change.id == BlockId::Air) {
+      continue;
+    }
+    const Int3 below{change.block.x, change.block.y - 1, change.block.z};
+    if (GetBlock(world, below.x, below.y, below.z) == BlockId::Grass) {
+      ScheduleBlockTick(state, world, below, kGrassDecayDelay);
+    }
+  }
+}
+}  // namespace
+
+void ScheduleBlockTick(BlockTickState& state, World& world, const Int3& block,
+                       uint64_t delay) {
+  Chunk* chunk = FindChunk(world, WorldToChunkCoord(block.x, block.y, block.z));
+  if (!chunk) {
+    return;
+  }
+  const Int3 local = WorldToLocalCoord(block.x, block.y, block.z);
+  ScheduledTick tick;
+  tick.time = state.game_tick + delay;
+  tick.order = state.next_order++;
+  tick.index =
+      static_cast<ChunkIndex>(ChunkDims::Index(local.x, local.y, local.z));
+  chunk->scheduled_ticks.push_back(tick);
+  std::push_heap(chunk->scheduled_ticks.begin(), chunk->scheduled_ticks.end(),
+                 IsTickEarlier);
+  AddTickChunk(world, *chunk);
+}
+
+void UpdateBlockTicks(BlockTickState& state, World& world, JobSystem& jobs,
+                      float dt, BlockTickStats& stats) {
+  const ScopedProfile profile("UpdateBlockTicks");
+  const auto start = std::chrono::steady_clock::now();
+  stats = {};
+  ScheduleChangedNeighbors(state, world, 0);
+
+  const float step = 1.0f / static_cast<float>(kBlockTickRate);
+  state.accumulator =
+      std::min(state.accumulator + dt, step * kMaxBlockTickSteps);
+  while (state.accumulator >= step) {
+    state.accumulator -= step;
+    ++state.game_tick;
+    const size_t begin = world.changes.size();
+    RunBlockTick(state, world, jobs, stats);
+    ScheduleChangedNeighbors(state, world, begin);
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+  stats.update_ms =
+      std::chrono::duration<float, std::milli>(end - start).count();
+}
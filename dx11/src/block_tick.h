@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "job_system.h"
+#include "world.h"
+
+constexpr int kBlockTickRate = 20;
+constexpr int kMaxBlockTickSteps = 4;
+constexpr int kRandomTicksPerSection = 3;
+constexpr int kRandomTickSectionVolume = 16 * 16 * 16;
+constexpr int kRandomTicksPerChunk = std::max(
+    1, kRandomTicksPerSection * kChunkVolume / kRandomTickSectionVolume);
+constexpr int kBlockTickColors = 8;
+constexpr uint64_t kGrassDecayDelay = 20;
+
+struct BlockTickOutput {
+  std::vector<BlockChange> changes;
+  int scheduled_ticks = 0;
+  int random_ticks = 0;
+};
+
+struct BlockTickStats {
+  int active_chunks = 0;
+  int scheduled_ticks = 0;
+  int random_ticks = 0;
+  int block_changes = 0;
+  float update_ms = 0.0f;
+};
+
+struct BlockTickState {
+  uint64_t game_tick = 0;
+  uint32_t next_order = 0;
+  float accumulator = 0.0f;
+  std::array<std::vector<Chunk*>, kBlockTickColors> colors;
+  std::vector<BlockTickOutput> outputs;
+};
+
+void ScheduleBlockTick(BlockTickState& state, World& world, const Int3& block,
+                       uint64_t delay);
+void UpdateBlockTicks(BlockTickState& state, World& world, JobSystem& jobs,
+                      float dt, BlockTickStats& stats);
@@ -0,0 +1,113 @@
+#include "bot.h"
+
+namespace {
+void PickWanderGoal(BotBrain& bot) {
+  bot.wander_timer = kBotMinWanderTime +
+                     (kBotMaxWanderTime - kBotMinWanderTime) *
+                         NextBotRandom(bot);
+  if (NextBotRandom(bot) < kBotIdleChance) {
+    bot.move_forward = 0;
+    bot.move_right = 0;
+    bot.sprint = false;
+    return;
+  }
+  bot.yaw += (NextBotRandom(bot) - 0.5f) * DirectX::XM_PI;
+  bot.move_forward = 1;
+  bot.move_right = 0;
+  if (NextBotRandom(bot) < kBotStrafeChance) {
+    bot.move_right = (NextBotRandom(bot) < 0.5f) ? -1 : 1;
+  }
+  bot.sprint = NextBotRandom(bot) < kBotSprintChance;
+}
+}  // namespace
+
+void InitBotBrain(BotBrain& bot, uint32_t seed) {
+  bot = {};
+  bot.seed = seed * 0x9E3779B9u + 1u;
+  bot.yaw = NextBotRandom(bot) * DirectX::XM_PI * 2.0f;
+  PickWanderGoal(bot);
+}
+
+float NextBotRandom(BotBrain& bot) {
+  bot.seed ^= bot.seed << 13;
+  bot.seed ^= bot.seed >> 17;
+  bot.seed ^= bot.seed << 5;
+  return static_cast<float>(bot.seed & 0xFFFFFFu) / 16777216.0f;
+}
+
+ClientInputMessage UpdateBotBrain(BotBrain& bot, float dt) {
+  bot.wander_timer -= dt;
+  if (bot.wander_timer <= 0.0f) {
+    PickWanderGoal(bot);
+  }
+
+  ClientInputMessage input;
+  input.sequence = ++bot.sequence;
+  input.yaw = bot.yaw;
+  input.pitch = kBotLookPitch;
+  input.move_forward = bot.move_forward;
+  input.move_right = bot.move_right;
+  if (bot.sprint) {
+    input.buttons |= kButtonSprint;
+  }
+  if (NextBotRandom(bot) < kBotJumpsPerSecond * dt) {
+    input.buttons |= kButtonJump;
+  }
+  if (NextBotRandom(bot) < kBotEditsPerSecond * dt) {
+    input.buttons |=
+        (NextBotRandom(bot) < 0.5f) ? kButtonBreak : kButtonPlace;
+  }
+  return input;
+}
+
+bool ConnectRemoteBot(RemoteBot& bot, const char* host, uint16_t port,
+                      uint32_t seed) {
+  InitBotBrain(bot.brain, seed);
+  if (!ConnectToHost(bot.connection, host, port)) {
+    return false;
+  }
+  bot.scratch.clear();
+  WriteClientHello(bot.scratch, {});
+  QueueMessage(bot.connection, static_cast<uint8_t>(MessageType::ClientHello),
+               bot.scratch.data(), bot.scratch.size());
+  return FlushConnection(bot.connection);
+}
+
+void TickRemoteBot(RemoteBot& bot, float dt, RemoteBotStats& stats) {
+  if (!ReceiveFromConnection(bot.connection)) {
+    return;
+  }
+  ++stats.connected;
+  NetMessageView message;
+  while (NextMessage(bot.connection, message)) {
+    stats.bytes_received += kNetMessageHeaderSize + message.size;
+    switch (static_cast<MessageType>(message.type)) {
+      case MessageType::ServerWelcome: {
+        ByteReader reader{message.data, message.size};
+        ServerWelcomeMessage welcome;
+        if (ReadServerWelcome(reader, welcome)) {
+          bot.client_id = welcome.client_id;
+          bot.welcomed = true;
+        }
+        break;
+      }
+      case MessageType::ServerChunkData:
+        ++stats.chunk_messages;
+        break;
+      case MessageType::ServerChunkUnload:
+        ++stats.unload_messages;
+        break;
+      case MessageType::ServerChunkDelta:
+        ++stats.delta_messages;
+        break;
+      default:
+        break;
+    }
+  }
+
+  bot.scratch.clear();
+  WriteClientInput(bot.scratch, UpdateBotBrain(bot.brain, dt));
+  QueueMessage(bot.connection, static_cast<uint8_t>(MessageType::ClientInput),
+               bot.scratch.data(), bot.scratch.size());
+  FlushConnection(bot.connection);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "net.h"
+#include "protocol.h"
+
+constexpr float kBotMinWanderTime = 2.0f;
+constexpr float kBotMaxWanderTime = 8.0f;
+constexpr float kBotIdleChance = 0.15f;
+constexpr float kBotSprintChance = 0.3f;
+constexpr float kBotStrafeChance = 0.2f;
+constexpr float kBotJumpsPerSecond = 0.5f;
+constexpr float kBotEditsPerSecond = 0.5f;
+constexpr float kBotLookPitch = -0.6f;
+constexpr float kBotSpawnSpread = 32.0f;
+
+struct BotBrain {
+  uint32_t seed = 1;
+  uint32_t sequence = 0;
+  float yaw = 0.0f;
+  float wander_timer = 0.0f;
+  int8_t move_forward = 0;
+  int8_t move_right = 0;
+  bool sprint = false;
+};
+
+struct RemoteBot {
+  NetConnection connection;
+  BotBrain brain;
+  std::vector<uint8_t> scratch;
+  uint32_t client_id = 0;
+  bool welcomed = false;
+};
+
+struct RemoteBotStats {
+  int connected = 0;
+  uint64_t bytes_received = 0;
+  int chunk_messages = 0;
+  int unload_messages = 0;
+  int delta_messages = 0;
+};
+
+void InitBotBrain(BotBrain& bot, uint32_t seed);
+float NextBotRandom(BotBrain& bot);
+ClientInputMessage UpdateBotBrain(BotBrain& bot, float dt);
+
+bool ConnectRemoteBot(RemoteBot& bot, const char* host, uint16_t port,
+                      uint32_t seed);
+void TickRemoteBot(RemoteBot& bot, float dt, RemoteBotStats& stats);
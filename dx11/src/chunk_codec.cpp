@@ -0,0 +1,184 @@
+#include "chunk_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+constexpr size_t kMaxRunBytes = 4;
+
+size_t LayerOrderToIndex(int order) {
+  const int x = order & kChunkMask;
+  const int z = (order >> kChunkShift) & kChunkMask;
+  const int y = order >> (kChunkShift * 2);
+  return static_cast<size_t>(ChunkDims::Index(x, y, z));
+}
+
+size_t WriteVarint(uint8_t* out, uint32_t value) {
+  size_t size = 0;
+  while (value >= 0x80) {
+    out[size++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  out[size++] = static_cast<uint8_t>(value);
+  return size;
+}
+
+bool ReadVarint(const uint8_t* data, size_t size, size_t& offset,
+                uint32_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 21; shift += 7) {
+    if (offset >= size) {
+      return false;
+    }
+    const uint8_t byte = data[offset++];
+    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t EncodeRaw(const VoxelChunk& chunk, uint8_t* out, size_t capacity) {
+  if (capacity < kMaxEncodedChunkSize) {
+    return 0;
+  }
+  out[0] = kChunkEncodingRaw;
+  std::memcpy(out + 1, chunk.blocks.data(), static_cast<size_t>(kChunkVolume));
+  return kMaxEncodedChunkSize;
+}
+
+size_t EncodeRuns(const VoxelChunk& chunk,
+                  const std::array<int16_t, 256>& palette_index,
+                  size_t palette_start, uint8_t* out, size_t limit) {
+  const BlockId* blocks = chunk.blocks.data();
+  size_t size = palette_start;
+  BlockId run_id = blocks[LayerOrderToIndex(0)];
+  uint32_t run_length = 0;
+  for (int order = 0; order <= kChunkVolume; ++order) {
+    if (order < kChunkVolume) {
+      const BlockId id = blocks[LayerOrderToIndex(order)];
+      if (id == run_id) {
+        ++run_length;
+        continue;
+      }
+      if (size + kMaxRunBytes > limit) {
+        return 0;
+      }
+      out[size++] = static_cast<uint8_t>(
+          palette_index[static_cast<uint8_t>(run_id)]);
+      size += WriteVarint(out + size, run_length);
+      run_id = id;
+      run_length = 1;
+      continue;
+    }
+    if (size + kMaxRunBytes > limit) {
+      return 0;
+    }
+    out[size++] =
+        static_cast<uint8_t>(palette_index[static_cast<uint8_t>(run_id)]);
+    size += WriteVarint(out + size, run_length);
+  }
+  return size;
+}
+}  // namespace
+
+size_t EncodeChunk(const VoxelChunk& chunk, uint8_t* out, size_t capacity) {
+  std::array<int16_t, 256> palette_index;
+  palette_index.fill(-1);
+  std::array<uint8_t, 256> palette{};
+  int palette_size = 0;
+  for (BlockId id : chunk.blocks) {
+    const uint8_t value = static_cast<uint8_t>(id);
+    if (palette_index[value] < 0) {
+      palette_index[value] = static_cast<int16_t>(palette_size);
+      palette[static_cast<size_t>(palette_size++)] = value;
+    }
+  }
+
+  if (palette_size == 1 && palette[0] < kChunkEncodingUniform) {
+    if (capacity < 1) {
+      return 0;
+    }
+    out[0] = static_cast<uint8_t>(kChunkEncodingUniform | palette[0]);
+    return 1;
+  }
+
+  if (palette_size <= kChunkMaxPaletteSize) {
+    const size_t limit = std::min(capacity, kMaxEncodedChunkSize - 1);
+    const size_t palette_start = 1 + static_cast<size_t>(palette_size);
+    if (palette_start < limit) {
+      out[0] = static_cast<uint8_t>(palette_size);
+      std::memcpy(out + 1, palette.data(), static_cast<size_t>(palette_size));
+      const size_t size =
+          EncodeRuns(chunk, palette_index, palette_start, out, limit);
+      if (size > 0) {
+        return size;
+      }
+    }
+  }
+  return EncodeRaw(chunk, out, capacity);
+}
+
+size_t DecodeChunk(const uint8_t* data, size_t size, VoxelChunk& chunk) {
+  if (size < 1) {
+    return 0;
+  }
+  BlockId* blocks = chunk.blocks.data();
+  const uint8_t header = data[0];
+
+  if ((header & kChunkEncodingUniform) != 0) {
+    const uint8_t value = header & ~kChunkEncodingUniform;
+    if (!IsValidBlockId(value)) {
+      return 0;
+    }
+    std::fill(chunk.blocks.begin(), chunk.blocks.end(),
+              static_cast<BlockId>(value));
+    return 1;
+  }
+
+  if (header == kChunkEncodingRaw) {
+    if (size < kMaxEncodedChunkSize) {
+      return 0;
+    }
+    for (int i = 0; i < kChunkVolume; ++i) {
+      if (!IsValidBlockId(data[1 + i])) {
+        return 0;
+      }
+    }
+    std::memcpy(blocks, data + 1, static_cast<size_t>(kChunkVolume));
+    return kMaxEncodedChunkSize;
+  }
+
+  const size_t palette_size = header;
+  if (size < 1 + palette_size) {
+    return 0;
+  }
+  const uint8_t* palette = data + 1;
+  for (size_t i = 0; i < palette_size; ++i) {
+    if (!IsValidBlockId(palette[i])) {
+      return 0;
+    }
+  }
+
+  size_t offset = 1 + palette_size;
+  int order = 0;
+  while (order < kChunkVolume) {
+    if (offset >= size) {
+      return 0;
+    }
+    const uint8_t index = data[offset++];
+    uint32_t run_length = 0;
+    if (index >= palette_size || !ReadVarint(data, size, offset, run_length) ||
+        run_length == 0 ||
+        run_length > static_cast<uint32_t>(kChunkVolume - order)) {
+      return 0;
+    }
+    const BlockId id = static_cast<BlockId>(palette[index]);
+    for (uint32_t i = 0; i < run_length; ++i) {
+      blocks[LayerOrderToIndex(order++)] = id;
+    }
+  }
+  return offset;
+}
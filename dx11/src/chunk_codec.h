@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "world.h"
+
+constexpr uint8_t kChunkEncodingRaw = 0x00;
+constexpr uint8_t kChunkEncodingUniform = 0x80;
+constexpr int kChunkMaxPaletteSize = kChunkEncodingUniform - 1;
+constexpr size_t kMaxEncodedChunkSize = 1 + static_cast<size_t>(kChunkVolume);
+
+size_t EncodeChunk(const VoxelChunk& chunk, uint8_t* out, size_t capacity);
+size_t DecodeChunk(const uint8_t* data, size_t size, VoxelChunk& chunk);
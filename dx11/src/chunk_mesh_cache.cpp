@@ -0,0 +1,227 @@
+#include "chunk_mesh_cache.h"
+
+#include <chrono>
+
+#include "memory_stats.h"
+#include "profiler.h"
+
+namespace {
+void EraseCachedMesh(ChunkMeshCache& cache,
+                     std::unordered_map<uint64_t, CachedMesh>::iterator it) {
+  for (MeshBuffer& layer : it->second.layers) {
+    FreeVertexPageRange(cache.vertex_pool, layer.range);
+  }
+  cache.mesh_cache.erase(it);
+}
+
+void ReleaseCachedMesh(ChunkMeshCache& cache, ChunkMesh& mesh) {
+  if (!mesh.cached) {
+    return;
+  }
+  auto it = cache.mesh_cache.find(mesh.key);
+  if (it != cache.mesh_cache.end() && --it->second.refs == 0) {
+    EraseCachedMesh(cache, it);
+  }
+  mesh.cached = nullptr;
+}
+
+bool UploadMeshLayer(ChunkMeshCache& cache, MeshBuffer& mesh,
+                     const std::vector<ChunkVertex>& vertices,
+                     const MeshUploadFn& upload) {
+  if (vertices.empty()) {
+    FreeVertexPageRange(cache.vertex_pool, mesh.range);
+    mesh = {};
+    return true;
+  }
+  const uint32_t vertex_count = static_cast<uint32_t>(vertices.size());
+  if (mesh.range.page < 0 || vertex_count > mesh.range.size) {
+    FreeVertexPageRange(cache.vertex_pool, mesh.range);
+    if (!AllocateVertexPageRange(cache.vertex_pool, vertex_count,
+                                 mesh.range)) {
+      return false;
+    }
+  }
+  mesh.vertex_count = vertex_count;
+  return upload(mesh, vertices);
+}
+
+size_t GetMeshScratchBytes(const ChunkMeshCache& cache) {
+  size_t bytes = cache.mesh_grid.blocks.capacity() * sizeof(BlockId) +
+                 cache.mesh_grid.light.capacity();
+  for (const auto& layer : cache.mesh_scratch.layers) {
+    bytes += layer.capacity() * sizeof(ChunkVertex);
+  }
+  return bytes;
+}
+
+size_t GetMeshCacheBytes(const ChunkMeshCache& cache) {
+  return cache.mesh_cache.size() *
+             sizeof(decltype(cache.mesh_cache)::value_type) +
+         cache.mesh_cache.bucket_count() * sizeof(void*) +
+         cache.chunk_meshes.size() *
+             sizeof(decltype(cache.chunk_meshes)::value_type) +
+         cache.chunk_meshes.bucket_count() * sizeof(void*);
+}
+
+void UpdateMeshCacheStats(ChunkMeshCache& cache) {
+  size_t bytes = 0;
+  size_t saved = 0;
+  for (const auto& entry : cache.mesh_cache) {
+    bytes += entry.second.bytes;
+    saved += entry.second.bytes * static_cast<size_t>(entry.second.refs - 1);
+  }
+  cache.stats.mesh_cache_entries = static_cast<int>(cache.mesh_cache.size());
+  cache.stats.mesh_bytes = bytes;
+  cache.stats.mesh_bytes_saved = saved;
+  const size_t cache_bytes = GetMeshCacheBytes(cache);
+  TrackMemoryResize(MemoryCategory::Caches, cache.tracked_cache_bytes,
+                    cache_bytes);
+  cache.tracked_cache_bytes = cache_bytes;
+  const size_t page_bytes =
+      GetVertexPagePoolStats(cache.vertex_pool).capacity * sizeof(ChunkVertex);
+  TrackMemoryResize(MemoryCategory::GpuBuffers, cache.tracked_page_bytes,
+                    page_bytes);
+  cache.tracked_page_bytes = page_bytes;
+}
+}  // namespace
+
+void InitChunkMeshCache(ChunkMeshCache& cache) {
+  InitVertexPagePool(cache.vertex_pool, kVertexPageVertices,
+                     kVertexPageGranule);
+  ReserveMeshScratch(cache.mesh_grid, cache.mesh_scratch);
+}
+
+bool UpdateChunkMeshCache(ChunkMeshCache& cache, World& world,
+                          const DirectX::XMFLOAT3& camera_position,
+                          const MeshUploadFn& upload) {
+  FrameVector<Int3> to_remove;
+  for (const auto& entry : cache.chunk_meshes) {
+    if (world.chunks.find(entry.first) == world.chunks.end()) {
+      to_remove.push_back(entry.first);
+    }
+  }
+  for (const Int3& coord : to_remove) {
+    auto it = cache.chunk_meshes.find(coord);
+    ReleaseCachedMesh(cache, it->second);
+    cache.chunk_meshes.erase(it);
+    cache.transparent_changed = true;
+  }
+  bool cache_changed = !to_remove.empty();
+
+  const Int3 camera_block = WorldBlockFromPosition(camera_position);
+  const Int3 camera_chunk =
+      WorldToChunkCoord(camera_block.x, camera_block.y, camera_block.z);
+  cache.stats.lod_chunks.fill(0);
+  cache.stats.known_allocs = 0;
+  const size_t pages_before = cache.vertex_pool.pages.size();
+  bool uploaded = true;
+  for (auto& entry : world.chunks) {
+    Chunk& chunk = entry.second;
+    auto [mesh_it, mesh_inserted] = cache.chunk_meshes.try_emplace(entry.first);
+    ChunkMesh& mesh = mesh_it->second;
+    cache.stats.known_allocs += mesh_inserted ? 1 : 0;
+    const int lod = SelectChunkLod(entry.first, camera_chunk);
+    ++cache.stats.lod_chunks[static_cast<size_t>(lod)];
+    if (!chunk.dirty && mesh.cached && mesh.lod == lod) {
+      continue;
+    }
+    chunk.dirty = false;
+    mesh.lod = lod;
+    FillMeshGrid(world, chunk, lod, cache.mesh_grid);
+    uint64_t key = HashMeshGrid(cache.mesh_grid);
+    const uint64_t check = CheckMeshGrid(cache.mesh_grid);
+    for (auto found = cache.mesh_cache.find(key);
+         found != cache.mesh_cache.end() && found->second.check != check;
+         found = cache.mesh_cache.find(key)) {
+      ++cache.stats.mesh_cache_collisions;
+      key = key * 0x9E3779B97F4A7C15ull + 1;
+    }
+    if (mesh.cached && mesh.key == key) {
+      continue;
+    }
+
+    const bool had_transparent =
+        GetChunkLayer(mesh, RenderLayer::Transparent) != nullptr;
+    auto [it, inserted] = cache.mesh_cache.try_emplace(key);
+    CachedMesh& cached = it->second;
+    if (inserted) {
+      cached.check = check;
+      ++cache.stats.known_allocs;
+      std::array<size_t, kRenderLayerCount> capacities{};
+      for (size_t layer = 0; layer < capacities.size(); ++layer) {
+        capacities[layer] = cache.mesh_scratch.layers[layer].capacity();
+      }
+      const auto start = std::chrono::steady_clock::now();
+      {
+        const ScopedProfile mesh_profile("BuildVoxelMesh");
+        BuildVoxelMesh(cache.mesh_grid, lod == 0, cache.mesh_scratch);
+      }
+      for (size_t layer = 0; layer < capacities.size(); ++layer) {
+        cache.stats.known_allocs +=
+            cache.mesh_scratch.layers[layer].capacity() != capacities[layer]
+                ? 1
+                : 0;
+      }
+      const size_t scratch_bytes = GetMeshScratchBytes(cache);
+      TrackMemoryResize(MemoryCategory::CpuMeshes, cache.tracked_scratch_bytes,
+                        scratch_bytes);
+      cache.tracked_scratch_bytes = scratch_bytes;
+      for (size_t layer = 0; layer < cached.layers.size() && uploaded;
+           ++layer) {
+        uploaded = UploadMeshLayer(cache, cached.layers[layer],
+                                   cache.mesh_scratch.layers[layer], upload);
+        cached.bytes +=
+            cached.layers[layer].vertex_count * sizeof(ChunkVertex);
+      }
+      if (!uploaded) {
+        EraseCachedMesh(cache, it);
+        break;
+      }
+      cached.mesh_ms = std::chrono::duration<float, std::milli>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+      ++cache.stats.mesh_cache_misses;
+    } else {
+      ++cache.stats.mesh_cache_hits;
+      cache.stats.mesh_ms_saved += cached.mesh_ms;
+    }
+    ++cached.refs;
+    ReleaseCachedMesh(cache, mesh);
+    mesh.cached = &cached;
+    mesh.key = key;
+    cache_changed = true;
+    if (had_transparent !=
+        (GetChunkLayer(mesh, RenderLayer::Transparent) != nullptr)) {
+      cache.transparent_changed = true;
+    }
+  }
+  cache.stats.known_allocs += static_cast<int>(
+      cache.vertex_pool.pages.size() - pages_before);
+  if (cache_changed) {
+    UpdateMeshCacheStats(cache);
+  }
+  return uploaded;
+}
+
+void ClearChunkMeshCache(ChunkMeshCache& cache) {
+  cache.chunk_meshes.clear();
+  while (!cache.mesh_cache.empty()) {
+    EraseCachedMesh(cache, cache.mesh_cache.begin());
+  }
+  cache.vertex_pool.pages.clear();
+  cache.mesh_grid = {};
+  cache.mesh_scratch = {};
+  ReserveMeshScratch(cache.mesh_grid, cache.mesh_scratch);
+  cache.transparent_changed = true;
+  UpdateMeshCacheStats(cache);
+  TrackMemoryResize(MemoryCategory::CpuMeshes, cache.tracked_scratch_bytes, 0);
+  cache.tracked_scratch_bytes = 0;
+}
+
+const MeshBuffer* GetChunkLayer(const ChunkMesh& mesh, RenderLayer layer) {
+  if (!mesh.cached) {
+    return nullptr;
+  }
+  const MeshBuffer& buffer = mesh.cached->layers[static_cast<size_t>(layer)];
+  return buffer.vertex_count > 0 ? &buffer : nullptr;
+}
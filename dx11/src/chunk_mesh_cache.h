@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "range_allocator.h"
+#include "world.h"
+
+struct MeshBuffer {
+  VertexPageRange range;
+  uint32_t vertex_count = 0;
+};
+
+struct CachedMesh {
+  std::array<MeshBuffer, kRenderLayerCount> layers;
+  uint64_t check = 0;
+  size_t bytes = 0;
+  float mesh_ms = 0.0f;
+  int refs = 0;
+};
+
+struct ChunkMesh {
+  const CachedMesh* cached = nullptr;
+  uint64_t key = 0;
+  int lod = 0;
+};
+
+struct MeshCacheStats {
+  std::array<int, kMaxChunkLod + 1> lod_chunks{};
+  uint64_t mesh_cache_hits = 0;
+  uint64_t mesh_cache_misses = 0;
+  uint64_t mesh_cache_collisions = 0;
+  int mesh_cache_entries = 0;
+  float mesh_ms_saved = 0.0f;
+  size_t mesh_bytes = 0;
+  size_t mesh_bytes_saved = 0;
+  int known_allocs = 0;
+};
+
+using MeshUploadFn = std::function<bool(
+    const MeshBuffer& mesh, const std::vector<ChunkVertex>& vertices)>;
+
+struct ChunkMeshCache {
+  std::unordered_map<Int3, ChunkMesh, Int3Hash> chunk_meshes;
+  std::unordered_map<uint64_t, CachedMesh> mesh_cache;
+  VertexPagePool vertex_pool;
+  MeshGrid mesh_grid;
+  ChunkMeshData mesh_scratch;
+  MeshCacheStats stats;
+  bool transparent_changed = false;
+  size_t tracked_scratch_bytes = 0;
+  size_t tracked_cache_bytes = 0;
+  size_t tracked_page_bytes = 0;
+};
+
+void InitChunkMeshCache(ChunkMeshCache& cache);
+bool UpdateChunkMeshCache(ChunkMeshCache& cache, World& world,
+                          const DirectX::XMFLOAT3& camera_position,
+                          const MeshUploadFn& upload);
+void ClearChunkMeshCache(ChunkMeshCache& cache);
+const MeshBuffer* GetChunkLayer(const ChunkMesh& mesh, RenderLayer layer);
@@ -0,0 +1,174 @@
+#include "chunk_pool.h"
+
+#include <windows.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "memory_stats.h"
+#include "world.h"
+
+namespace {
+constexpr size_t kChunkSlabBytes = static_cast<size_t>(kChunkVolume);
+
+struct FreeSlab {
+  FreeSlab* next;
+};
+
+struct ChunkPoolState {
+  std::mutex mutex;
+  ChunkPoolConfig config;
+  size_t arena_bytes = 0;
+  std::vector<uint8_t*> arenas;
+  uint8_t* bump = nullptr;
+  uint8_t* bump_end = nullptr;
+  FreeSlab* free_list = nullptr;
+  ChunkPoolStats stats;
+};
+
+ChunkPoolState& GetPoolState() {
+  static ChunkPoolState* state = new ChunkPoolState();
+  return *state;
+}
+
+bool EnableLockMemoryPrivilege() {
+  HANDLE token = nullptr;
+  if (!OpenProcessToken(GetCurrentProcess(),
+                        TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+    return false;
+  }
+  TOKEN_PRIVILEGES privileges{};
+  privileges.PrivilegeCount = 1;
+  privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+  const bool ok =
+      LookupPrivilegeValueW(nullptr, SE_LOCK_MEMORY_NAME,
+                            &privileges.Privileges[0].Luid) &&
+      AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+      GetLastError() == ERROR_SUCCESS;
+  CloseHandle(token);
+  return ok;
+}
+
+size_t GetArenaBytes(bool large_pages) {
+  size_t bytes = std::max(kChunkSlabArenaBytes, kChunkSlabBytes);
+  const size_t page = large_pages ? GetLargePageMinimum() : 0;
+  if (page > 0) {
+    bytes = (bytes + page - 1) / page * page;
+  }
+  return bytes;
+}
+
+bool AddArena(ChunkPoolState& state) {
+  if (state.arena_bytes == 0) {
+    state.arena_bytes = GetArenaBytes(state.config.large_pages);
+  }
+  const size_t slabs_per_arena = state.arena_bytes / kChunkSlabBytes;
+  if ((state.arenas.size() + 1) * slabs_per_arena > state.config.max_slabs) {
+    return false;
+  }
+  void* arena = nullptr;
+  if (state.config.large_pages) {
+    arena = VirtualAlloc(nullptr, state.arena_bytes,
+                         MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                         PAGE_READWRITE);
+    if (!arena) {
+      std::fprintf(stderr,
+                   "Large page chunk arena failed (%lu), using normal pages\n",
+                   GetLastError());
+      state.config.large_pages = false;
+    }
+  }
+  if (!arena) {
+    arena = VirtualAlloc(nullptr, state.arena_bytes, MEM_RESERVE | MEM_COMMIT,
+                         PAGE_READWRITE);
+  }
+  if (!arena) {
+    return false;
+  }
+  state.arenas.push_back(static_cast<uint8_t*>(arena));
+  state.bump = static_cast<uint8_t*>(arena);
+  state.bump_end = state.bump + slabs_per_arena * kChunkSlabBytes;
+  state.stats.arena_count = state.arenas.size();
+  state.stats.arena_bytes = state.arenas.size() * state.arena_bytes;
+  state.stats.large_pages = state.config.large_pages;
+  return true;
+}
+
+bool OwnsSlab(const ChunkPoolState& state, const void* data) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (const uint8_t* arena : state.arenas) {
+    if (bytes >= arena && bytes < arena + state.arena_bytes) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+void ConfigureChunkPool(const ChunkPoolConfig& config) {
+  ChunkPoolState& state = GetPoolState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.config.max_slabs = config.max_slabs;
+  if (state.arenas.empty() && config.large_pages) {
+    state.config.large_pages = EnableLockMemoryPrivilege();
+    if (!state.config.large_pages) {
+      std::fprintf(stderr,
+                   "Large pages need the 'Lock pages in memory' right, "
+                   "using normal pages\n");
+    }
+  }
+}
+
+ChunkPoolStats GetChunkPoolStats() {
+  ChunkPoolState& state = GetPoolState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  ChunkPoolStats stats = state.stats;
+  stats.slab_bytes = kChunkSlabBytes;
+  return stats;
+}
+
+void* AllocateChunkBuffer(size_t bytes) {
+  TrackMemoryAlloc(MemoryCategory::Voxels, bytes);
+  if (bytes != kChunkSlabBytes) {
+    return ::operator new(bytes);
+  }
+  ChunkPoolState& state = GetPoolState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  void* slab = nullptr;
+  if (state.free_list) {
+    slab = state.free_list;
+    state.free_list = state.free_list->next;
+    --state.stats.slabs_free;
+  } else if (state.bump != state.bump_end || AddArena(state)) {
+    slab = state.bump;
+    state.bump += kChunkSlabBytes;
+  } else {
+    ++state.stats.heap_fallbacks;
+    return ::operator new(bytes);
+  }
+  ++state.stats.slab_allocations;
+  ++state.stats.slabs_in_use;
+  state.stats.slabs_high_water =
+      std::max(state.stats.slabs_high_water, state.stats.slabs_in_use);
+  return slab;
+}
+
+void FreeChunkBuffer(void* data, size_t bytes) {
+  TrackMemoryRelease(MemoryCategory::Voxels, bytes);
+  if (bytes == kChunkSlabBytes) {
+    ChunkPoolState& state = GetPoolState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (OwnsSlab(state, data)) {
+      FreeSlab* slab = static_cast<FreeSlab*>(data);
+      slab->next = state.free_list;
+      state.free_list = slab;
+      --state.stats.slabs_in_use;
+      ++state.stats.slabs_free;
+      return;
+    }
+  }
+  ::operator delete(data);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr size_t kChunkSlabArenaBytes = 2 * 1024 * 1024;
+constexpr size_t kDefaultChunkSlabCap = 16384;
+
+struct ChunkPoolConfig {
+  size_t max_slabs = kDefaultChunkSlabCap;
+  bool large_pages = false;
+};
+
+struct ChunkPoolStats {
+  size_t slab_bytes = 0;
+  size_t slabs_in_use = 0;
+  size_t slabs_free = 0;
+  size_t slabs_high_water = 0;
+  size_t arena_count = 0;
+  size_t arena_bytes = 0;
+  uint64_t slab_allocations = 0;
+  uint64_t heap_fallbacks = 0;
+  bool large_pages = false;
+};
+
+void ConfigureChunkPool(const ChunkPoolConfig& config);
+ChunkPoolStats GetChunkPoolStats();
+void* AllocateChunkBuffer(size_t bytes);
+void FreeChunkBuffer(void* data, size_t bytes);
+
+template <typename T>
+struct ChunkSlabAllocator {
+  using value_type = T;
+
+  ChunkSlabAllocator() = default;
+  template <typename U>
+  ChunkSlabAllocator(const ChunkSlabAllocator<U>&) noexcept {}
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(AllocateChunkBuffer(count * sizeof(T)));
+  }
+  void deallocate(T* data, size_t count) {
+    FreeChunkBuffer(data, count * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const ChunkSlabAllocator<U>&) const noexcept {
+    return true;
+  }
+};
@@ -0,0 +1,279 @@
+#include "collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+int MinCell(float value) {
+  return static_cast<int>(std::floor(value + kCollisionEpsilon));
+}
+
+int MaxCell(float value) {
+  return static_cast<int>(std::floor(value - kCollisionEpsilon));
+}
+
+Aabb MakeAabb(const BodyState& body) {
+  return MakeBodyAabb(body.position, body.radius, body.height);
+}
+
+bool IsRegionSolid(const World& world, const Int3& min, const Int3& max) {
+  WorldCursor cursor(world, min);
+  for (int x = min.x; x <= max.x; ++x) {
+    for (int y = min.y; y <= max.y; ++y) {
+      cursor.Seek({x, y, min.z});
+      for (int z = min.z;; ++z) {
+        if (IsSolidBlock(cursor.Get())) {
+          return true;
+        }
+        if (z == max.z) {
+          break;
+        }
+        cursor.Step(0, 0, 1);
+      }
+    }
+  }
+  return false;
+}
+}  // namespace
+
+Aabb MakeBodyAabb(const DirectX::XMFLOAT3& position, float radius,
+                  float height) {
+  return {position.x - radius, position.y,          position.z - radius,
+          position.x + radius, position.y + height, position.z + radius};
+}
+
+bool IsSolid(const World& world, int x, int y, int z) {
+  return IsSolidBlock(GetBlock(world, x, y, z));
+}
+
+bool IsAabbClear(const World& world, const Aabb& box) {
+  const int min_x = MinCell(box.min_x);
+  const int max_x = MaxCell(box.max_x);
+  const int min_y = MinCell(box.min_y);
+  const int max_y = MaxCell(box.max_y);
+  const int min_z = MinCell(box.min_z);
+  const int max_z = MaxCell(box.max_z);
+  if (max_x < min_x || max_y < min_y || max_z < min_z) {
+    return true;
+  }
+  return !IsRegionSolid(world, {min_x, min_y, min_z}, {max_x, max_y, max_z});
+}
+
+bool MoveBodyAlongX(BodyState& body, const World& world, float delta) {
+  if (delta == 0.0f) {
+    return false;
+  }
+  Aabb box = MakeAabb(body);
+  const int min_y = MinCell(box.min_y);
+  const int max_y = MaxCell(box.max_y);
+  const int min_z = MinCell(box.min_z);
+  const int max_z = MaxCell(box.max_z);
+  if (max_y < min_y || max_z < min_z) {
+    body.position.x += delta;
+    return false;
+  }
+
+  bool hit = false;
+  float move = delta;
+  if (delta > 0.0f) {
+    const int start_x = static_cast<int>(std::floor(box.max_x + kCollisionEpsilon));
+    const int end_x =
+        static_cast<int>(std::floor(box.max_x + delta));
+    for (int x = start_x; x <= end_x; ++x) {
+      const bool blocked =
+          IsRegionSolid(world, {x, min_y, min_z}, {x, max_y, max_z});
+      if (blocked) {
+        float allowed = static_cast<float>(x) - box.max_x - kCollisionEpsilon;
+        allowed = std::max(0.0f, allowed);
+        if (allowed < move) {
+          move = allowed;
+        }
+        hit = true;
+        break;
+      }
+    }
+  } else {
+    const int start_x =
+        static_cast<int>(std::floor(box.min_x - kCollisionEpsilon));
+    const int end_x =
+        static_cast<int>(std::floor(box.min_x + delta));
+    for (int x = start_x; x >= end_x; --x) {
+      const bool blocked =
+          IsRegionSolid(world, {x, min_y, min_z}, {x, max_y, max_z});
+      if (blocked) {
+        float allowed =
+            static_cast<float>(x + 1) + kCollisionEpsilon - box.min_x;
+        allowed = std::min(0.0f, allowed);
+        if (allowed > move) {
+          move = allowed;
+        }
+        hit = true;
+        break;
+      }
+    }
+  }
+  body.position.x += move;
+  return hit;
+}
+
+bool MoveBodyAlongZ(BodyState& body, const World& world, float delta) {
+  if (delta == 0.0f) {
+    return false;
+  }
+  Aabb box = MakeAabb(body);
+  const int min_y = MinCell(box.min_y);
+  const int max_y = MaxCell(box.max_y);
+  const int min_x = MinCell(box.min_x);
+  const int max_x = MaxCell(box.max_x);
+  if (max_y < min_y || max_x < min_x) {
+    body.position.z += delta;
+    return false;
+  }
+
+  bool hit = false;
+  float move = delta;
+  if (delta > 0.0f) {
+    const int start_z = static_cast<int>(std::floor(box.max_z + kCollisionEpsilon));
+    const int end_z =
+        static_cast<int>(std::floor(box.max_z + delta));
+    for (int z = start_z; z <= end_z; ++z) {
+      const bool blocked =
+          IsRegionSolid(world, {min_x, min_y, z}, {max_x, max_y, z});
+      if (blocked) {
+        float allowed = static_cast<float>(z) - box.max_z - kCollisionEpsilon;
+        allowed = std::max(0.0f, allowed);
+        if (allowed < move) {
+          move = allowed;
+        }
+        hit = true;
+        break;
+      }
+    }
+  } else {
+    const int start_z =
+        static_cast<int>(std::floor(box.min_z - kCollisionEpsilon));
+    const int end_z =
+        static_cast<int>(std::floor(box.min_z + delta));
+    for (int z = start_z; z >= end_z; --z) {
+      const bool blocked =
+          IsRegionSolid(world, {min_x, min_y, z}, {max_x, max_y, z});
+      if (blocked) {
+        float allowed =
+            static_cast<float>(z + 1) + kCollisionEpsilon - box.min_z;
+        allowed = std::min(0.0f, allowed);
+        if (allowed > move) {
+          move = allowed;
+        }
+        hit = true;
+        break;
+      }
+    }
+  }
+  body.position.z += move;
+  return hit;
+}
+
+bool MoveBodyAlongY(BodyState& body, const World& world, float delta) {
+  if (delta == 0.0f) {
+    return false;
+  }
+  Aabb box = MakeAabb(body);
+  const int min_x = MinCell(box.min_x);
+  const int max_x = MaxCell(box.max_x);
+  const int min_z = MinCell(box.min_z);
+  const int max_z = MaxCell(box.max_z);
+  if (max_x < min_x || max_z < min_z) {
+    body.position.y += delta;
+    return false;
+  }
+
+  bool hit = false;
+  float move = delta;
+  if (delta > 0.0f) {
+    const int start_y = static_cast<int>(std::floor(box.max_y + kCollisionEpsilon));
+    const int end_y =
+        static_cast<int>(std::floor(box.max_y + delta));
+    for (int y = start_y; y <= end_y; ++y) {
+      const bool blocked =
+          IsRegionSolid(world, {min_x, y, min_z}, {max_x, y, max_z});
+      if (blocked) {
+        float allowed = static_cast<float>(y) - box.max_y - kCollisionEpsilon;
+        allowed = std::max(0.0f, allowed);
+        if (allowed < move) {
+          move = allowed;
+        }
+        hit = true;
+        break;
+      }
+    }
+  } else {
+    const int start_y =
+        static_cast<int>(std::floor(box.min_y - kCollisionEpsilon));
+    const int end_y =
+        static_cast<int>(std::floor(box.min_y + delta));
+    for (int y = start_y; y >= end_y; --y) {
+      const bool blocked =
+          IsRegionSolid(world, {min_x, y, min_z}, {max_x, y, max_z});
+      if (blocked) {
+        float allowed =
+            static_cast<float>(y + 1) + kCollisionEpsilon - box.min_y;
+        allowed = std::min(0.0f, allowed);
+        if (allowed > move) {
+          move = allowed;
+        }
+        hit = true;
+        break;
+      }
+    }
+  }
+  body.position.y += move;
+  return hit;
+}
+
+BodyStepResult IntegrateBody(BodyState& body, const World& world,
+                             float gravity, float dt) {
+  body.velocity.y += gravity * dt;
+
+  const float dx = body.velocity.x * dt;
+  const float dz = body.velocity.z * dt;
+  const float dy = body.velocity.y * dt;
+
+  BodyStepResult result;
+  const BodyState pre_step = body;
+  result.hit_x = MoveBodyAlongX(body, world, dx);
+  result.hit_z = MoveBodyAlongZ(body, world, dz);
+
+  if (body.on_ground && body.step_height > 0.0f &&
+      (result.hit_x || result.hit_z)) {
+    BodyState step = pre_step;
+    if (!MoveBodyAlongY(step, world, body.step_height)) {
+      const bool step_hit_x = MoveBodyAlongX(step, world, dx);
+      const bool step_hit_z = MoveBodyAlongZ(step, world, dz);
+      if (!step_hit_x && !step_hit_z) {
+        MoveBodyAlongY(step, world, -(body.step_height + kCollisionEpsilon));
+        body = step;
+        result.stepped = true;
+      }
+    }
+  }
+
+  if (!result.stepped) {
+    if (result.hit_x) {
+      body.velocity.x = 0.0f;
+    }
+    if (result.hit_z) {
+      body.velocity.z = 0.0f;
+    }
+  }
+
+  const bool hit_y = MoveBodyAlongY(body, world, dy);
+  if (hit_y) {
+    if (dy < 0.0f) {
+      body.on_ground = true;
+    }
+    body.velocity.y = 0.0f;
+  } else {
+    body.on_ground = false;
+  }
+  return result;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include "world.h"
+
+constexpr float kCollisionEpsilon = 0.001f;
+
+struct Aabb {
+  float min_x;
+  float min_y;
+  float min_z;
+  float max_x;
+  float max_y;
+  float max_z;
+};
+
+struct BodyState {
+  DirectX::XMFLOAT3 position;
+  DirectX::XMFLOAT3 velocity;
+  float radius = 0.0f;
+  float height = 0.0f;
+  float step_height = 0.0f;
+  bool on_ground = false;
+};
+
+struct BodyStepResult {
+  bool hit_x = false;
+  bool hit_z = false;
+  bool stepped = false;
+};
+
+Aabb MakeBodyAabb(const DirectX::XMFLOAT3& position, float radius,
+                  float height);
+bool IsSolid(const World& world, int x, int y, int z);
+bool IsAabbClear(const World& world, const Aabb& box);
+bool MoveBodyAlongX(BodyState& body, const World& world, float delta);
+bool MoveBodyAlongY(BodyState& body, const World& world, float delta);
+bool MoveBodyAlongZ(BodyState& body, const World& world, float delta);
+BodyStepResult IntegrateBody(BodyState& body, const World& world,
+                             float gravity, float dt);
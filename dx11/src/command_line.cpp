@@ -0,0 +1,32 @@
+#include "command_line.h"
+
+#include <cstdlib>
+#include <cstring>
+
+int ParseIntArg(int argc, char** argv, const char* name, int fallback) {
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (std::strcmp(argv[i], name) == 0) {
+      return std::atoi(argv[i + 1]);
+    }
+  }
+  return fallback;
+}
+
+const char* ParseStringArg(int argc, char** argv, const char* name,
+                           const char* fallback) {
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (std::strcmp(argv[i], name) == 0) {
+      return argv[i + 1];
+    }
+  }
+  return fallback;
+}
+
+bool HasArg(int argc, char** argv, const char* name) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+int ParseIntArg(int argc, char** argv, const char* name, int fallback);
+const char* ParseStringArg(int argc, char** argv, const char* name,
+                           const char* fallback);
+bool HasArg(int argc, char** argv, const char* name);
@@ -0,0 +1,297 @@
+#include "entity.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "collision.h"
+#include "profiler.h"
+
+namespace {
+constexpr uint64_t kPartitionIndexMask = (1ull << 24) - 1;
+constexpr int kPartitionCoordBias = 1 << 19;
+constexpr uint32_t kPartitionCoordMask = (1u << 20) - 1;
+
+uint32_t HashUint(uint32_t value) {
+  value ^= value >> 16;
+  value *= 0x7feb352du;
+  value ^= value >> 15;
+  value *= 0x846ca68bu;
+  value ^= value >> 16;
+  return value;
+}
+
+float RandomUnit(uint32_t seed) {
+  return static_cast<float>(HashUint(seed) & 0xFFFFFFu) / 16777216.0f;
+}
+
+size_t PushEntity(EntityStore& store, EntityKind kind,
+                  const DirectX::XMFLOAT3& position, float radius,
+                  float height) {
+  const size_t index = store.kind.size();
+  store.position_x.push_back(position.x);
+  store.position_y.push_back(position.y);
+  store.position_z.push_back(position.z);
+  store.velocity_x.push_back(0.0f);
+  store.velocity_y.push_back(0.0f);
+  store.velocity_z.push_back(0.0f);
+  store.radius.push_back(radius);
+  store.height.push_back(height);
+  store.timer.push_back(0.0f);
+  store.kind.push_back(kind);
+  store.flags.push_back(0);
+  store.item_block.push_back(BlockId::Air);
+  return index;
+}
+
+uint64_t MakePartitionKey(const EntityStore& store, size_t index) {
+  const int block_x = static_cast<int>(std::floor(store.position_x[index]));
+  const int block_z = static_cast<int>(std::floor(store.position_z[index]));
+  const uint32_t cx = static_cast<uint32_t>(ChunkDims::ChunkCoord(block_x) +
+                                            kPartitionCoordBias) &
+                      kPartitionCoordMask;
+  const uint32_t cz = static_cast<uint32_t>(ChunkDims::ChunkCoord(block_z) +
+                                            kPartitionCoordBias) &
+                      kPartitionCoordMask;
+  return (static_cast<uint64_t>(cx) << 44) | (static_cast<uint64_t>(cz) << 24) |
+         (static_cast<uint64_t>(index) & kPartitionIndexMask);
+}
+
+void SteerMob(EntityStore& store, size_t index, float dt) {
+  const bool on_ground = (store.flags[index] & kEntityOnGround) != 0;
+  const bool blocked = (store.flags[index] & kEntityBlocked) != 0;
+  if (blocked && on_ground) {
+    store.velocity_y[index] = kMobJumpSpeed;
+    store.timer[index] = 0.0f;
+  }
+
+  store.timer[index] -= dt;
+  if (store.timer[index] > 0.0f) {
+    return;
+  }
+  const uint32_t seed =
+      static_cast<uint32_t>(index) * 0x9E3779B9u ^ (store.tick * 0x85EBCA6Bu);
+  store.timer[index] = 1.0f + 3.0f * RandomUnit(seed);
+  if (RandomUnit(seed + 1u) < 0.25f) {
+    store.velocity_x[index] = 0.0f;
+    store.velocity_z[index] = 0.0f;
+    return;
+  }
+  const float angle = RandomUnit(seed + 2u) * DirectX::XM_PI * 2.0f;
+  store.velocity_x[index] = std::sin(angle) * kMobSpeed;
+  store.velocity_z[index] = std::cos(angle) * kMobSpeed;
+}
+
+void AgeItem(EntityStore& store, size_t index, float dt) {
+  store.timer[index] += dt;
+  if (store.timer[index] >= kItemLifetime) {
+    store.flags[index] |= kEntityDead;
+    return;
+  }
+  if ((store.flags[index] & kEntityOnGround) != 0) {
+    const float damping = std::max(0.0f, 1.0f - kItemGroundFriction * dt);
+    store.velocity_x[index] *= damping;
+    store.velocity_z[index] *= damping;
+  }
+}
+
+DirectX::XMFLOAT3 ComputeMobSeparation(const EntityStore& store,
+                                       size_t index) {
+  const DirectX::XMFLOAT3 center = GetEntityPosition(store, index);
+  DirectX::XMFLOAT3 push{0.0f, 0.0f, 0.0f};
+  VisitSpatialRadius(
+      store.spatial, center, kMobSeparationRadius,
+      [&](const SpatialEntry& entry) {
+        if (entry.id == index || entry.id >= store.kind.size() ||
+            store.kind[entry.id] != EntityKind::Mob) {
+          return;
+        }
+        const float dx = center.x - entry.x;
+        const float dz = center.z - entry.z;
+        const float dist_sq = dx * dx + dz * dz;
+        if (dist_sq <= 0.0001f) {
+          return;
+        }
+        const float dist = std::sqrt(dist_sq);
+        const float overlap = (kMobSeparationRadius - dist) / dist;
+        push.x += dx * overlap * kMobSeparationStrength;
+        push.z += dz * overlap * kMobSeparationStrength;
+      });
+  return push;
+}
+
+void UpdateEntity(EntityStore& store, const World& world, size_t index,
+                  float dt) {
+  if ((store.flags[index] & kEntityDead) != 0) {
+    return;
+  }
+  switch (store.kind[index]) {
+    case EntityKind::Mob:
+      SteerMob(store, index, dt);
+      break;
+    case EntityKind::Item:
+      AgeItem(store, index, dt);
+      break;
+  }
+  if ((store.flags[index] & kEntityDead) != 0) {
+    return;
+  }
+
+  BodyState body;
+  body.position = {store.position_x[index], store.position_y[index],
+                   store.position_z[index]};
+  body.velocity = {store.velocity_x[index], store.velocity_y[index],
+                   store.velocity_z[index]};
+  body.radius = store.radius[index];
+  body.height = store.height[index];
+  body.step_height =
+      (store.kind[index] == EntityKind::Mob) ? kMobStepHeight : 0.0f;
+  body.on_ground = (store.flags[index] & kEntityOnGround) != 0;
+
+  DirectX::XMFLOAT3 separation{0.0f, 0.0f, 0.0f};
+  if (store.kind[index] == EntityKind::Mob) {
+    separation = ComputeMobSeparation(store, index);
+    body.velocity.x += separation.x;
+    body.velocity.z += separation.z;
+  }
+
+  const BodyStepResult step = IntegrateBody(body, world, kEntityGravity, dt);
+
+  store.position_x[index] = body.position.x;
+  store.position_y[index] = body.position.y;
+  store.position_z[index] = body.position.z;
+  store.velocity_x[index] = step.hit_x && !step.stepped
+                                ? 0.0f
+                                : body.velocity.x - separation.x;
+  store.velocity_y[index] = body.velocity.y;
+  store.velocity_z[index] = step.hit_z && !step.stepped
+                                ? 0.0f
+                                : body.velocity.z - separation.z;
+
+  uint8_t flags = 0;
+  if (body.on_ground) {
+    flags |= kEntityOnGround;
+  }
+  if (!step.stepped && (step.hit_x || step.hit_z)) {
+    flags |= kEntityBlocked;
+  }
+  if (body.position.y < kEntityKillY) {
+    flags |= kEntityDead;
+  }
+  store.flags[index] = flags;
+}
+}  // namespace
+
+size_t GetEntityCount(const EntityStore& store) { return store.kind.size(); }
+
+DirectX::XMFLOAT3 GetEntityPosition(const EntityStore& store, size_t index) {
+  return {store.position_x[index], store.position_y[index],
+          store.position_z[index]};
+}
+
+size_t SpawnMob(EntityStore& store, const DirectX::XMFLOAT3& position) {
+  return PushEntity(store, EntityKind::Mob, position, kMobRadius, kMobHeight);
+}
+
+size_t SpawnItem(EntityStore& store, const DirectX::XMFLOAT3& position,
+                 BlockId block) {
+  const size_t index =
+      PushEntity(store, EntityKind::Item, position, kItemRadius, kItemHeight);
+  store.item_block[index] = block;
+  store.velocity_y[index] = 4.0f;
+  return index;
+}
+
+void RemoveEntity(EntityStore& store, size_t index) {
+  const size_t last = store.kind.size() - 1;
+  if (index != last) {
+    store.position_x[index] = store.position_x[last];
+    store.position_y[index] = store.position_y[last];
+    store.position_z[index] = store.position_z[last];
+    store.velocity_x[index] = store.velocity_x[last];
+    store.velocity_y[index] = store.velocity_y[last];
+    store.velocity_z[index] = store.velocity_z[last];
+    store.radius[index] = store.radius[last];
+    store.height[index] = store.height[last];
+    store.timer[index] = store.timer[last];
+    store.kind[index] = store.kind[last];
+    store.flags[index] = store.flags[last];
+    store.item_block[index] = store.item_block[last];
+  }
+  store.position_x.pop_back();
+  store.position_y.pop_back();
+  store.position_z.pop_back();
+  store.velocity_x.pop_back();
+  store.velocity_y.pop_back();
+  store.velocity_z.pop_back();
+  store.radius.pop_back();
+  store.height.pop_back();
+  store.timer.pop_back();
+  store.kind.pop_back();
+  store.flags.pop_back();
+  store.item_block.pop_back();
+}
+
+int CollectItems(EntityStore& store, const DirectX::XMFLOAT3& position,
+                 float radius) {
+  int collected = 0;
+  VisitSpatialRadius(store.spatial, position, radius,
+                     [&](const SpatialEntry& entry) {
+                       const size_t index = entry.id;
+                       if (index >= store.kind.size() ||
+                           store.kind[index] != EntityKind::Item ||
+                           (store.flags[index] & kEntityDead) != 0) {
+                         return;
+                       }
+                       store.flags[index] |= kEntityDead;
+                       ++collected;
+                     });
+  return collected;
+}
+
+void UpdateEntities(EntityStore& store, const World& world, JobSystem& jobs,
+                    float dt, EntityStats& stats) {
+  const ScopedProfile profile("UpdateEntities");
+  const auto start = std::chrono::steady_clock::now();
+  const size_t count = GetEntityCount(store);
+  ++store.tick;
+
+  store.partition_keys.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    store.partition_keys[i] = MakePartitionKey(store, i);
+  }
+  std::sort(store.partition_keys.begin(), store.partition_keys.end());
+
+  const int max_partitions = GetWorkerCount(jobs) + 1;
+  const int partitions = std::clamp(
+      static_cast<int>(count) / kMinEntitiesPerPartition, 1, max_partitions);
+  ParallelFor(jobs, partitions, [&](int partition) {
+    const size_t begin = count * static_cast<size_t>(partition) /
+                         static_cast<size_t>(partitions);
+    const size_t end = count * static_cast<size_t>(partition + 1) /
+                       static_cast<size_t>(partitions);
+    for (size_t k = begin; k < end; ++k) {
+      const size_t index =
+          static_cast<size_t>(store.partition_keys[k] & kPartitionIndexMask);
+      UpdateEntity(store, world, index, dt);
+    }
+  });
+
+  for (size_t i = GetEntityCount(store); i-- > 0;) {
+    if ((store.flags[i] & kEntityDead) != 0) {
+      RemoveEntity(store, i);
+    }
+  }
+  RebuildSpatialHash(store.spatial, store.position_x.data(),
+                     store.position_y.data(), store.position_z.data(),
+                     GetEntityCount(store));
+
+  const auto end = std::chrono::steady_clock::now();
+  stats.entity_count = static_cast<int>(count);
+  stats.partition_count = partitions;
+  stats.update_ms =
+      std::chrono::duration<float, std::milli>(end - start).count();
+  stats.entities_per_ms = (stats.update_ms > 0.0f)
+                              ? static_cast<float>(count) / stats.update_ms
+                              : 0.0f;
+}
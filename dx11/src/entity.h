@@ -0,0 +1,74 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "job_system.h"
+#include "spatial_hash.h"
+#include "world.h"
+
+constexpr float kEntityGravity = -24.0f;
+constexpr float kEntityKillY = -64.0f;
+constexpr float kMobRadius = 0.3f;
+constexpr float kMobHeight = 1.7f;
+constexpr float kMobSpeed = 2.0f;
+constexpr float kMobJumpSpeed = 8.0f;
+constexpr float kMobStepHeight = 0.6f;
+constexpr float kItemRadius = 0.125f;
+constexpr float kItemHeight = 0.25f;
+constexpr float kItemGroundFriction = 8.0f;
+constexpr float kItemLifetime = 300.0f;
+constexpr float kMobSeparationRadius = kMobRadius * 2.0f;
+constexpr float kMobSeparationStrength = 4.0f;
+constexpr float kItemPickupRadius = 1.5f;
+constexpr int kMinEntitiesPerPartition = 256;
+
+enum class EntityKind : uint8_t {
+  Mob = 0,
+  Item = 1,
+};
+
+enum EntityFlags : uint8_t {
+  kEntityOnGround = 1u << 0,
+  kEntityBlocked = 1u << 1,
+  kEntityDead = 1u << 2,
+};
+
+struct EntityStore {
+  std::vector<float> position_x;
+  std::vector<float> position_y;
+  std::vector<float> position_z;
+  std::vector<float> velocity_x;
+  std::vector<float> velocity_y;
+  std::vector<float> velocity_z;
+  std::vector<float> radius;
+  std::vector<float> height;
+  std::vector<float> timer;
+  std::vector<EntityKind> kind;
+  std::vector<uint8_t> flags;
+  std::vector<BlockId> item_block;
+  std::vector<uint64_t> partition_keys;
+  SpatialHash spatial;
+  uint32_t tick = 0;
+};
+
+struct EntityStats {
+  int entity_count = 0;
+  int partition_count = 0;
+  float update_ms = 0.0f;
+  float entities_per_ms = 0.0f;
+};
+
+size_t GetEntityCount(const EntityStore& store);
+DirectX::XMFLOAT3 GetEntityPosition(const EntityStore& store, size_t index);
+size_t SpawnMob(EntityStore& store, const DirectX::XMFLOAT3& position);
+size_t SpawnItem(EntityStore& store, const DirectX::XMFLOAT3& position,
+                 BlockId block);
+void RemoveEntity(EntityStore& store, size_t index);
+int CollectItems(EntityStore& store, const DirectX::XMFLOAT3& position,
+                 float radius);
+void UpdateEntities(EntityStore& store, const World& world, JobSystem& jobs,
+                    float dt, EntityStats& stats);
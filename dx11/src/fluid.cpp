@@ -0,0 +1,277 @@
+#include "fluid.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "profiler.h"
+
+namespace {
+struct FluidCell {
+  BlockId id = BlockId::Air;
+  int distance = 0;
+};
+
+constexpr Int3 kHorizontalOffsets[4] = {
+    {1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}};
+
+ChunkIndex GetLocalIndex(const Int3& local) {
+  return static_cast<ChunkIndex>(ChunkDims::Index(local.x, local.y, local.z));
+}
+
+Int3 GetChunkBlock(const Chunk& chunk, int index) {
+  return {(chunk.coord.x << kChunkShift) | ChunkDims::Local(index, 0),
+          (chunk.coord.y << kChunkShift) | ChunkDims::Local(index, 1),
+          (chunk.coord.z << kChunkShift) | ChunkDims::Local(index, 2)};
+}
+
+int GetMaxDistance(BlockId id) {
+  return (id == BlockId::Lava) ? kLavaMaxDistance : kWaterMaxDistance;
+}
+
+FluidCell ReadFluidCell(const World& world, int x, int y, int z) {
+  const Chunk* chunk = FindChunk(world, WorldToChunkCoord(x, y, z));
+  if (!chunk) {
+    return {BlockId::Stone, 0};
+  }
+  const Int3 local = WorldToLocalCoord(x, y, z);
+  const BlockId id = chunk->voxels.Get(local.x, local.y, local.z);
+  if (!IsFluidBlock(id) || chunk->fluid_levels.empty()) {
+    return {id, 0};
+  }
+  return {id, chunk->fluid_levels[GetLocalIndex(local)] & kFluidDistanceMask};
+}
+
+bool CanSpreadSideways(const World& world, const Int3& block,
+                       const FluidCell& cell) {
+  const FluidCell below = ReadFluidCell(world, block.x, block.y - 1, block.z);
+  return IsSolidBlock(below.id) || (below.id == cell.id && below.distance == 0);
+}
+
+bool ComputeFluidCell(const World& world, const Int3& block,
+                      const FluidCell& self, FluidCell& result) {
+  if (IsSolidBlock(self.id)) {
+    return false;
+  }
+
+  const FluidCell above = ReadFluidCell(world, block.x, block.y + 1, block.z);
+  const FluidCell below = ReadFluidCell(world, block.x, block.y - 1, block.z);
+  bool touches_water =
+      above.id == BlockId::Water || below.id == BlockId::Water;
+  FluidCell best{BlockId::Air, kFluidDistanceMask};
+  if (IsFluidBlock(above.id)) {
+    best = {above.id, 1};
+  }
+  for (const Int3& offset : kHorizontalOffsets) {
+    const Int3 neighbor{block.x + offset.x, block.y, block.z + offset.z};
+    const FluidCell cell =
+        ReadFluidCell(world, neighbor.x, neighbor.y, neighbor.z);
+    if (cell.id == BlockId::Water) {
+      touches_water = true;
+    }
+    if (!IsFluidBlock(cell.id)) {
+      continue;
+    }
+    const int distance = cell.distance + 1;
+    if (distance > GetMaxDistance(cell.id) ||
+        !CanSpreadSideways(world, neighbor, cell)) {
+      continue;
+    }
+    if (distance < best.distance ||
+        (distance == best.distance && cell.id == BlockId::Water)) {
+      best = {cell.id, distance};
+    }
+  }
+
+  if (self.id == BlockId::Lava && touches_water) {
+    result = {BlockId::Stone, 0};
+    return true;
+  }
+  if (IsFluidBlock(self.id) && self.distance == 0) {
+    return false;
+  }
+  if (best.id == BlockId::Lava && touches_water) {
+    result = {BlockId::Stone, 0};
+    return true;
+  }
+  result = (best.id == BlockId::Air) ? FluidCell{BlockId::Air, 0} : best;
+  return result.id != self.id ||
+         (IsFluidBlock(result.id) && result.distance != self.distance);
+}
+
+void RunFluidJob(const World& world, FluidJob& job, bool lava_step) {
+  job.writes.clear();
+  job.deferred.clear();
+  const Chunk& chunk = *job.chunk;
+  for (ChunkIndex index : job.cells) {
+    const Int3 block = GetChunkBlock(chunk, index);
+    const FluidCell self = ReadFluidCell(world, block.x, block.y, block.z);
+    FluidCell result;
+    if (!ComputeFluidCell(world, block, self, result)) {
+      continue;
+    }
+    if (!lava_step &&
+        (self.id == BlockId::Lava || result.id == BlockId::Lava)) {
+      job.deferred.push_back(index);
+      continue;
+    }
+    job.writes.push_back(
+        {index, result.id, static_cast<uint8_t>(result.distance)});
+  }
+}
+
+void ActivateNeighborhood(FluidState& state, World& world, const Int3& block) {
+  ActivateFluidCell(state, world, block);
+  for (const FaceDef& face : kFaces) {
+    ActivateFluidCell(state, world,
+                      {block.x + face.neighbor.x, block.y + face.neighbor.y,
+                       block.z + face.neighbor.z});
+  }
+}
+
+void ApplyFluidWrite(FluidState& state, World& world, Chunk& chunk,
+                     const FluidWrite& write) {
+  uint8_t& level = chunk.fluid_levels[write.index];
+  level = static_cast<uint8_t>((level & kFluidQueuedBit) | write.distance);
+  const Int3 block = GetChunkBlock(chunk, write.index);
+  SetBlock(world, block.x, block.y, block.z, write.id);
+  ActivateNeighborhood(state, world, block);
+}
+
+bool TouchesFluid(const World& world, const Int3& block) {
+  if (IsFluidBlock(GetBlock(world, block.x, block.y, block.z))) {
+    return true;
+  }
+  for (const FaceDef& face : kFaces) {
+    if (IsFluidBlock(GetBlock(world, block.x + face.neighbor.x,
+                              block.y + face.neighbor.y,
+                              block.z + face.neighbor.z))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ActivateChangedCells(FluidState& state, World& world) {
+  for (const BlockChange& change : world.changes) {
+    Chunk* chunk = FindChunk(
+        world,
+        WorldToChunkCoord(change.block.x, change.block.y, change.block.z));
+    if (!chunk) {
+      continue;
+    }
+    if (!chunk->fluid_levels.empty()) {
+      uint8_t& level = chunk->fluid_levels[GetLocalIndex(WorldToLocalCoord(
+          change.block.x, change.block.y, change.block.z))];
+      level &= kFluidQueuedBit;
+    }
+    if (TouchesFluid(world, change.block)) {
+      ActivateNeighborhood(state, world, change.block);
+    }
+  }
+}
+}  // namespace
+
+void ActivateFluidCell(FluidState& state, World& world, const Int3& block) {
+  Chunk* chunk =
+      FindChunk(world, WorldToChunkCoord(block.x, block.y, block.z));
+  if (!chunk) {
+    return;
+  }
+  const Int3 local = WorldToLocalCoord(block.x, block.y, block.z);
+  if (IsSolidBlock(chunk->voxels.Get(local.x, local.y, local.z))) {
+    return;
+  }
+  if (chunk->fluid_levels.empty()) {
+    chunk->fluid_levels.assign(static_cast<size_t>(kChunkVolume), 0);
+  }
+  const ChunkIndex index = GetLocalIndex(local);
+  uint8_t& level = chunk->fluid_levels[index];
+  if ((level & kFluidQueuedBit) != 0) {
+    return;
+  }
+  level |= kFluidQueuedBit;
+  chunk->fluid_active.push_back(index);
+  if (!chunk->fluid_queued) {
+    chunk->fluid_queued = true;
+    state.active_chunks.push_back(chunk->coord);
+  }
+}
+
+void RunFluidStep(FluidState& state, World& world, JobSystem& jobs,
+                  FluidStats& stats) {
+  ++state.step;
+  const bool lava_step = (state.step % kLavaStepInterval) == 0;
+  state.step_chunks.swap(state.active_chunks);
+  state.active_chunks.clear();
+
+  size_t job_count = 0;
+  int budget = kFluidMaxCellsPerStep;
+  for (const Int3& coord : state.step_chunks) {
+    Chunk* chunk = FindChunk(world, coord);
+    if (!chunk || !chunk->fluid_queued) {
+      continue;
+    }
+    if (budget <= 0) {
+      state.active_chunks.push_back(coord);
+      continue;
+    }
+    if (job_count == state.jobs.size()) {
+      state.jobs.emplace_back();
+    }
+    FluidJob& job = state.jobs[job_count++];
+    job.chunk = chunk;
+    job.cells.swap(chunk->fluid_active);
+    chunk->fluid_active.clear();
+    chunk->fluid_queued = false;
+    for (ChunkIndex index : job.cells) {
+      chunk->fluid_levels[index] &= kFluidDistanceMask;
+    }
+    budget -= static_cast<int>(job.cells.size());
+    stats.cell_updates += static_cast<int>(job.cells.size());
+  }
+
+  ParallelFor(jobs, static_cast<int>(job_count), [&](int i) {
+    RunFluidJob(world, state.jobs[static_cast<size_t>(i)], lava_step);
+  });
+
+  for (size_t i = 0; i < job_count; ++i) {
+    FluidJob& job = state.jobs[i];
+    for (const FluidWrite& write : job.writes) {
+      ApplyFluidWrite(state, world, *job.chunk, write);
+    }
+    for (ChunkIndex index : job.deferred) {
+      ActivateFluidCell(state, world, GetChunkBlock(*job.chunk, index));
+    }
+    stats.cell_writes += static_cast<int>(job.writes.size());
+  }
+}
+
+void UpdateFluids(FluidState& state, World& world, JobSystem& jobs, float dt,
+                  FluidStats& stats) {
+  const ScopedProfile profile("UpdateFluids");
+  const auto start = std::chrono::steady_clock::now();
+  stats = {};
+  ActivateChangedCells(state, world);
+
+  const float step = 1.0f / static_cast<float>(kFluidStepRate);
+  state.accumulator =
+      std::min(state.accumulator + dt, step * kMaxFluidStepsPerUpdate);
+  while (state.accumulator >= step) {
+    state.accumulator -= step;
+    RunFluidStep(state, world, jobs, stats);
+  }
+
+  for (const Int3& coord : state.active_chunks) {
+    if (const Chunk* chunk = FindChunk(world, coord)) {
+      stats.active_cells += static_cast<int>(chunk->fluid_active.size());
+    }
+  }
+  stats.active_chunks = static_cast<int>(state.active_chunks.size());
+  const auto end = std::chrono::steady_clock::now();
+  stats.update_ms =
+      std::chrono::duration<float, std::milli>(end - start).count();
+  stats.cells_per_second =
+      (stats.update_ms > 0.0f)
+          ? static_cast<float>(stats.cell_updates) * 1000.0f / stats.update_ms
+          : 0.0f;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "job_system.h"
+#include "world.h"
+
+constexpr int kFluidStepRate = 8;
+constexpr int kMaxFluidStepsPerUpdate = 2;
+constexpr int kLavaStepInterval = 3;
+constexpr int kWaterMaxDistance = 7;
+constexpr int kLavaMaxDistance = 3;
+constexpr int kFluidMaxCellsPerStep = 32768;
+constexpr uint8_t kFluidDistanceMask = 0x0F;
+constexpr uint8_t kFluidQueuedBit = 0x80;
+
+struct FluidWrite {
+  ChunkIndex index = 0;
+  BlockId id = BlockId::Air;
+  uint8_t distance = 0;
+};
+
+struct FluidJob {
+  Chunk* chunk = nullptr;
+  std::vector<ChunkIndex> cells;
+  std::vector<FluidWrite> writes;
+  std::vector<ChunkIndex> deferred;
+};
+
+struct FluidStats {
+  int active_chunks = 0;
+  int active_cells = 0;
+  int cell_updates = 0;
+  int cell_writes = 0;
+  float update_ms = 0.0f;
+  float cells_per_second = 0.0f;
+};
+
+struct FluidState {
+  uint64_t step = 0;
+  float accumulator = 0.0f;
+  std::vector<Int3> active_chunks;
+  std::vector<Int3> step_chunks;
+  std::vector<FluidJob> jobs;
+};
+
+void ActivateFluidCell(FluidState& state, World& world, const Int3& block);
+void RunFluidStep(FluidState& state, World& world, JobSystem& jobs,
+                  FluidStats& stats);
+void UpdateFluids(FluidState& state, World& world, JobSystem& jobs, float dt,
+                  FluidStats& stats);
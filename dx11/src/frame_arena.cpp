@@ -0,0 +1,61 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <new>
+
+#include "alloc_tracker.h"
+
+namespace {
+bool OwnsFrameBytes(const FrameArena& arena, const void* data) {
+  const std::byte* bytes = static_cast<const std::byte*>(data);
+  return !arena.storage.empty() && bytes >= arena.storage.data() &&
+         bytes < arena.storage.data() + arena.storage.size();
+}
+}  // namespace
+
+FrameArena& GetFrameArena() {
+  thread_local FrameArena arena;
+  return arena;
+}
+
+void ResetFrameArena(FrameArena& arena) {
+  const uint64_t heap_allocations = GetThreadHeapAllocations();
+  arena.stats.frame_bytes = arena.offset;
+  arena.stats.high_water_bytes =
+      std::max(arena.stats.high_water_bytes, arena.offset);
+  arena.stats.frame_overflows = arena.overflows;
+  arena.stats.frame_heap_allocations =
+      heap_allocations - arena.heap_allocations_at_reset;
+  arena.heap_allocations_at_reset = heap_allocations;
+  arena.offset = 0;
+  arena.overflows = 0;
+}
+
+void* AllocateFrameBytes(FrameArena& arena, size_t bytes, size_t alignment) {
+  if (arena.storage.empty()) {
+    arena.storage.resize(kFrameArenaBytes);
+    arena.heap_allocations_at_reset = GetThreadHeapAllocations();
+  }
+  const uintptr_t base = reinterpret_cast<uintptr_t>(arena.storage.data());
+  const uintptr_t begin =
+      (base + arena.offset + alignment - 1) & ~(uintptr_t{alignment} - 1);
+  const size_t end = static_cast<size_t>(begin - base) + bytes;
+  if (end > arena.storage.size()) {
+    ++arena.overflows;
+    return ::operator new(bytes);
+  }
+  arena.offset = end;
+  arena.stats.high_water_bytes = std::max(arena.stats.high_water_bytes, end);
+  return reinterpret_cast<void*>(begin);
+}
+
+void FreeFrameBytes(FrameArena& arena, void* data, size_t bytes) {
+  if (!OwnsFrameBytes(arena, data)) {
+    ::operator delete(data);
+    return;
+  }
+  std::byte* begin = static_cast<std::byte*>(data);
+  if (begin + bytes == arena.storage.data() + arena.offset) {
+    arena.offset = static_cast<size_t>(begin - arena.storage.data());
+  }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr size_t kFrameArenaBytes = 4 * 1024 * 1024;
+
+struct FrameArenaStats {
+  size_t frame_bytes = 0;
+  size_t high_water_bytes = 0;
+  uint64_t frame_overflows = 0;
+  uint64_t frame_heap_allocations = 0;
+};
+
+struct FrameArena {
+  std::vector<std::byte> storage;
+  size_t offset = 0;
+  uint64_t overflows = 0;
+  uint64_t heap_allocations_at_reset = 0;
+  FrameArenaStats stats;
+};
+
+FrameArena& GetFrameArena();
+void ResetFrameArena(FrameArena& arena);
+void* AllocateFrameBytes(FrameArena& arena, size_t bytes, size_t alignment);
+void FreeFrameBytes(FrameArena& arena, void* data, size_t bytes);
+
+template <typename T>
+struct FrameAllocator {
+  using value_type = T;
+
+  FrameArena* arena;
+
+  FrameAllocator() : arena(&GetFrameArena()) {}
+  explicit FrameAllocator(FrameArena& arena) : arena(&arena) {}
+  template <typename U>
+  FrameAllocator(const FrameAllocator<U>& other) noexcept
+      : arena(other.arena) {}
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(
+        AllocateFrameBytes(*arena, count * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* data, size_t count) {
+    FreeFrameBytes(*arena, data, count * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const FrameAllocator<U>& other) const noexcept {
+    return arena == other.arena;
+  }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class FramePhase : uint8_t {
+  Other,
+  UpdatePlayer,
+  StreamChunks,
+  UpdateChunkMeshes,
+  UpdateHudMesh,
+  RenderFrame,
+  Count,
+};
+
+constexpr size_t kFramePhaseCount = static_cast<size_t>(FramePhase::Count);
+
+constexpr const char* GetFramePhaseName(FramePhase phase) {
+  switch (phase) {
+    case FramePhase::Other:
+      return "Other";
+    case FramePhase::UpdatePlayer:
+      return "UpdatePlayer";
+    case FramePhase::StreamChunks:
+      return "StreamChunks";
+    case FramePhase::UpdateChunkMeshes:
+      return "UpdateChunkMeshes";
+    case FramePhase::UpdateHudMesh:
+      return "UpdateHudMesh";
+    case FramePhase::RenderFrame:
+      return "RenderFrame";
+    case FramePhase::Count:
+      break;
+  }
+  return "Unknown";
+}
@@ -0,0 +1,48 @@
+#include "frame_stats.h"
+
+#include <algorithm>
+
+namespace {
+float GetSortedPercentile(const std::array<float, kFrameHistoryLength>& sorted,
+                          size_t count, float percentile) {
+  const size_t index = static_cast<size_t>(
+      percentile * static_cast<float>(count - 1) + 0.5f);
+  return sorted[std::min(index, count - 1)];
+}
+}  // namespace
+
+FrameStats& GetFrameStats() {
+  thread_local FrameStats stats;
+  return stats;
+}
+
+void EndFrameStats(FrameStats& stats, float frame_ms) {
+  stats.frame_ms[stats.next_sample] = frame_ms;
+  stats.next_sample = (stats.next_sample + 1) % kFrameHistoryLength;
+  stats.sample_count = std::min(stats.sample_count + 1, kFrameHistoryLength);
+  stats.last_frame_ms = frame_ms;
+  stats.last_phase_ms = stats.phase_ms;
+  stats.phase_ms.fill(0.0f);
+
+  stats.percentile_timer += frame_ms * 0.001f;
+  if (stats.percentile_timer < kFramePercentileInterval) {
+    return;
+  }
+  stats.percentile_timer = 0.0f;
+  std::array<float, kFrameHistoryLength> sorted = stats.frame_ms;
+  const size_t count = stats.sample_count;
+  std::sort(sorted.begin(), sorted.begin() + static_cast<ptrdiff_t>(count));
+  stats.p50_ms = GetSortedPercentile(sorted, count, 0.50f);
+  stats.p95_ms = GetSortedPercentile(sorted, count, 0.95f);
+  stats.p99_ms = GetSortedPercentile(sorted, count, 0.99f);
+  stats.max_ms = sorted[count - 1];
+}
+
+float GetFrameSample(const FrameStats& stats, size_t age) {
+  if (age >= stats.sample_count) {
+    return 0.0f;
+  }
+  const size_t index =
+      (stats.next_sample + kFrameHistoryLength - 1 - age) % kFrameHistoryLength;
+  return stats.frame_ms[index];
+}
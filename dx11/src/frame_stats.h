@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "alloc_tracker.h"
+#include "frame_phase.h"
+#include "profiler.h"
+
+constexpr size_t kFrameHistoryLength = 240;
+constexpr float kFramePercentileInterval = 0.5f;
+
+struct FrameStats {
+  std::array<float, kFrameHistoryLength> frame_ms{};
+  size_t next_sample = 0;
+  size_t sample_count = 0;
+  std::array<float, kFramePhaseCount> phase_ms{};
+  std::array<float, kFramePhaseCount> last_phase_ms{};
+  float last_frame_ms = 0.0f;
+  float p50_ms = 0.0f;
+  float p95_ms = 0.0f;
+  float p99_ms = 0.0f;
+  float max_ms = 0.0f;
+  float percentile_timer = 0.0f;
+};
+
+FrameStats& GetFrameStats();
+void EndFrameStats(FrameStats& stats, float frame_ms);
+float GetFrameSample(const FrameStats& stats, size_t age);
+
+struct ScopedFramePhase {
+  explicit ScopedFramePhase(FramePhase phase)
+      : profile(GetFramePhaseName(phase)),
+        alloc_phase(phase),
+        phase(phase),
+        begin_ns(GetProfileTimeNs()) {}
+  ~ScopedFramePhase() {
+    GetFrameStats().phase_ms[static_cast<size_t>(phase)] +=
+        static_cast<float>(GetProfileTimeNs() - begin_ns) * 1e-6f;
+  }
+
+  ScopedProfile profile;
+  ScopedAllocPhase alloc_phase;
+  FramePhase phase;
+  int64_t begin_ns;
+
+  ScopedFramePhase(const ScopedFramePhase&) = delete;
+  ScopedFramePhase& operator=(const ScopedFramePhase&) = delete;
+};
@@ -1,5 +1,7 @@
 #include "input.h"
 
+#include "world.h"
+
 namespace {
 void SetCursorVisible(bool visible) {
   if (visible) {
@@ -45,6 +47,7 @@ void InitInput(InputState& input, HWND hwnd) {
   input.jump_pressed = false;
   input.crouch_down = false;
   input.speed_boost = false;
+  input.hotbar_slot = 0;
 }
 
 void UpdateClipRect(InputState& input) {
@@ -107,6 +110,9 @@ void UpdateInput(InputState& input) {
   input.jump_pressed = jump && !input.jump_down;
   input.jump_down = jump;
   input.crouch_down = crouch;
+  const bool trace = (GetAsyncKeyState(VK_F9) & 0x8000) != 0;
+  input.trace_pressed = trace && !input.trace_down;
+  input.trace_down = trace;
 
   input.mouse_dx = 0.0f;
   input.mouse_dy = 0.0f;
@@ -146,4 +152,10 @@ void UpdateInput(InputState& input) {
     --input.move_up;
   }
   input.speed_boost = sprint;
+
+  for (int slot = 0; slot < static_cast<int>(kHotbarBlocks.size()); ++slot) {
+    if (GetAsyncKeyState('1' + slot) & 0x8000) {
+      input.hotbar_slot = slot;
+    }
+  }
 }
@@ -19,6 +19,9 @@ struct InputState {
   int move_right = 0;
   int move_up = 0;
   bool speed_boost = false;
+  int hotbar_slot = 0;
+  bool trace_down = false;
+  bool trace_pressed = false;
 };
 
 void InitInput(InputState& input, HWND hwnd);
@@ -0,0 +1,125 @@
+#include "job_system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <latch>
+#include <utility>
+
+#include "profiler.h"
+
+namespace {
+void WorkerLoop(JobSystem& jobs, int index) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "worker %d", index);
+  SetProfilerThreadName(name);
+  for (;;) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(jobs.mutex);
+      jobs.wake.wait(lock,
+                     [&jobs] { return jobs.stopping || !jobs.queue.empty(); });
+      if (jobs.queue.empty()) {
+        return;
+      }
+      job = std::move(jobs.queue.front());
+      jobs.queue.pop_front();
+    }
+    {
+      const ScopedProfile profile("Job");
+      job();
+    }
+    {
+      std::lock_guard<std::mutex> lock(jobs.mutex);
+      --jobs.active_jobs;
+      if (jobs.active_jobs == 0) {
+        jobs.idle.notify_all();
+      }
+    }
+  }
+}
+}  // namespace
+
+void InitJobSystem(JobSystem& jobs, int worker_count) {
+  if (worker_count < 0) {
+    const int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    worker_count = std::max(0, hardware - 1);
+  }
+  jobs.stopping = false;
+  jobs.workers.reserve(static_cast<size_t>(worker_count));
+  for (int i = 0; i < worker_count; ++i) {
+    jobs.workers.emplace_back(WorkerLoop, std::ref(jobs), i);
+  }
+}
+
+void ShutdownJobSystem(JobSystem& jobs) {
+  {
+    std::lock_guard<std::mutex> lock(jobs.mutex);
+    jobs.stopping = true;
+  }
+  jobs.wake.notify_all();
+  for (std::thread& worker : jobs.workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  jobs.workers.clear();
+}
+
+void SubmitJob(JobSystem& jobs, std::function<void()> job) {
+  if (jobs.workers.empty()) {
+    job();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(jobs.mutex);
+    jobs.queue.push_back(std::move(job));
+    ++jobs.active_jobs;
+  }
+  jobs.wake.notify_one();
+}
+
+void WaitForJobs(JobSystem& jobs) {
+  std::unique_lock<std::mutex> lock(jobs.mutex);
+  jobs.idle.wait(lock, [&jobs] { return jobs.active_jobs == 0; });
+}
+
+void ParallelFor(JobSystem& jobs, int count,
+                 const std::function<void(int)>& body) {
+  if (count <= 0) {
+    return;
+  }
+  const int helpers =
+      std::min(count - 1, static_cast<int>(jobs.workers.size()));
+  if (helpers <= 0) {
+    for (int i = 0; i < count; ++i) {
+      body(i);
+    }
+    return;
+  }
+
+  std::atomic<int> next{0};
+  std::latch finished(helpers);
+  const auto run = [&next, &body, count] {
+    for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+      body(i);
+    }
+  };
+  for (int i = 0; i < helpers; ++i) {
+    SubmitJob(jobs, [&run, &finished] {
+      run();
+      finished.count_down();
+    });
+  }
+  run();
+  finished.wait();
+}
+
+int GetWorkerCount(const JobSystem& jobs) {
+  return static_cast<int>(jobs.workers.size());
+}
+
+int GetPendingJobCount(JobSystem& jobs) {
+  std::lock_guard<std::mutex> lock(jobs.mutex);
+  return jobs.active_jobs;
+}
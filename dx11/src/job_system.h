@@ -0,0 +1,27 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct JobSystem {
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> queue;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable idle;
+  int active_jobs = 0;
+  bool stopping = false;
+};
+
+void InitJobSystem(JobSystem& jobs, int worker_count);
+void ShutdownJobSystem(JobSystem& jobs);
+void SubmitJob(JobSystem& jobs, std::function<void()> job);
+void WaitForJobs(JobSystem& jobs);
+void ParallelFor(JobSystem& jobs, int count,
+                 const std::function<void(int)>& body);
+int GetWorkerCount(const JobSystem& jobs);
+int GetPendingJobCount(JobSystem& jobs);
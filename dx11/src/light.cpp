@@ -0,0 +1,344 @@
+#include "light.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "profiler.h"
+
+namespace {
+enum class LightChannel {
+  Sky,
+  Block,
+};
+
+struct LightCursor {
+  World& world;
+  Int3 origin{0, 0, 0};
+  std::array<Chunk*, 27> chunks{};
+  std::array<bool, 27> resolved{};
+};
+
+ChunkIndex GetLocalIndex(int x, int y, int z) {
+  return static_cast<ChunkIndex>(ChunkDims::Index(x, y, z));
+}
+
+Chunk* GetLitNeighbor(Chunk& chunk, const FaceDef& face) {
+  Chunk* neighbor = chunk.neighbors[static_cast<size_t>(face.dir)];
+  return (neighbor && !neighbor->light.empty()) ? neighbor : nullptr;
+}
+
+Chunk* GetCursorChunk(LightCursor& cursor, const Int3& coord) {
+  const int dx = coord.x - cursor.origin.x + 1;
+  const int dy = coord.y - cursor.origin.y + 1;
+  const int dz = coord.z - cursor.origin.z + 1;
+  if (dx < 0 || dx > 2 || dy < 0 || dy > 2 || dz < 0 || dz > 2) {
+    Chunk* chunk = FindChunk(cursor.world, coord);
+    return (chunk && !chunk->light.empty()) ? chunk : nullptr;
+  }
+  const size_t slot = static_cast<size_t>(dx + dy * 3 + dz * 9);
+  if (!cursor.resolved[slot]) {
+    Chunk* chunk = FindChunk(cursor.world, coord);
+    cursor.chunks[slot] = (chunk && !chunk->light.empty()) ? chunk : nullptr;
+    cursor.resolved[slot] = true;
+  }
+  return cursor.chunks[slot];
+}
+
+bool StepCell(Chunk& chunk, ChunkIndex index, const FaceDef& face,
+              Chunk*& neighbor, ChunkIndex& neighbor_index) {
+  const int axis = face.neighbor.x != 0 ? 0 : (face.neighbor.y != 0 ? 1 : 2);
+  const int sign = face.neighbor.x + face.neighbor.y + face.neighbor.z;
+  neighbor = &chunk;
+  if (ChunkDims::CrossesBorder(index, axis, sign)) {
+    neighbor = GetLitNeighbor(chunk, face);
+    if (!neighbor) {
+      return false;
+    }
+  }
+  neighbor_index = static_cast<ChunkIndex>(ChunkDims::Step(index, axis, sign));
+  return true;
+}
+
+int ReadLevel(const Chunk& chunk, ChunkIndex index, LightChannel channel) {
+  const uint8_t light = chunk.light[index];
+  return (channel == LightChannel::Sky) ? (light >> kSkyLightShift)
+                                        : (light & kBlockLightMask);
+}
+
+void StoreLevel(Chunk& chunk, ChunkIndex index, LightChannel channel,
+                int level) {
+  uint8_t& light = chunk.light[index];
+  if (channel == LightChannel::Sky) {
+    light = static_cast<uint8_t>((light & kBlockLightMask) |
+                                 (level << kSkyLightShift));
+  } else {
+    light = static_cast<uint8_t>((light & ~kBlockLightMask) | level);
+  }
+}
+
+void WriteLevel(World& world, Chunk& chunk, ChunkIndex index,
+                LightChannel channel, int level) {
+  StoreLevel(chunk, index, channel, level);
+  chunk.dirty = true;
+  MarkBorderChunksDirty(world, chunk,
+                        {ChunkDims::Local(index, 0), ChunkDims::Local(index, 1),
+                         ChunkDims::Local(index, 2)});
+}
+
+int GetSpreadLevel(LightChannel channel, int level, const FaceDef& face) {
+  if (channel == LightChannel::Sky && level == kMaxLightLevel &&
+      face.dir == FaceDir::NegY) {
+    return kMaxLightLevel;
+  }
+  return level - 1;
+}
+
+void PropagateLight(LightCursor& cursor, LightChannel channel) {
+  std::vector<LightNode>& queue = cursor.world.light_queues.add;
+  for (size_t head = 0; head < queue.size(); ++head) {
+    const LightNode node = queue[head];
+    const int level = ReadLevel(*node.chunk, node.index, channel);
+    if (level <= 1) {
+      continue;
+    }
+    for (const FaceDef& face : kFaces) {
+      Chunk* neighbor = nullptr;
+      ChunkIndex index = 0;
+      if (!StepCell(*node.chunk, node.index, face, neighbor, index) ||
+          IsOpaqueBlock(neighbor->voxels.blocks[index])) {
+        continue;
+      }
+      const int next = GetSpreadLevel(channel, level, face);
+      if (ReadLevel(*neighbor, index, channel) >= next) {
+        continue;
+      }
+      WriteLevel(cursor.world, *neighbor, index, channel, next);
+      queue.push_back({neighbor, index, static_cast<uint8_t>(next)});
+    }
+  }
+  queue.clear();
+}
+
+void RemoveLight(LightCursor& cursor, LightChannel channel) {
+  LightQueues& queues = cursor.world.light_queues;
+  for (size_t head = 0; head < queues.remove.size(); ++head) {
+    const LightNode node = queues.remove[head];
+    for (const FaceDef& face : kFaces) {
+      Chunk* neighbor = nullptr;
+      ChunkIndex index = 0;
+      if (!StepCell(*node.chunk, node.index, face, neighbor, index)) {
+        continue;
+      }
+      const int level = ReadLevel(*neighbor, index, channel);
+      if (level == 0) {
+        continue;
+      }
+      const bool dependent =
+          level < node.level ||
+          (channel == LightChannel::Sky && face.dir == FaceDir::NegY &&
+           node.level == kMaxLightLevel);
+      if (!dependent) {
+        queues.add.push_back({neighbor, index, static_cast<uint8_t>(level)});
+        continue;
+      }
+      WriteLevel(cursor.world, *neighbor, index, channel, 0);
+      queues.remove.push_back({neighbor, index, static_cast<uint8_t>(level)});
+      const int emission = (channel == LightChannel::Block)
+                               ? GetBlockEmission(neighbor->voxels.blocks[index])
+                               : 0;
+      if (emission > 0) {
+        WriteLevel(cursor.world, *neighbor, index, channel, emission);
+        queues.add.push_back({neighbor, index, static_cast<uint8_t>(emission)});
+      }
+    }
+  }
+  queues.remove.clear();
+}
+
+void SeedNeighbors(LightCursor& cursor, Chunk& chunk, ChunkIndex index,
+                   LightChannel channel) {
+  for (const FaceDef& face : kFaces) {
+    Chunk* neighbor = nullptr;
+    ChunkIndex neighbor_index = 0;
+    if (!StepCell(chunk, index, face, neighbor, neighbor_index)) {
+      continue;
+    }
+    const int level = ReadLevel(*neighbor, neighbor_index, channel);
+    if (level > 1) {
+      cursor.world.light_queues.add.push_back(
+          {neighbor, neighbor_index, static_cast<uint8_t>(level)});
+    }
+  }
+}
+
+void SeedChunkBorders(LightCursor& cursor, Chunk& chunk,
+                      LightChannel channel) {
+  for (const FaceDef& face : kFaces) {
+    Chunk* neighbor = GetLitNeighbor(chunk, face);
+    if (!neighbor) {
+      continue;
+    }
+    for (int j = 0; j < kChunkSize; ++j) {
+      for (int i = 0; i < kChunkSize; ++i) {
+        Int3 local{};
+        if (face.neighbor.x != 0) {
+          local = {face.neighbor.x > 0 ? 0 : kChunkSize - 1, i, j};
+        } else if (face.neighbor.y != 0) {
+          local = {i, face.neighbor.y > 0 ? 0 : kChunkSize - 1, j};
+        } else {
+          local = {i, j, face.neighbor.z > 0 ? 0 : kChunkSize - 1};
+        }
+        const ChunkIndex index = GetLocalIndex(local.x, local.y, local.z);
+        const int level = ReadLevel(*neighbor, index, channel);
+        if (level > 1) {
+          cursor.world.light_queues.add.push_back(
+              {neighbor, index, static_cast<uint8_t>(level)});
+        }
+      }
+    }
+  }
+}
+
+void SeedSkyColumns(LightCursor& cursor, Chunk& chunk) {
+  const Chunk* above = GetCursorChunk(
+      cursor, {chunk.coord.x, chunk.coord.y + 1, chunk.coord.z});
+  for (int z = 0; z < kChunkSize; ++z) {
+    for (int x = 0; x < kChunkSize; ++x) {
+      if (above && ReadLevel(*above, GetLocalIndex(x, 0, z),
+                             LightChannel::Sky) != kMaxLightLevel) {
+        continue;
+      }
+      for (int y = kChunkSize - 1; y >= 0; --y) {
+        const ChunkIndex index = GetLocalIndex(x, y, z);
+        if (IsOpaqueBlock(chunk.voxels.blocks[index])) {
+          break;
+        }
+        StoreLevel(chunk, index, LightChannel::Sky, kMaxLightLevel);
+        cursor.world.light_queues.add.push_back(
+            {&chunk, index, static_cast<uint8_t>(kMaxLightLevel)});
+      }
+    }
+  }
+}
+
+void SeedEmitters(LightCursor& cursor, Chunk& chunk) {
+  for (ChunkIndex index = 0; index < kChunkVolume; ++index) {
+    const int emission = GetBlockEmission(chunk.voxels.blocks[index]);
+    if (emission == 0) {
+      continue;
+    }
+    StoreLevel(chunk, index, LightChannel::Block, emission);
+    cursor.world.light_queues.add.push_back(
+        {&chunk, index, static_cast<uint8_t>(emission)});
+  }
+}
+
+void ClearChunkLight(LightCursor& cursor, Chunk& chunk, LightChannel channel) {
+  for (ChunkIndex index = 0; index < kChunkVolume; ++index) {
+    const int level = ReadLevel(chunk, index, channel);
+    if (level == 0) {
+      continue;
+    }
+    StoreLevel(chunk, index, channel, 0);
+    cursor.world.light_queues.remove.push_back(
+        {&chunk, index, static_cast<uint8_t>(level)});
+  }
+  RemoveLight(cursor, channel);
+}
+
+std::array<float, kMaxLightLevel + 1> BuildBrightnessTable() {
+  std::array<float, kMaxLightLevel + 1> table{};
+  for (int level = 0; level <= kMaxLightLevel; ++level) {
+    table[static_cast<size_t>(level)] = std::max(
+        kMinLightBrightness,
+        std::pow(kLightFalloff, static_cast<float>(kMaxLightLevel - level)));
+  }
+  return table;
+}
+}  // namespace
+
+int GetBlockEmission(BlockId id) {
+  return (id == BlockId::Lava) ? kMaxLightLevel : 0;
+}
+
+uint8_t GetLight(const World& world, int x, int y, int z) {
+  const Chunk* chunk = FindChunk(world, WorldToChunkCoord(x, y, z));
+  if (!chunk || chunk->light.empty()) {
+    return kFullSkyLight;
+  }
+  const Int3 local = WorldToLocalCoord(x, y, z);
+  return chunk->light[GetLocalIndex(local.x, local.y, local.z)];
+}
+
+float GetLightBrightness(uint8_t light) {
+  static const std::array<float, kMaxLightLevel + 1> table =
+      BuildBrightnessTable();
+  const int level = std::max(light >> kSkyLightShift, light & kBlockLightMask);
+  return table[static_cast<size_t>(level)];
+}
+
+void InitChunkLight(World& world, Chunk& chunk) {
+  const ScopedProfile profile("InitChunkLight");
+  LightCursor cursor{world, chunk.coord};
+  const bool relight = !chunk.light.empty();
+  if (!relight) {
+    chunk.light.assign(static_cast<size_t>(kChunkVolume), 0);
+  }
+
+  if (relight) {
+    ClearChunkLight(cursor, chunk, LightChannel::Sky);
+  }
+  SeedSkyColumns(cursor, chunk);
+  SeedChunkBorders(cursor, chunk, LightChannel::Sky);
+  PropagateLight(cursor, LightChannel::Sky);
+
+  if (relight) {
+    ClearChunkLight(cursor, chunk, LightChannel::Block);
+  }
+  SeedEmitters(cursor, chunk);
+  SeedChunkBorders(cursor, chunk, LightChannel::Block);
+  PropagateLight(cursor, LightChannel::Block);
+}
+
+void RelightBlock(World& world, const Int3& block, BlockId previous,
+                  BlockId id) {
+  LightCursor cursor{world, WorldToChunkCoord(block.x, block.y, block.z)};
+  Chunk* chunk = GetCursorChunk(cursor, cursor.origin);
+  if (!chunk) {
+    return;
+  }
+  const Int3 local = WorldToLocalCoord(block.x, block.y, block.z);
+  const ChunkIndex index = GetLocalIndex(local.x, local.y, local.z);
+  LightQueues& queues = world.light_queues;
+  const bool opaque = IsOpaqueBlock(id);
+  const bool opened = !opaque && IsOpaqueBlock(previous);
+
+  const int sky = ReadLevel(*chunk, index, LightChannel::Sky);
+  if (opaque && sky > 0) {
+    WriteLevel(world, *chunk, index, LightChannel::Sky, 0);
+    queues.remove.push_back({chunk, index, static_cast<uint8_t>(sky)});
+    RemoveLight(cursor, LightChannel::Sky);
+  }
+  if (opened) {
+    SeedNeighbors(cursor, *chunk, index, LightChannel::Sky);
+  }
+  PropagateLight(cursor, LightChannel::Sky);
+
+  const int light = ReadLevel(*chunk, index, LightChannel::Block);
+  const bool was_emitter = GetBlockEmission(previous) > 0;
+  if (light > 0 && (opaque || was_emitter)) {
+    WriteLevel(world, *chunk, index, LightChannel::Block, 0);
+    queues.remove.push_back({chunk, index, static_cast<uint8_t>(light)});
+    RemoveLight(cursor, LightChannel::Block);
+  }
+  const int emission = GetBlockEmission(id);
+  if (emission > 0) {
+    WriteLevel(world, *chunk, index, LightChannel::Block, emission);
+    queues.add.push_back({chunk, index, static_cast<uint8_t>(emission)});
+  }
+  if (opened || (!opaque && was_emitter)) {
+    SeedNeighbors(cursor, *chunk, index, LightChannel::Block);
+  }
+  PropagateLight(cursor, LightChannel::Block);
+}
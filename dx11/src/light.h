@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+#include "world.h"
+
+constexpr int kMaxLightLevel = 15;
+constexpr int kSkyLightShift = 4;
+constexpr uint8_t kBlockLightMask = 0x0F;
+constexpr uint8_t kFullSkyLight = kMaxLightLevel << kSkyLightShift;
+constexpr float kLightFalloff = 0.82f;
+constexpr float kMinLightBrightness = 0.06f;
+
+int GetBlockEmission(BlockId id);
+uint8_t GetLight(const World& world, int x, int y, int z);
+float GetLightBrightness(uint8_t light);
+void InitChunkLight(World& world, Chunk& chunk);
+void RelightBlock(World& world, const Int3& block, BlockId previous,
+                  BlockId id);
@@ -1,8 +1,26 @@
 #include <windows.h>
+#include <shellapi.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cwchar>
+#include <string>
+
+#include "alloc_tracker.h"
+#include "block_tick.h"
 #include "camera.h"
+#include "entity.h"
+#include "fluid.h"
+#include "frame_arena.h"
+#include "frame_stats.h"
 #include "input.h"
+#include "job_system.h"
+#include "memory_stats.h"
+#include "net_client.h"
 #include "player.h"
+#include "profiler.h"
 #include "renderer.h"
 #include "world.h"
 
@@ -11,6 +29,8 @@ constexpr int kInitialWidth = 1280;
 constexpr int kInitialHeight = 720;
 constexpr wchar_t kWindowClassName[] = L"MinecraftCloneDX11Window";
 constexpr wchar_t kWindowTitle[] = L"Minecraft Clone - DirectX 11";
+constexpr int kInitialMobCount = 64;
+constexpr float kInitialMobSpread = 24.0f;
 
 RendererState g_renderer;
 World g_world;
@@ -18,12 +38,26 @@ CameraState g_camera = {{0.0f, 0.0f, 0.0f}, 0.0f, 0.0f, kMoveSpeed,
                          kMouseSensitivity};
 PlayerState g_player;
 InputState g_input;
+JobSystem g_jobs;
+EntityStore g_entities;
+EntityStats g_entity_stats;
+BlockTickState g_block_ticks;
+BlockTickStats g_block_tick_stats;
+FluidState g_fluids;
+FluidStats g_fluid_stats;
+NetClientState g_net;
+bool g_networked = false;
 
 RayHit g_hover_hit;
 bool g_hover_valid = false;
 float g_fps = 0.0f;
 float g_fps_timer = 0.0f;
 int g_fps_samples = 0;
+float g_trace_cooldown = kProfileSpikeCooldown;
+int g_trace_count = 0;
+bool g_memory_report = false;
+float g_memory_report_timer = 0.0f;
+double g_run_seconds = 0.0;
 
 void UpdateFps(float dt) {
   g_fps_timer += dt;
@@ -35,6 +69,35 @@ void UpdateFps(float dt) {
   }
 }
 
+void UpdateProfilerTriggers(float frame_seconds) {
+  g_trace_cooldown = std::max(0.0f, g_trace_cooldown - frame_seconds);
+  if (g_input.trace_pressed && !IsProfilerEnabled()) {
+    SetProfilerEnabled(true);
+    return;
+  }
+  const bool spike = IsProfilerEnabled() &&
+                     frame_seconds * 1000.0f > kProfileSpikeMs &&
+                     g_trace_cooldown <= 0.0f;
+  if (!g_input.trace_pressed && !spike) {
+    return;
+  }
+  char path[64];
+  std::snprintf(path, sizeof(path), "trace_%s_%d.json",
+                spike ? "spike" : "manual", g_trace_count++);
+  WriteChromeTrace(path);
+  g_trace_cooldown = kProfileSpikeCooldown;
+}
+
+void UpdateMemoryReport(float frame_seconds) {
+  g_run_seconds += frame_seconds;
+  g_memory_report_timer += frame_seconds;
+  if (!g_memory_report || g_memory_report_timer < kMemoryReportInterval) {
+    return;
+  }
+  g_memory_report_timer = 0.0f;
+  AppendMemoryReport("memory_report.jsonl", g_run_seconds);
+}
+
 void UpdateHoverHit() {
   if (!g_input.mouse_captured) {
     g_hover_valid = false;
@@ -52,6 +115,70 @@ void UpdateHoverHit() {
   }
 }
 
+bool HasCommandLineFlag(const wchar_t* flag) {
+  int argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+  if (!argv) {
+    return false;
+  }
+  bool found = false;
+  for (int i = 1; i < argc && !found; ++i) {
+    found = std::wcscmp(argv[i], flag) == 0;
+  }
+  LocalFree(argv);
+  return found;
+}
+
+bool ParseConnectTarget(std::string& host, uint16_t& port) {
+  int argc = 0;
+  LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+  if (!argv) {
+    return false;
+  }
+  bool found = false;
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (std::wcscmp(argv[i], L"--connect") != 0) {
+      continue;
+    }
+    char target[256]{};
+    WideCharToMultiByte(CP_UTF8, 0, argv[i + 1], -1, target, sizeof(target),
+                        nullptr, nullptr);
+    host = target;
+    port = kDefaultServerPort;
+    const size_t colon = host.rfind(':');
+    if (colon != std::string::npos) {
+      port = static_cast<uint16_t>(std::atoi(host.c_str() + colon + 1));
+      host.resize(colon);
+    }
+    found = !host.empty();
+    break;
+  }
+  LocalFree(argv);
+  return found;
+}
+
+void SpawnInitialMobs() {
+  for (int i = 0; i < kInitialMobCount; ++i) {
+    const float angle = static_cast<float>(i) * 2.39996f;
+    const float radius = kInitialMobSpread *
+                         static_cast<float>(i + 1) /
+                         static_cast<float>(kInitialMobCount);
+    SpawnMob(g_entities, {g_player.position.x + std::sin(angle) * radius,
+                          g_player.position.y,
+                          g_player.position.z + std::cos(angle) * radius});
+  }
+}
+
+void SpawnBlockDrop(const Int3& block, BlockId id) {
+  if (id == BlockId::Air) {
+    return;
+  }
+  SpawnItem(g_entities, {(static_cast<float>(block.x) + 0.5f) * kBlockSize,
+                         static_cast<float>(block.y) * kBlockSize,
+                         (static_cast<float>(block.z) + 0.5f) * kBlockSize},
+            id);
+}
+
 void RefreshSelectionMesh() {
   if (!g_hover_valid) {
     UpdateSelectionMesh(g_renderer, nullptr);
@@ -121,6 +248,18 @@ int WINAPI wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE, _In_ PWSTR,
   InitPlayer(g_player, {8.0f, 4.0f, -14.0f});
   g_camera.position = GetPlayerEyePosition(g_player);
 
+  std::string host;
+  uint16_t port = kDefaultServerPort;
+  if (ParseConnectTarget(host, port)) {
+    if (!ConnectNetClient(g_net, host.c_str(), port)) {
+      DisconnectNetClient(g_net);
+      MessageBoxA(nullptr, "Failed to connect to server", "Error",
+                  MB_ICONERROR);
+      return 0;
+    }
+    g_networked = true;
+  }
+
   RECT client_rect{};
   GetClientRect(hwnd, &client_rect);
   const UINT width = static_cast<UINT>(client_rect.right - client_rect.left);
@@ -129,8 +268,22 @@ int WINAPI wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE, _In_ PWSTR,
     return 0;
   }
 
-  StreamChunks(g_world, g_camera.position);
-  UpdateChunkMeshes(g_renderer, g_world);
+  g_world.lighting = true;
+  if (!g_networked) {
+    StreamChunks(g_world, g_camera.position);
+  }
+  UpdateChunkMeshes(g_renderer, g_world, g_camera.position);
+
+  SetProfilerThreadName("main");
+  if (HasCommandLineFlag(L"--profile")) {
+    SetProfilerEnabled(true);
+  }
+  g_memory_report = HasCommandLineFlag(L"--memory-report");
+  InitJobSystem(g_jobs, -1);
+  if (!g_networked) {
+    SpawnInitialMobs();
+    g_world.record_changes = true;
+  }
 
   SetMouseCaptured(g_input, true);
 
@@ -145,26 +298,46 @@ int WINAPI wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE, _In_ PWSTR,
       TranslateMessage(&msg);
       DispatchMessage(&msg);
     } else {
+      const ScopedProfile frame_profile("Frame");
       LARGE_INTEGER now{};
       QueryPerformanceCounter(&now);
-      float dt = static_cast<float>(now.QuadPart - last_time.QuadPart) /
-                 static_cast<float>(frequency.QuadPart);
+      const float frame_seconds =
+          static_cast<float>(now.QuadPart - last_time.QuadPart) /
+          static_cast<float>(frequency.QuadPart);
       last_time = now;
+      float dt = frame_seconds;
       if (dt > 0.1f) {
         dt = 0.1f;
       }
 
+      ResetFrameArena(GetFrameArena());
+      MarkAllocFrame();
+      EndFrameStats(GetFrameStats(), frame_seconds * 1000.0f);
       UpdateFps(dt);
       UpdateInput(g_input);
+      UpdateProfilerTriggers(frame_seconds);
+      UpdateMemoryReport(frame_seconds);
       UpdateCameraLook(g_camera, g_input);
-      UpdatePlayer(g_player, g_world, g_camera, g_input, dt);
-      g_camera.position = GetPlayerEyePosition(g_player);
-      StreamChunks(g_world, g_camera.position);
-      UpdateChunkMeshes(g_renderer, g_world);
+      if (g_networked) {
+        SendNetClientInput(g_net, g_camera, g_input);
+        if (!PumpNetClient(g_net, g_world, g_player)) {
+          MessageBoxA(hwnd, "Disconnected from server", "Error", MB_ICONERROR);
+          DestroyWindow(hwnd);
+          continue;
+        }
+        g_camera.position = GetPlayerEyePosition(g_player);
+      } else {
+        UpdatePlayer(g_player, g_world, g_camera, g_input, dt);
+        g_camera.position = GetPlayerEyePosition(g_player);
+        StreamChunks(g_world, g_camera.position);
+      }
+      UpdateEntities(g_entities, g_world, g_jobs, dt, g_entity_stats);
+      CollectItems(g_entities, g_player.position, kItemPickupRadius);
+      UpdateChunkMeshes(g_renderer, g_world, g_camera.position);
       UpdateHoverHit();
 
       bool changed = false;
-      if (g_input.mouse_captured && g_hover_valid &&
+      if (!g_networked && g_input.mouse_captured && g_hover_valid &&
           (g_input.lmb_pressed || g_input.rmb_pressed)) {
         bool allow_place = g_input.rmb_pressed;
         if (allow_place) {
@@ -173,12 +346,24 @@ int WINAPI wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE, _In_ PWSTR,
             allow_place = false;
           }
         }
-        changed = HandleBlockInteraction(g_world, g_hover_hit,
-                                         g_input.lmb_pressed,
-                                         allow_place);
+        const BlockId target =
+            GetBlock(g_world, g_hover_hit.block.x, g_hover_hit.block.y,
+                     g_hover_hit.block.z);
+        changed = HandleBlockInteraction(
+            g_world, g_hover_hit, g_input.lmb_pressed, allow_place,
+            kHotbarBlocks[static_cast<size_t>(g_input.hotbar_slot)]);
+        if (changed && g_input.lmb_pressed) {
+          SpawnBlockDrop(g_hover_hit.block, target);
+        }
+      }
+      if (!g_networked) {
+        UpdateBlockTicks(g_block_ticks, g_world, g_jobs, dt,
+                         g_block_tick_stats);
+        UpdateFluids(g_fluids, g_world, g_jobs, dt, g_fluid_stats);
+        g_world.changes.clear();
       }
       if (changed) {
-        UpdateChunkMeshes(g_renderer, g_world);
+        UpdateChunkMeshes(g_renderer, g_world, g_camera.position);
         UpdateHoverHit();
       }
 
@@ -190,12 +375,20 @@ int WINAPI wWinMain(_In_ HINSTANCE instance, _In_opt_ HINSTANCE, _In_ PWSTR,
             GetBlock(g_world, g_hover_hit.block.x, g_hover_hit.block.y,
                      g_hover_hit.block.z));
       }
-      UpdateHudMesh(g_renderer, g_fps, g_camera.position, block_id);
+      UpdateEntityMesh(g_renderer, g_entities);
+      HudWorldStats hud_world_stats;
+      hud_world_stats.loaded_chunks = static_cast<int>(g_world.chunks.size());
+      hud_world_stats.dirty_chunks = CountDirtyChunks(g_world);
+      hud_world_stats.pending_jobs = GetPendingJobCount(g_jobs);
+      UpdateHudMesh(g_renderer, g_fps, g_camera.position, block_id,
+                    g_entity_stats, hud_world_stats);
       RenderFrame(g_renderer, g_world, g_camera);
     }
   }
 
   SetMouseCaptured(g_input, false);
+  ShutdownJobSystem(g_jobs);
+  DisconnectNetClient(g_net);
   ShutdownRenderer(g_renderer);
 
   return 0;
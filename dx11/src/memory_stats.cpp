@@ -0,0 +1,82 @@
+#include "memory_stats.h"
+
+#include <atomic>
+#include <cstdio>
+
+namespace {
+std::array<std::atomic<size_t>, kMemoryCategoryCount> g_bytes{};
+std::array<std::atomic<size_t>, kMemoryCategoryCount> g_peak_bytes{};
+std::array<std::atomic<uint64_t>, kMemoryCategoryCount> g_allocations{};
+std::array<std::atomic<uint64_t>, kMemoryCategoryCount> g_releases{};
+}  // namespace
+
+void TrackMemoryAlloc(MemoryCategory category, size_t bytes) {
+  const size_t index = static_cast<size_t>(category);
+  g_allocations[index].fetch_add(1, std::memory_order_relaxed);
+  const size_t live =
+      g_bytes[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  size_t peak = g_peak_bytes[index].load(std::memory_order_relaxed);
+  while (live > peak && !g_peak_bytes[index].compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+void TrackMemoryRelease(MemoryCategory category, size_t bytes) {
+  const size_t index = static_cast<size_t>(category);
+  g_releases[index].fetch_add(1, std::memory_order_relaxed);
+  g_bytes[index].fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void TrackMemoryResize(MemoryCategory category, size_t old_bytes,
+                       size_t new_bytes) {
+  if (old_bytes == new_bytes) {
+    return;
+  }
+  if (old_bytes > 0) {
+    TrackMemoryRelease(category, old_bytes);
+  }
+  if (new_bytes > 0) {
+    TrackMemoryAlloc(category, new_bytes);
+  }
+}
+
+MemoryStats GetMemoryStats() {
+  MemoryStats stats;
+  for (size_t i = 0; i < kMemoryCategoryCount; ++i) {
+    MemoryCounters& counters = stats.categories[i];
+    counters.bytes = g_bytes[i].load(std::memory_order_relaxed);
+    counters.peak_bytes = g_peak_bytes[i].load(std::memory_order_relaxed);
+    counters.allocations = g_allocations[i].load(std::memory_order_relaxed);
+    counters.releases = g_releases[i].load(std::memory_order_relaxed);
+    stats.total_bytes += counters.bytes;
+  }
+  return stats;
+}
+
+void WriteMemoryReport(FILE* file, double seconds) {
+  const MemoryStats stats = GetMemoryStats();
+  std::fprintf(file, "{\"time\":%.3f,\"total_bytes\":%zu", seconds,
+               stats.total_bytes);
+  for (size_t i = 0; i < kMemoryCategoryCount; ++i) {
+    const MemoryCounters& counters = stats.categories[i];
+    std::fprintf(file,
+                 ",\"%s\":{\"bytes\":%zu,\"peak_bytes\":%zu,"
+                 "\"allocations\":%llu,\"releases\":%llu}",
+                 GetMemoryCategoryName(static_cast<MemoryCategory>(i)),
+                 counters.bytes, counters.peak_bytes,
+                 static_cast<unsigned long long>(counters.allocations),
+                 static_cast<unsigned long long>(counters.releases));
+  }
+  std::fprintf(file, "}\n");
+}
+
+bool AppendMemoryReport(const char* path, double seconds) {
+  FILE* file = std::fopen(path, "a");
+  if (!file) {
+    std::fprintf(stderr, "Failed to open memory report %s\n", path);
+    return false;
+  }
+  WriteMemoryReport(file, seconds);
+  std::fclose(file);
+  return true;
+}
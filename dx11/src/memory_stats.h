@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+enum class MemoryCategory : uint8_t {
+  Voxels,
+  CpuMeshes,
+  GpuBuffers,
+  RenderState,
+  Caches,
+  Count,
+};
+
+constexpr size_t kMemoryCategoryCount =
+    static_cast<size_t>(MemoryCategory::Count);
+constexpr float kMemoryReportInterval = 5.0f;
+
+constexpr const char* GetMemoryCategoryName(MemoryCategory category) {
+  switch (category) {
+    case MemoryCategory::Voxels:
+      return "voxels";
+    case MemoryCategory::CpuMeshes:
+      return "cpu_meshes";
+    case MemoryCategory::GpuBuffers:
+      return "gpu_buffers";
+    case MemoryCategory::RenderState:
+      return "render_state";
+    case MemoryCategory::Caches:
+      return "caches";
+    case MemoryCategory::Count:
+      break;
+  }
+  return "unknown";
+}
+
+struct MemoryCounters {
+  size_t bytes = 0;
+  size_t peak_bytes = 0;
+  uint64_t allocations = 0;
+  uint64_t releases = 0;
+};
+
+struct MemoryStats {
+  std::array<MemoryCounters, kMemoryCategoryCount> categories{};
+  size_t total_bytes = 0;
+};
+
+void TrackMemoryAlloc(MemoryCategory category, size_t bytes);
+void TrackMemoryRelease(MemoryCategory category, size_t bytes);
+void TrackMemoryResize(MemoryCategory category, size_t old_bytes,
+                       size_t new_bytes);
+MemoryStats GetMemoryStats();
+void WriteMemoryReport(FILE* file, double seconds);
+bool AppendMemoryReport(const char* path, double seconds);
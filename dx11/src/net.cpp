@@ -0,0 +1,261 @@
+#include "net.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+bool SetNonBlocking(SOCKET socket) {
+  u_long mode = 1;
+  return ioctlsocket(socket, FIONBIO, &mode) == 0;
+}
+
+void SetNoDelay(SOCKET socket) {
+  const BOOL enable = TRUE;
+  setsockopt(socket, IPPROTO_TCP, TCP_NODELAY,
+             reinterpret_cast<const char*>(&enable), sizeof(enable));
+}
+
+void ResetConnection(NetConnection& connection, SOCKET socket) {
+  connection.socket = socket;
+  connection.send_buffer.clear();
+  connection.send_offset = 0;
+  connection.recv_buffer.clear();
+  connection.recv_offset = 0;
+  connection.bytes_sent = 0;
+  connection.bytes_received = 0;
+  connection.open = true;
+}
+}  // namespace
+
+bool InitNetwork() {
+  WSADATA data{};
+  const int result = WSAStartup(MAKEWORD(2, 2), &data);
+  if (result != 0) {
+    std::fprintf(stderr, "WSAStartup failed (%d)\n", result);
+    return false;
+  }
+  return true;
+}
+
+void ShutdownNetwork() { WSACleanup(); }
+
+bool ListenOnPort(NetListener& listener, uint16_t port) {
+  listener.socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (listener.socket == INVALID_SOCKET) {
+    std::fprintf(stderr, "Failed to create listen socket (%d)\n",
+                 WSAGetLastError());
+    return false;
+  }
+  const BOOL reuse = TRUE;
+  setsockopt(listener.socket, SOL_SOCKET, SO_REUSEADDR,
+             reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(port);
+  if (bind(listener.socket, reinterpret_cast<const sockaddr*>(&address),
+           sizeof(address)) == SOCKET_ERROR ||
+      listen(listener.socket, SOMAXCONN) == SOCKET_ERROR ||
+      !SetNonBlocking(listener.socket)) {
+    std::fprintf(stderr, "Failed to listen on port %u (%d)\n",
+                 static_cast<unsigned int>(port), WSAGetLastError());
+    CloseListener(listener);
+    return false;
+  }
+  return true;
+}
+
+void CloseListener(NetListener& listener) {
+  if (listener.socket != INVALID_SOCKET) {
+    closesocket(listener.socket);
+    listener.socket = INVALID_SOCKET;
+  }
+}
+
+bool AcceptConnection(NetListener& listener, NetConnection& connection) {
+  if (listener.socket == INVALID_SOCKET) {
+    return false;
+  }
+  const SOCKET socket = accept(listener.socket, nullptr, nullptr);
+  if (socket == INVALID_SOCKET) {
+    return false;
+  }
+  if (!SetNonBlocking(socket)) {
+    closesocket(socket);
+    return false;
+  }
+  SetNoDelay(socket);
+  ResetConnection(connection, socket);
+  return true;
+}
+
+bool ConnectToHost(NetConnection& connection, const char* host,
+                   uint16_t port) {
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_protocol = IPPROTO_TCP;
+  char port_text[8];
+  std::snprintf(port_text, sizeof(port_text), "%u",
+                static_cast<unsigned int>(port));
+  addrinfo* result = nullptr;
+  if (getaddrinfo(host, port_text, &hints, &result) != 0 || !result) {
+    return false;
+  }
+
+  SOCKET socket = INVALID_SOCKET;
+  for (addrinfo* entry = result; entry; entry = entry->ai_next) {
+    socket = ::socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+    if (socket == INVALID_SOCKET) {
+      continue;
+    }
+    if (connect(socket, entry->ai_addr, static_cast<int>(entry->ai_addrlen)) ==
+        0) {
+      break;
+    }
+    closesocket(socket);
+    socket = INVALID_SOCKET;
+  }
+  freeaddrinfo(result);
+  if (socket == INVALID_SOCKET || !SetNonBlocking(socket)) {
+    if (socket != INVALID_SOCKET) {
+      closesocket(socket);
+    }
+    return false;
+  }
+  SetNoDelay(socket);
+  ResetConnection(connection, socket);
+  return true;
+}
+
+void CloseConnection(NetConnection& connection) {
+  if (connection.socket != INVALID_SOCKET) {
+    closesocket(connection.socket);
+    connection.socket = INVALID_SOCKET;
+  }
+  connection.open = false;
+}
+
+void QueueMessage(NetConnection& connection, uint8_t type, const uint8_t* data,
+                  size_t size) {
+  if (connection.send_offset > 0 &&
+      connection.send_offset == connection.send_buffer.size()) {
+    connection.send_buffer.clear();
+    connection.send_offset = 0;
+  }
+  const uint32_t length = static_cast<uint32_t>(size);
+  const uint8_t header[kNetMessageHeaderSize] = {
+      static_cast<uint8_t>(length),
+      static_cast<uint8_t>(length >> 8),
+      static_cast<uint8_t>(length >> 16),
+      static_cast<uint8_t>(length >> 24),
+      type,
+  };
+  connection.send_buffer.insert(connection.send_buffer.end(), header,
+                                header + kNetMessageHeaderSize);
+  if (size > 0) {
+    connection.send_buffer.insert(connection.send_buffer.end(), data,
+                                  data + size);
+  }
+}
+
+size_t GetQueuedBytes(const NetConnection& connection) {
+  return connection.send_buffer.size() - connection.send_offset;
+}
+
+bool FlushConnection(NetConnection& connection) {
+  if (!connection.open) {
+    return false;
+  }
+  while (connection.send_offset < connection.send_buffer.size()) {
+    const size_t remaining =
+        connection.send_buffer.size() - connection.send_offset;
+    const int sent = send(
+        connection.socket,
+        reinterpret_cast<const char*>(connection.send_buffer.data() +
+                                      connection.send_offset),
+        static_cast<int>(remaining), 0);
+    if (sent == SOCKET_ERROR) {
+      if (WSAGetLastError() == WSAEWOULDBLOCK) {
+        break;
+      }
+      CloseConnection(connection);
+      return false;
+    }
+    connection.send_offset += static_cast<size_t>(sent);
+    connection.bytes_sent += static_cast<uint64_t>(sent);
+  }
+  if (connection.send_offset == connection.send_buffer.size()) {
+    connection.send_buffer.clear();
+    connection.send_offset = 0;
+  }
+  return true;
+}
+
+void DiscardQueuedBytes(NetConnection& connection) {
+  connection.bytes_sent += GetQueuedBytes(connection);
+  connection.send_buffer.clear();
+  connection.send_offset = 0;
+}
+
+bool ReceiveFromConnection(NetConnection& connection) {
+  if (!connection.open) {
+    return false;
+  }
+  if (connection.recv_offset > 0) {
+    connection.recv_buffer.erase(
+        connection.recv_buffer.begin(),
+        connection.recv_buffer.begin() +
+            static_cast<std::ptrdiff_t>(connection.recv_offset));
+    connection.recv_offset = 0;
+  }
+  for (;;) {
+    const size_t offset = connection.recv_buffer.size();
+    connection.recv_buffer.resize(offset + kNetReceiveChunk);
+    const int received =
+        recv(connection.socket,
+             reinterpret_cast<char*>(connection.recv_buffer.data() + offset),
+             static_cast<int>(kNetReceiveChunk), 0);
+    if (received == SOCKET_ERROR) {
+      connection.recv_buffer.resize(offset);
+      if (WSAGetLastError() == WSAEWOULDBLOCK) {
+        return true;
+      }
+      CloseConnection(connection);
+      return false;
+    }
+    if (received == 0) {
+      connection.recv_buffer.resize(offset);
+      CloseConnection(connection);
+      return false;
+    }
+    connection.recv_buffer.resize(offset + static_cast<size_t>(received));
+    connection.bytes_received += static_cast<uint64_t>(received);
+  }
+}
+
+bool NextMessage(NetConnection& connection, NetMessageView& message) {
+  const size_t available =
+      connection.recv_buffer.size() - connection.recv_offset;
+  if (available < kNetMessageHeaderSize) {
+    return false;
+  }
+  const uint8_t* header = connection.recv_buffer.data() + connection.recv_offset;
+  const uint32_t length = static_cast<uint32_t>(header[0]) |
+                          (static_cast<uint32_t>(header[1]) << 8) |
+                          (static_cast<uint32_t>(header[2]) << 16) |
+                          (static_cast<uint32_t>(header[3]) << 24);
+  if (length > kNetMaxMessageSize) {
+    CloseConnection(connection);
+    return false;
+  }
+  if (available < kNetMessageHeaderSize + length) {
+    return false;
+  }
+  message.type = header[4];
+  message.data = header + kNetMessageHeaderSize;
+  message.size = length;
+  connection.recv_offset += kNetMessageHeaderSize + length;
+  return true;
+}
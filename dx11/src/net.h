@@ -0,0 +1,48 @@
+#pragma once
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr size_t kNetMessageHeaderSize = 5;
+constexpr uint32_t kNetMaxMessageSize = 1u << 20;
+constexpr size_t kNetReceiveChunk = 64 * 1024;
+
+struct NetListener {
+  SOCKET socket = INVALID_SOCKET;
+};
+
+struct NetConnection {
+  SOCKET socket = INVALID_SOCKET;
+  std::vector<uint8_t> send_buffer;
+  size_t send_offset = 0;
+  std::vector<uint8_t> recv_buffer;
+  size_t recv_offset = 0;
+  uint64_t bytes_sent = 0;
+  uint64_t bytes_received = 0;
+  bool open = false;
+};
+
+struct NetMessageView {
+  uint8_t type = 0;
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+};
+
+bool InitNetwork();
+void ShutdownNetwork();
+bool ListenOnPort(NetListener& listener, uint16_t port);
+void CloseListener(NetListener& listener);
+bool AcceptConnection(NetListener& listener, NetConnection& connection);
+bool ConnectToHost(NetConnection& connection, const char* host, uint16_t port);
+void CloseConnection(NetConnection& connection);
+void QueueMessage(NetConnection& connection, uint8_t type, const uint8_t* data,
+                  size_t size);
+size_t GetQueuedBytes(const NetConnection& connection);
+bool FlushConnection(NetConnection& connection);
+void DiscardQueuedBytes(NetConnection& connection);
+bool ReceiveFromConnection(NetConnection& connection);
+bool NextMessage(NetConnection& connection, NetMessageView& message);
@@ -0,0 +1,155 @@
+#include "net_client.h"
+
+#include "light.h"
+#include "profiler.h"
+
+namespace {
+void QueueClientMessage(NetClientState& client, MessageType type) {
+  QueueMessage(client.connection, static_cast<uint8_t>(type),
+               client.scratch.data(), client.scratch.size());
+}
+
+void ApplyChunkData(World& world, ByteReader& reader) {
+  const size_t start = reader.offset;
+  const Int3 coord = ReadInt3(reader);
+  if (!reader.ok) {
+    return;
+  }
+  reader.offset = start;
+  Chunk& chunk = AcquireChunk(world, coord);
+  Int3 decoded{};
+  if (!ReadChunkData(reader, decoded, chunk.sequence, chunk.voxels)) {
+    RemoveChunk(world, coord);
+    return;
+  }
+  chunk.random_tick_blocks = CountRandomTickBlocks(chunk.voxels);
+  if (chunk.random_tick_blocks > 0) {
+    AddTickChunk(world, chunk);
+  }
+  chunk.dirty = true;
+  MarkNeighborChunksDirty(chunk);
+  if (world.lighting) {
+    InitChunkLight(world, chunk);
+  }
+}
+
+void ApplyChunkDelta(World& world, ByteReader& reader) {
+  ChunkDeltaMessage delta;
+  if (!ReadChunkDelta(reader, delta)) {
+    return;
+  }
+  Chunk* chunk = FindChunk(world, delta.coord);
+  if (!chunk || delta.sequence <= chunk->sequence) {
+    return;
+  }
+  chunk->sequence = delta.sequence;
+  const Int3 base{delta.coord.x * kChunkSize, delta.coord.y * kChunkSize,
+                  delta.coord.z * kChunkSize};
+  for (uint16_t i = 0; i < delta.count; ++i) {
+    Int3 local{};
+    BlockId id = BlockId::Air;
+    if (!ReadChunkDeltaEntry(reader, local, id)) {
+      return;
+    }
+    SetBlock(world, base.x + local.x, base.y + local.y, base.z + local.z, id);
+  }
+}
+}  // namespace
+
+bool ConnectNetClient(NetClientState& client, const char* host,
+                      uint16_t port) {
+  if (!InitNetwork()) {
+    return false;
+  }
+  client.network_ready = true;
+  if (!ConnectToHost(client.connection, host, port)) {
+    return false;
+  }
+  client.scratch.clear();
+  WriteClientHello(client.scratch, {});
+  QueueClientMessage(client, MessageType::ClientHello);
+  return FlushConnection(client.connection);
+}
+
+void DisconnectNetClient(NetClientState& client) {
+  if (!client.network_ready) {
+    return;
+  }
+  CloseConnection(client.connection);
+  ShutdownNetwork();
+  client.network_ready = false;
+}
+
+void SendNetClientInput(NetClientState& client, const CameraState& camera,
+                        const InputState& input) {
+  if (!client.connection.open) {
+    return;
+  }
+  ClientInputMessage message;
+  message.sequence = ++client.input_sequence;
+  message.yaw = camera.yaw;
+  message.pitch = camera.pitch;
+  message.hotbar_slot = static_cast<uint8_t>(input.hotbar_slot);
+  if (input.mouse_captured) {
+    message.move_forward = static_cast<int8_t>(input.move_forward);
+    message.move_right = static_cast<int8_t>(input.move_right);
+    message.buttons = static_cast<uint8_t>(
+        (input.jump_down ? kButtonJump : 0) |
+        (input.crouch_down ? kButtonCrouch : 0) |
+        (input.speed_boost ? kButtonSprint : 0) |
+        (input.lmb_pressed ? kButtonBreak : 0) |
+        (input.rmb_pressed ? kButtonPlace : 0));
+  }
+  client.scratch.clear();
+  WriteClientInput(client.scratch, message);
+  QueueClientMessage(client, MessageType::ClientInput);
+  FlushConnection(client.connection);
+}
+
+bool PumpNetClient(NetClientState& client, World& world, PlayerState& player) {
+  const ScopedProfile profile("PumpNetClient");
+  if (!ReceiveFromConnection(client.connection)) {
+    return false;
+  }
+  NetMessageView message;
+  while (NextMessage(client.connection, message)) {
+    ByteReader reader{message.data, message.size};
+    switch (static_cast<MessageType>(message.type)) {
+      case MessageType::ServerWelcome: {
+        ServerWelcomeMessage welcome;
+        if (ReadServerWelcome(reader, welcome)) {
+          client.client_id = welcome.client_id;
+          client.welcomed = true;
+        }
+        break;
+      }
+      case MessageType::ServerPlayerState: {
+        PlayerStateMessage state;
+        if (ReadPlayerState(reader, state) && client.welcomed &&
+            state.client_id == client.client_id) {
+          player.position = state.position;
+          player.velocity = state.velocity;
+          player.on_ground = state.on_ground;
+          player.crouching = state.crouching;
+        }
+        break;
+      }
+      case MessageType::ServerChunkData:
+        ApplyChunkData(world, reader);
+        break;
+      case MessageType::ServerChunkUnload: {
+        Int3 coord{};
+        if (ReadChunkUnload(reader, coord)) {
+          RemoveChunk(world, coord);
+        }
+        break;
+      }
+      case MessageType::ServerChunkDelta:
+        ApplyChunkDelta(world, reader);
+        break;
+      default:
+        break;
+    }
+  }
+  return client.connection.open;
+}
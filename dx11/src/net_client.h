@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "camera.h"
+#include "input.h"
+#include "net.h"
+#include "player.h"
+#include "protocol.h"
+#include "world.h"
+
+struct NetClientState {
+  NetConnection connection;
+  uint32_t client_id = 0;
+  uint32_t input_sequence = 0;
+  bool welcomed = false;
+  bool network_ready = false;
+  std::vector<uint8_t> scratch;
+};
+
+bool ConnectNetClient(NetClientState& client, const char* host, uint16_t port);
+void DisconnectNetClient(NetClientState& client);
+void SendNetClientInput(NetClientState& client, const CameraState& camera,
+                        const InputState& input);
+bool PumpNetClient(NetClientState& client, World& world, PlayerState& player);
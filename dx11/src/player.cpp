@@ -1,66 +1,16 @@
 #include "player.h"
 
-#include <algorithm>
 #include <cmath>
 
-namespace {
-constexpr float kCollisionEpsilon = 0.001f;
-
-struct Aabb {
-  float min_x;
-  float min_y;
-  float min_z;
-  float max_x;
-  float max_y;
-  float max_z;
-};
-
-int MinCell(float value) {
-  return static_cast<int>(std::floor(value + kCollisionEpsilon));
-}
-
-int MaxCell(float value) {
-  return static_cast<int>(std::floor(value - kCollisionEpsilon));
-}
+#include "frame_stats.h"
 
+namespace {
 float GetPlayerHeight(const PlayerState& player) {
   return player.crouching ? kPlayerCrouchHeight : kPlayerHeight;
 }
 
 Aabb MakeAabb(const PlayerState& player) {
-  const float height = GetPlayerHeight(player);
-  return {player.position.x - kPlayerRadius,
-          player.position.y,
-          player.position.z - kPlayerRadius,
-          player.position.x + kPlayerRadius,
-          player.position.y + height,
-          player.position.z + kPlayerRadius};
-}
-
-bool IsSolid(const World& world, int x, int y, int z) {
-  return GetBlock(world, x, y, z) != BlockId::Air;
-}
-
-bool IsAabbClear(const World& world, const Aabb& box) {
-  const int min_x = MinCell(box.min_x);
-  const int max_x = MaxCell(box.max_x);
-  const int min_y = MinCell(box.min_y);
-  const int max_y = MaxCell(box.max_y);
-  const int min_z = MinCell(box.min_z);
-  const int max_z = MaxCell(box.max_z);
-  if (max_x < min_x || max_y < min_y || max_z < min_z) {
-    return true;
-  }
-  for (int x = min_x; x <= max_x; ++x) {
-    for (int y = min_y; y <= max_y; ++y) {
-      for (int z = min_z; z <= max_z; ++z) {
-        if (IsSolid(world, x, y, z)) {
-          return false;
-        }
-      }
-    }
-  }
-  return true;
+  return MakeBodyAabb(player.position, kPlayerRadius, GetPlayerHeight(player));
 }
 
 bool CanStandUp(const PlayerState& player, const World& world) {
@@ -69,219 +19,6 @@ bool CanStandUp(const PlayerState& player, const World& world) {
   const Aabb box = MakeAabb(standing);
   return IsAabbClear(world, box);
 }
-
-bool MoveAlongX(PlayerState& player, const World& world, float delta) {
-  if (delta == 0.0f) {
-    return false;
-  }
-  Aabb box = MakeAabb(player);
-  const int min_y = MinCell(box.min_y);
-  const int max_y = MaxCell(box.max_y);
-  const int min_z = MinCell(box.min_z);
-  const int max_z = MaxCell(box.max_z);
-  if (max_y < min_y || max_z < min_z) {
-    player.position.x += delta;
-    return false;
-  }
-
-  bool hit = false;
-  float move = delta;
-  if (delta > 0.0f) {
-    const int start_x = static_cast<int>(std::floor(box.max_x + kCollisionEpsilon));
-    const int end_x =
-        static_cast<int>(std::floor(box.max_x + delta));
-    for (int x = start_x; x <= end_x; ++x) {
-      bool blocked = false;
-      for (int y = min_y; y <= max_y && !blocked; ++y) {
-        for (int z = min_z; z <= max_z; ++z) {
-          if (IsSolid(world, x, y, z)) {
-            blocked = true;
-            break;
-          }
-        }
-      }
-      if (blocked) {
-        float allowed = static_cast<float>(x) - box.max_x - kCollisionEpsilon;
-        allowed = std::max(0.0f, allowed);
-        if (allowed < move) {
-          move = allowed;
-        }
-        hit = true;
-        break;
-      }
-    }
-  } else {
-    const int start_x =
-        static_cast<int>(std::floor(box.min_x - kCollisionEpsilon));
-    const int end_x =
-        static_cast<int>(std::floor(box.min_x + delta));
-    for (int x = start_x; x >= end_x; --x) {
-      bool blocked = false;
-      for (int y = min_y; y <= max_y && !blocked; ++y) {
-        for (int z = min_z; z <= max_z; ++z) {
-          if (IsSolid(world, x, y, z)) {
-            blocked = true;
-            break;
-          }
-        }
-      }
-      if (blocked) {
-        float allowed =
-            static_cast<float>(x + 1) + kCollisionEpsilon - box.min_x;
-        allowed = std::min(0.0f, allowed);
-        if (allowed > move) {
-          move = allowed;
-        }
-        hit = true;
-        break;
-      }
-    }
-  }
-  player.position.x += move;
-  return hit;
-}
-
-bool MoveAlongZ(PlayerState& player, const World& world, float delta) {
-  if (delta == 0.0f) {
-    return false;
-  }
-  Aabb box = MakeAabb(player);
-  const int min_y = MinCell(box.min_y);
-  const int max_y = MaxCell(box.max_y);
-  const int min_x = MinCell(box.min_x);
-  const int max_x = MaxCell(box.max_x);
-  if (max_y < min_y || max_x < min_x) {
-    player.position.z += delta;
-    return false;
-  }
-
-  bool hit = false;
-  float move = delta;
-  if (delta > 0.0f) {
-    const int start_z = static_cast<int>(std::floor(box.max_z + kCollisionEpsilon));
-    const int end_z =
-        static_cast<int>(std::floor(box.max_z + delta));
-    for (int z = start_z; z <= end_z; ++z) {
-      bool blocked = false;
-      for (int y = min_y; y <= max_y && !blocked; ++y) {
-        for (int x = min_x; x <= max_x; ++x) {
-          if (IsSolid(world, x, y, z)) {
-            blocked = true;
-            break;
-          }
-        }
-      }
-      if (blocked) {
-        float allowed = static_cast<float>(z) - box.max_z - kCollisionEpsilon;
-        allowed = std::max(0.0f, allowed);
-        if (allowed < move) {
-          move = allowed;
-        }
-        hit = true;
-        break;
-      }
-    }
-  } else {
-    const int start_z =
-        static_cast<int>(std::floor(box.min_z - kCollisionEpsilon));
-    const int end_z =
-        static_cast<int>(std::floor(box.min_z + delta));
-    for (int z = start_z; z >= end_z; --z) {
-      bool blocked = false;
-      for (int y = min_y; y <= max_y && !blocked; ++y) {
-        for (int x = min_x; x <= max_x; ++x) {
-          if (IsSolid(world, x, y, z)) {
-            blocked = true;
-            break;
-          }
-        }
-      }
-      if (blocked) {
-        float allowed =
-            static_cast<float>(z + 1) + kCollisionEpsilon - box.min_z;
-        allowed = std::min(0.0f, allowed);
-        if (allowed > move) {
-          move = allowed;
-        }
-        hit = true;
-        break;
-      }
-    }
-  }
-  player.position.z += move;
-  return hit;
-}
-
-bool MoveAlongY(PlayerState& player, const World& world, float delta) {
-  if (delta == 0.0f) {
-    return false;
-  }
-  Aabb box = MakeAabb(player);
-  const int min_x = MinCell(box.min_x);
-  const int max_x = MaxCell(box.max_x);
-  const int min_z = MinCell(box.min_z);
-  const int max_z = MaxCell(box.max_z);
-  if (max_x < min_x || max_z < min_z) {
-    player.position.y += delta;
-    return false;
-  }
-
-  bool hit = false;
-  float move = delta;
-  if (delta > 0.0f) {
-    const int start_y = static_cast<int>(std::floor(box.max_y + kCollisionEpsilon));
-    const int end_y =
-        static_cast<int>(std::floor(box.max_y + delta));
-    for (int y = start_y; y <= end_y; ++y) {
-      bool blocked = false;
-      for (int x = min_x; x <= max_x && !blocked; ++x) {
-        for (int z = min_z; z <= max_z; ++z) {
-          if (IsSolid(world, x, y, z)) {
-            blocked = true;
-            break;
-          }
-        }
-      }
-      if (blocked) {
-        float allowed = static_cast<float>(y) - box.max_y - kCollisionEpsilon;
-        allowed = std::max(0.0f, allowed);
-        if (allowed < move) {
-          move = allowed;
-        }
-        hit = true;
-        break;
-      }
-    }
-  } else {
-    const int start_y =
-        static_cast<int>(std::floor(box.min_y - kCollisionEpsilon));
-    const int end_y =
-        static_cast<int>(std::floor(box.min_y + delta));
-    for (int y = start_y; y >= end_y; --y) {
-      bool blocked = false;
-      for (int x = min_x; x <= max_x && !blocked; ++x) {
-        for (int z = min_z; z <= max_z; ++z) {
-          if (IsSolid(world, x, y, z)) {
-            blocked = true;
-            break;
-          }
-        }
-      }
-      if (blocked) {
-        float allowed =
-            static_cast<float>(y + 1) + kCollisionEpsilon - box.min_y;
-        allowed = std::min(0.0f, allowed);
-        if (allowed > move) {
-          move = allowed;
-        }
-        hit = true;
-        break;
-      }
-    }
-  }
-  player.position.y += move;
-  return hit;
-}
 }  // namespace
 
 void InitPlayer(PlayerState& player, const DirectX::XMFLOAT3& position) {
@@ -293,6 +30,7 @@ void InitPlayer(PlayerState& player, const DirectX::XMFLOAT3& position) {
 
 void UpdatePlayer(PlayerState& player, const World& world,
                   const CameraState& camera, const InputState& input, float dt) {
+  const ScopedFramePhase frame_phase(FramePhase::UpdatePlayer);
   const bool input_active = input.mouse_captured;
   const int move_forward = input_active ? input.move_forward : 0;
   const int move_right = input_active ? input.move_right : 0;
@@ -348,48 +86,22 @@ void UpdatePlayer(PlayerState& player, const World& world,
     player.on_ground = false;
   }
 
-  player.velocity.y += kPlayerGravity * dt;
-
-  const float dx = player.velocity.x * dt;
-  const float dz = player.velocity.z * dt;
-  const float dy = player.velocity.y * dt;
-
-  PlayerState pre_step = player;
-  bool hit_x = MoveAlongX(player, world, dx);
-  bool hit_z = MoveAlongZ(player, world, dz);
-
-  bool stepped = false;
-  if (player.on_ground && (hit_x || hit_z)) {
-    PlayerState step = pre_step;
-    if (!MoveAlongY(step, world, kPlayerStepHeight)) {
-      const bool step_hit_x = MoveAlongX(step, world, dx);
-      const bool step_hit_z = MoveAlongZ(step, world, dz);
-      if (!step_hit_x && !step_hit_z) {
-        MoveAlongY(step, world, -(kPlayerStepHeight + kCollisionEpsilon));
-        player = step;
-        stepped = true;
-      }
-    }
-  }
-
-  if (!stepped) {
-    if (hit_x) {
-      player.velocity.x = 0.0f;
-    }
-    if (hit_z) {
-      player.velocity.z = 0.0f;
-    }
-  }
+  BodyState body = MakePlayerBody(player);
+  IntegrateBody(body, world, kPlayerGravity, dt);
+  player.position = body.position;
+  player.velocity = body.velocity;
+  player.on_ground = body.on_ground;
+}
 
-  bool hit_y = MoveAlongY(player, world, dy);
-  if (hit_y) {
-    if (dy < 0.0f) {
-      player.on_ground = true;
-    }
-    player.velocity.y = 0.0f;
-  } else {
-    player.on_ground = false;
-  }
+BodyState MakePlayerBody(const PlayerState& player) {
+  BodyState body;
+  body.position = player.position;
+  body.velocity = player.velocity;
+  body.radius = kPlayerRadius;
+  body.height = GetPlayerHeight(player);
+  body.step_height = kPlayerStepHeight;
+  body.on_ground = player.on_ground;
+  return body;
 }
 
 DirectX::XMFLOAT3 GetPlayerEyePosition(const PlayerState& player) {
@@ -3,6 +3,7 @@
 #include <DirectXMath.h>
 
 #include "camera.h"
+#include "collision.h"
 #include "input.h"
 #include "world.h"
 
@@ -25,5 +26,6 @@ struct PlayerState {
 void InitPlayer(PlayerState& player, const DirectX::XMFLOAT3& position);
 void UpdatePlayer(PlayerState& player, const World& world,
                   const CameraState& camera, const InputState& input, float dt);
+BodyState MakePlayerBody(const PlayerState& player);
 DirectX::XMFLOAT3 GetPlayerEyePosition(const PlayerState& player);
 bool WouldIntersectBlock(const PlayerState& player, int x, int y, int z);
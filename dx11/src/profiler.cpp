@@ -0,0 +1,134 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> g_profiler_enabled{false};
+
+namespace {
+struct ProfileRing {
+  std::array<ProfileEvent, kProfileRingEvents> events;
+  std::atomic<uint64_t> written{0};
+  uint32_t thread_id = 0;
+  char thread_name[32]{};
+};
+
+struct ProfilerRegistry {
+  std::mutex mutex;
+  std::vector<ProfileRing*> rings;
+};
+
+thread_local ProfileRing* t_ring = nullptr;
+thread_local char t_thread_name[32]{};
+
+ProfilerRegistry& GetProfilerRegistry() {
+  static ProfilerRegistry* registry = new ProfilerRegistry();
+  return *registry;
+}
+
+ProfileRing& GetThreadRing() {
+  if (!t_ring) {
+    ProfileRing* ring = new ProfileRing();
+    ProfilerRegistry& registry = GetProfilerRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    ring->thread_id = static_cast<uint32_t>(registry.rings.size());
+    if (t_thread_name[0] != '\0') {
+      std::snprintf(ring->thread_name, sizeof(ring->thread_name), "%s",
+                    t_thread_name);
+    } else {
+      std::snprintf(ring->thread_name, sizeof(ring->thread_name), "thread %u",
+                    ring->thread_id);
+    }
+    registry.rings.push_back(ring);
+    t_ring = ring;
+  }
+  return *t_ring;
+}
+
+void CopyRingEvents(const ProfileRing& ring,
+                    std::vector<ProfileEvent>& events) {
+  const uint64_t end = ring.written.load(std::memory_order_acquire);
+  const uint64_t begin = end > kProfileRingEvents ? end - kProfileRingEvents : 0;
+  events.clear();
+  for (uint64_t i = begin; i < end; ++i) {
+    events.push_back(ring.events[i % kProfileRingEvents]);
+  }
+  const uint64_t now = ring.written.load(std::memory_order_acquire);
+  const uint64_t overwritten =
+      now + 1 > kProfileRingEvents ? now + 1 - kProfileRingEvents : 0;
+  if (overwritten > begin) {
+    const size_t lost = static_cast<size_t>(
+        std::min<uint64_t>(overwritten - begin, events.size()));
+    events.erase(events.begin(), events.begin() + lost);
+  }
+}
+}  // namespace
+
+void SetProfilerEnabled(bool enabled) {
+  g_profiler_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void SetProfilerThreadName(const char* name) {
+  std::snprintf(t_thread_name, sizeof(t_thread_name), "%s", name);
+  if (t_ring) {
+    std::lock_guard<std::mutex> lock(GetProfilerRegistry().mutex);
+    std::snprintf(t_ring->thread_name, sizeof(t_ring->thread_name), "%s",
+                  name);
+  }
+}
+
+int64_t GetProfileTimeNs() {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void RecordProfileEvent(const char* name, int64_t begin_ns, int64_t end_ns) {
+  ProfileRing& ring = GetThreadRing();
+  const uint64_t index = ring.written.load(std::memory_order_relaxed);
+  ring.events[index % kProfileRingEvents] = {name, begin_ns, end_ns};
+  ring.written.store(index + 1, std::memory_order_release);
+}
+
+bool WriteChromeTrace(const char* path) {
+  FILE* file = std::fopen(path, "wb");
+  if (!file) {
+    std::fprintf(stderr, "Failed to open trace file %s\n", path);
+    return false;
+  }
+  std::fprintf(file, "{\"traceEvents\":[\n");
+  bool first = true;
+  std::vector<ProfileEvent> events;
+  events.reserve(kProfileRingEvents);
+  ProfilerRegistry& registry = GetProfilerRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const ProfileRing* ring : registry.rings) {
+    std::fprintf(file,
+                 "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                 first ? "" : ",\n", ring->thread_id, ring->thread_name);
+    first = false;
+    CopyRingEvents(*ring, events);
+    for (const ProfileEvent& event : events) {
+      std::fprintf(file,
+                   ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+                   "\"ts\":%.3f,\"dur\":%.3f}",
+                   event.name, ring->thread_id,
+                   static_cast<double>(event.begin_ns) / 1000.0,
+                   static_cast<double>(event.end_ns - event.begin_ns) /
+                       1000.0);
+    }
+  }
+  std::fprintf(file, "\n]}\n");
+  const bool ok = std::ferror(file) == 0;
+  std::fclose(file);
+  if (!ok) {
+    std::fprintf(stderr, "Failed to write trace file %s\n", path);
+  }
+  return ok;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef MINECRAFT_PROFILER
+#define MINECRAFT_PROFILER 1
+#endif
+
+constexpr size_t kProfileRingEvents = 16384;
+constexpr float kProfileSpikeMs = 50.0f;
+constexpr float kProfileSpikeCooldown = 5.0f;
+
+struct ProfileEvent {
+  const char* name = nullptr;
+  int64_t begin_ns = 0;
+  int64_t end_ns = 0;
+};
+
+extern std::atomic<bool> g_profiler_enabled;
+
+inline bool IsProfilerEnabled() {
+#if MINECRAFT_PROFILER
+  return g_profiler_enabled.load(std::memory_order_relaxed);
+#else
+  return false;
+#endif
+}
+
+void SetProfilerEnabled(bool enabled);
+void SetProfilerThreadName(const char* name);
+int64_t GetProfileTimeNs();
+void RecordProfileEvent(const char* name, int64_t begin_ns, int64_t end_ns);
+bool WriteChromeTrace(const char* path);
+
+struct ScopedProfile {
+#if MINECRAFT_PROFILER
+  explicit ScopedProfile(const char* name)
+      : name(IsProfilerEnabled() ? name : nullptr),
+        begin_ns(this->name ? GetProfileTimeNs() : 0) {}
+  ~ScopedProfile() {
+    if (name) {
+      RecordProfileEvent(name, begin_ns, GetProfileTimeNs());
+    }
+  }
+
+  const char* name;
+  int64_t begin_ns;
+#else
+  explicit ScopedProfile(const char*) {}
+#endif
+
+  ScopedProfile(const ScopedProfile&) = delete;
+  ScopedProfile& operator=(const ScopedProfile&) = delete;
+};
@@ -0,0 +1,249 @@
+#include "protocol.h"
+
+#include <cstring>
+
+#include "chunk_codec.h"
+
+namespace {
+bool CanRead(ByteReader& reader, size_t bytes) {
+  if (!reader.ok || reader.size - reader.offset < bytes) {
+    reader.ok = false;
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+void WriteU8(std::vector<uint8_t>& out, uint8_t value) { out.push_back(value); }
+
+void WriteU16(std::vector<uint8_t>& out, uint16_t value) {
+  out.push_back(static_cast<uint8_t>(value));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void WriteU32(std::vector<uint8_t>& out, uint32_t value) {
+  out.push_back(static_cast<uint8_t>(value));
+  out.push_back(static_cast<uint8_t>(value >> 8));
+  out.push_back(static_cast<uint8_t>(value >> 16));
+  out.push_back(static_cast<uint8_t>(value >> 24));
+}
+
+void WriteI32(std::vector<uint8_t>& out, int32_t value) {
+  WriteU32(out, static_cast<uint32_t>(value));
+}
+
+void WriteF32(std::vector<uint8_t>& out, float value) {
+  uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  WriteU32(out, bits);
+}
+
+void WriteInt3(std::vector<uint8_t>& out, const Int3& value) {
+  WriteI32(out, value.x);
+  WriteI32(out, value.y);
+  WriteI32(out, value.z);
+}
+
+uint8_t ReadU8(ByteReader& reader) {
+  if (!CanRead(reader, 1)) {
+    return 0;
+  }
+  return reader.data[reader.offset++];
+}
+
+uint16_t ReadU16(ByteReader& reader) {
+  if (!CanRead(reader, 2)) {
+    return 0;
+  }
+  const uint8_t* bytes = reader.data + reader.offset;
+  reader.offset += 2;
+  return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+uint32_t ReadU32(ByteReader& reader) {
+  if (!CanRead(reader, 4)) {
+    return 0;
+  }
+  const uint8_t* bytes = reader.data + reader.offset;
+  reader.offset += 4;
+  return static_cast<uint32_t>(bytes[0]) |
+         (static_cast<uint32_t>(bytes[1]) << 8) |
+         (static_cast<uint32_t>(bytes[2]) << 16) |
+         (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+int32_t ReadI32(ByteReader& reader) {
+  return static_cast<int32_t>(ReadU32(reader));
+}
+
+float ReadF32(ByteReader& reader) {
+  const uint32_t bits = ReadU32(reader);
+  float value = 0.0f;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+Int3 ReadInt3(ByteReader& reader) {
+  Int3 value{};
+  value.x = ReadI32(reader);
+  value.y = ReadI32(reader);
+  value.z = ReadI32(reader);
+  return value;
+}
+
+void WriteClientHello(std::vector<uint8_t>& out,
+                      const ClientHelloMessage& message) {
+  WriteU32(out, message.version);
+}
+
+bool ReadClientHello(ByteReader& reader, ClientHelloMessage& message) {
+  message.version = ReadU32(reader);
+  return reader.ok;
+}
+
+void WriteClientInput(std::vector<uint8_t>& out,
+                      const ClientInputMessage& message) {
+  WriteU32(out, message.sequence);
+  WriteF32(out, message.yaw);
+  WriteF32(out, message.pitch);
+  WriteU8(out, static_cast<uint8_t>(message.move_forward));
+  WriteU8(out, static_cast<uint8_t>(message.move_right));
+  WriteU8(out, message.buttons);
+  WriteU8(out, message.hotbar_slot);
+}
+
+bool ReadClientInput(ByteReader& reader, ClientInputMessage& message) {
+  message.sequence = ReadU32(reader);
+  message.yaw = ReadF32(reader);
+  message.pitch = ReadF32(reader);
+  message.move_forward = static_cast<int8_t>(ReadU8(reader));
+  message.move_right = static_cast<int8_t>(ReadU8(reader));
+  message.buttons = ReadU8(reader);
+  message.hotbar_slot = ReadU8(reader);
+  return reader.ok;
+}
+
+void WriteServerWelcome(std::vector<uint8_t>& out,
+                        const ServerWelcomeMessage& message) {
+  WriteU32(out, message.client_id);
+  WriteU32(out, message.tick_rate);
+}
+
+bool ReadServerWelcome(ByteReader& reader, ServerWelcomeMessage& message) {
+  message.client_id = ReadU32(reader);
+  message.tick_rate = ReadU32(reader);
+  return reader.ok;
+}
+
+void WritePlayerState(std::vector<uint8_t>& out,
+                      const PlayerStateMessage& message) {
+  WriteU32(out, message.client_id);
+  WriteU32(out, message.last_input_sequence);
+  WriteF32(out, message.position.x);
+  WriteF32(out, message.position.y);
+  WriteF32(out, message.position.z);
+  WriteF32(out, message.velocity.x);
+  WriteF32(out, message.velocity.y);
+  WriteF32(out, message.velocity.z);
+  WriteU8(out, static_cast<uint8_t>((message.on_ground ? 1u : 0u) |
+                                    (message.crouching ? 2u : 0u)));
+}
+
+bool ReadPlayerState(ByteReader& reader, PlayerStateMessage& message) {
+  message.client_id = ReadU32(reader);
+  message.last_input_sequence = ReadU32(reader);
+  message.position.x = ReadF32(reader);
+  message.position.y = ReadF32(reader);
+  message.position.z = ReadF32(reader);
+  message.velocity.x = ReadF32(reader);
+  message.velocity.y = ReadF32(reader);
+  message.velocity.z = ReadF32(reader);
+  const uint8_t flags = ReadU8(reader);
+  message.on_ground = (flags & 1u) != 0;
+  message.crouching = (flags & 2u) != 0;
+  return reader.ok;
+}
+
+void WriteChunkData(std::vector<uint8_t>& out, const Int3& coord,
+                    uint32_t sequence, const VoxelChunk& chunk) {
+  WriteInt3(out, coord);
+  WriteU32(out, sequence);
+  const size_t offset = out.size();
+  out.resize(offset + kMaxEncodedChunkSize);
+  const size_t size =
+      EncodeChunk(chunk, out.data() + offset, kMaxEncodedChunkSize);
+  out.resize(offset + size);
+}
+
+bool ReadChunkData(ByteReader& reader, Int3& coord, uint32_t& sequence,
+                   VoxelChunk& chunk) {
+  coord = ReadInt3(reader);
+  sequence = ReadU32(reader);
+  if (!reader.ok) {
+    return false;
+  }
+  const size_t size = DecodeChunk(reader.data + reader.offset,
+                                  reader.size - reader.offset, chunk);
+  if (size == 0) {
+    reader.ok = false;
+    return false;
+  }
+  reader.offset += size;
+  return true;
+}
+
+void WriteChunkUnload(std::vector<uint8_t>& out, const Int3& coord) {
+  WriteInt3(out, coord);
+}
+
+bool ReadChunkUnload(ByteReader& reader, Int3& coord) {
+  coord = ReadInt3(reader);
+  return reader.ok;
+}
+
+void WriteChunkDelta(std::vector<uint8_t>& out, const Int3& coord,
+                     uint32_t sequence, const BlockChange* changes,
+                     size_t count) {
+  WriteInt3(out, coord);
+  WriteU32(out, sequence);
+  WriteU16(out, static_cast<uint16_t>(count));
+  for (size_t i = 0; i < count; ++i) {
+    const Int3 local = WorldToLocalCoord(changes[i].block.x,
+                                         changes[i].block.y,
+                                         changes[i].block.z);
+    const ChunkIndex index =
+        static_cast<ChunkIndex>(ChunkDims::Index(local.x, local.y, local.z));
+    if constexpr (sizeof(ChunkIndex) == sizeof(uint16_t)) {
+      WriteU16(out, index);
+    } else {
+      WriteU32(out, index);
+    }
+    WriteU8(out, static_cast<uint8_t>(changes[i].id));
+  }
+}
+
+bool ReadChunkDelta(ByteReader& reader, ChunkDeltaMessage& message) {
+  message.coord = ReadInt3(reader);
+  message.sequence = ReadU32(reader);
+  message.count = ReadU16(reader);
+  return reader.ok;
+}
+
+bool ReadChunkDeltaEntry(ByteReader& reader, Int3& local, BlockId& id) {
+  ChunkIndex index = 0;
+  if constexpr (sizeof(ChunkIndex) == sizeof(uint16_t)) {
+    index = ReadU16(reader);
+  } else {
+    index = ReadU32(reader);
+  }
+  const uint8_t value = ReadU8(reader);
+  if (!reader.ok || index >= kChunkVolume || !IsValidBlockId(value)) {
+    reader.ok = false;
+    return false;
+  }
+  local.x = ChunkDims::Local(index, 0);
+  local.y = ChunkDims::Local(index, 1);
+  local.z = ChunkDims::Local(index, 2);
+  id = static_cast<BlockId>(value);
+  return true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "world.h"
+
+constexpr uint16_t kDefaultServerPort = 25565;
+constexpr uint32_t kProtocolVersion =
+    4u | (static_cast<uint32_t>(kChunkShift) << 16) |
+    (static_cast<uint32_t>(kChunkLayout) << 24);
+constexpr size_t kMaxChunkDeltaEntries = 0xFFFF;
+
+enum class MessageType : uint8_t {
+  ClientHello = 1,
+  ClientInput = 2,
+  ServerWelcome = 16,
+  ServerPlayerState = 17,
+  ServerChunkData = 18,
+  ServerChunkUnload = 19,
+  ServerChunkDelta = 20,
+};
+
+enum InputButtons : uint8_t {
+  kButtonJump = 1u << 0,
+  kButtonCrouch = 1u << 1,
+  kButtonSprint = 1u << 2,
+  kButtonBreak = 1u << 3,
+  kButtonPlace = 1u << 4,
+};
+
+struct ClientHelloMessage {
+  uint32_t version = kProtocolVersion;
+};
+
+struct ClientInputMessage {
+  uint32_t sequence = 0;
+  float yaw = 0.0f;
+  float pitch = 0.0f;
+  int8_t move_forward = 0;
+  int8_t move_right = 0;
+  uint8_t buttons = 0;
+  uint8_t hotbar_slot = 0;
+};
+
+struct ServerWelcomeMessage {
+  uint32_t client_id = 0;
+  uint32_t tick_rate = 0;
+};
+
+struct PlayerStateMessage {
+  uint32_t client_id = 0;
+  uint32_t last_input_sequence = 0;
+  DirectX::XMFLOAT3 position{0.0f, 0.0f, 0.0f};
+  DirectX::XMFLOAT3 velocity{0.0f, 0.0f, 0.0f};
+  bool on_ground = false;
+  bool crouching = false;
+};
+
+struct ChunkDeltaMessage {
+  Int3 coord{0, 0, 0};
+  uint32_t sequence = 0;
+  uint16_t count = 0;
+};
+
+struct ByteReader {
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  size_t offset = 0;
+  bool ok = true;
+};
+
+void WriteU8(std::vector<uint8_t>& out, uint8_t value);
+void WriteU16(std::vector<uint8_t>& out, uint16_t value);
+void WriteU32(std::vector<uint8_t>& out, uint32_t value);
+void WriteI32(std::vector<uint8_t>& out, int32_t value);
+void WriteF32(std::vector<uint8_t>& out, float value);
+void WriteInt3(std::vector<uint8_t>& out, const Int3& value);
+uint8_t ReadU8(ByteReader& reader);
+uint16_t ReadU16(ByteReader& reader);
+uint32_t ReadU32(ByteReader& reader);
+int32_t ReadI32(ByteReader& reader);
+float ReadF32(ByteReader& reader);
+Int3 ReadInt3(ByteReader& reader);
+
+void WriteClientHello(std::vector<uint8_t>& out,
+                      const ClientHelloMessage& message);
+bool ReadClientHello(ByteReader& reader, ClientHelloMessage& message);
+void WriteClientInput(std::vector<uint8_t>& out,
+                      const ClientInputMessage& message);
+bool ReadClientInput(ByteReader& reader, ClientInputMessage& message);
+void WriteServerWelcome(std::vector<uint8_t>& out,
+                        const ServerWelcomeMessage& message);
+bool ReadServerWelcome(ByteReader& reader, ServerWelcomeMessage& message);
+void WritePlayerState(std::vector<uint8_t>& out,
+                      const PlayerStateMessage& message);
+bool ReadPlayerState(ByteReader& reader, PlayerStateMessage& message);
+void WriteChunkData(std::vector<uint8_t>& out, const Int3& coord,
+                    uint32_t sequence, const VoxelChunk& chunk);
+bool ReadChunkData(ByteReader& reader, Int3& coord, uint32_t& sequence,
+                   VoxelChunk& chunk);
+void WriteChunkUnload(std::vector<uint8_t>& out, const Int3& coord);
+bool ReadChunkUnload(ByteReader& reader, Int3& coord);
+void WriteChunkDelta(std::vector<uint8_t>& out, const Int3& coord,
+                     uint32_t sequence, const BlockChange* changes,
+                     size_t count);
+bool ReadChunkDelta(ByteReader& reader, ChunkDeltaMessage& message);
+bool ReadChunkDeltaEntry(ByteReader& reader, Int3& local, BlockId& id);
@@ -0,0 +1,177 @@
+#include "range_allocator.h"
+
+#include <algorithm>
+#include <iterator>
+
+void InitRangeAllocator(RangeAllocator& allocator, uint32_t capacity) {
+  allocator = {};
+  allocator.capacity = capacity;
+  if (capacity > 0) {
+    allocator.free_list.push_back({0, capacity});
+  }
+}
+
+bool AllocateRange(RangeAllocator& allocator, uint32_t size, uint32_t& offset) {
+  if (size == 0) {
+    return false;
+  }
+  auto best = allocator.free_list.end();
+  for (auto it = allocator.free_list.begin(); it != allocator.free_list.end();
+       ++it) {
+    if (it->size >= size && (best == allocator.free_list.end() ||
+                             it->size < best->size)) {
+      best = it;
+      if (best->size == size) {
+        break;
+      }
+    }
+  }
+  if (best == allocator.free_list.end()) {
+    ++allocator.failures;
+    return false;
+  }
+  offset = best->offset;
+  if (best->size == size) {
+    allocator.free_list.erase(best);
+  } else {
+    best->offset += size;
+    best->size -= size;
+  }
+  allocator.used += size;
+  allocator.high_water = std::max(allocator.high_water, allocator.used);
+  ++allocator.allocations;
+  return true;
+}
+
+void FreeRange(RangeAllocator& allocator, uint32_t offset, uint32_t size) {
+  if (size == 0) {
+    return;
+  }
+  auto next = std::lower_bound(
+      allocator.free_list.begin(), allocator.free_list.end(), offset,
+      [](const RangeSpan& span, uint32_t value) { return span.offset < value; });
+  const bool joins_prev =
+      next != allocator.free_list.begin() &&
+      std::prev(next)->offset + std::prev(next)->size == offset;
+  const bool joins_next =
+      next != allocator.free_list.end() && offset + size == next->offset;
+  if (joins_prev && joins_next) {
+    std::prev(next)->size += size + next->size;
+    allocator.free_list.erase(next);
+  } else if (joins_prev) {
+    std::prev(next)->size += size;
+  } else if (joins_next) {
+    next->offset = offset;
+    next->size += size;
+  } else {
+    allocator.free_list.insert(next, {offset, size});
+  }
+  allocator.used -= size;
+  ++allocator.frees;
+}
+
+RangeAllocatorStats GetRangeAllocatorStats(const RangeAllocator& allocator) {
+  RangeAllocatorStats stats;
+  stats.capacity = allocator.capacity;
+  stats.used = allocator.used;
+  stats.high_water = allocator.high_water;
+  stats.free_ranges = allocator.free_list.size();
+  stats.allocations = allocator.allocations;
+  stats.frees = allocator.frees;
+  stats.failures = allocator.failures;
+  for (const RangeSpan& span : allocator.free_list) {
+    stats.largest_free = std::max(stats.largest_free, span.size);
+  }
+  const uint32_t free_total = allocator.capacity - allocator.used;
+  if (free_total > 0) {
+    stats.fragmentation =
+        1.0f - static_cast<float>(stats.largest_free) /
+                   static_cast<float>(free_total);
+  }
+  return stats;
+}
+
+bool ValidateRangeAllocator(const RangeAllocator& allocator) {
+  uint64_t free_total = 0;
+  uint64_t end = 0;
+  for (size_t i = 0; i < allocator.free_list.size(); ++i) {
+    const RangeSpan& span = allocator.free_list[i];
+    if (span.size == 0 || (i > 0 && span.offset <= end)) {
+      return false;
+    }
+    end = static_cast<uint64_t>(span.offset) + span.size;
+    if (end > allocator.capacity) {
+      return false;
+    }
+    free_total += span.size;
+  }
+  return free_total + allocator.used == allocator.capacity;
+}
+
+void InitVertexPagePool(VertexPagePool& pool, uint32_t page_size,
+                        uint32_t granule) {
+  pool = {};
+  pool.page_size = page_size;
+  pool.granule = std::max(granule, 1u);
+}
+
+bool AllocateVertexPageRange(VertexPagePool& pool, uint32_t count,
+                             VertexPageRange& range) {
+  range = {};
+  if (count == 0) {
+    return false;
+  }
+  const uint32_t size =
+      (count + pool.granule - 1) / pool.granule * pool.granule;
+  for (size_t i = 0; i < pool.pages.size(); ++i) {
+    if (AllocateRange(pool.pages[i], size, range.offset)) {
+      range.page = static_cast<int>(i);
+      range.size = size;
+      return true;
+    }
+  }
+  pool.pages.emplace_back();
+  InitRangeAllocator(pool.pages.back(), std::max(size, pool.page_size));
+  if (!AllocateRange(pool.pages.back(), size, range.offset)) {
+    pool.pages.pop_back();
+    return false;
+  }
+  range.page = static_cast<int>(pool.pages.size() - 1);
+  range.size = size;
+  return true;
+}
+
+void FreeVertexPageRange(VertexPagePool& pool, VertexPageRange& range) {
+  if (range.page < 0) {
+    return;
+  }
+  FreeRange(pool.pages[static_cast<size_t>(range.page)], range.offset,
+            range.size);
+  range = {};
+}
+
+VertexPagePoolStats GetVertexPagePoolStats(const VertexPagePool& pool) {
+  VertexPagePoolStats stats;
+  stats.pages = pool.pages.size();
+  for (const RangeAllocator& page : pool.pages) {
+    const RangeAllocatorStats ranges = GetRangeAllocatorStats(page);
+    stats.capacity += ranges.capacity;
+    stats.used += ranges.used;
+    stats.free_ranges += ranges.free_ranges;
+    stats.fragmentation = std::max(stats.fragmentation, ranges.fragmentation);
+  }
+  if (stats.capacity > 0) {
+    stats.waste = 1.0f - static_cast<float>(stats.used) /
+                             static_cast<float>(stats.capacity);
+  }
+  return stats;
+}
+
+bool ValidateVertexPagePool(const VertexPagePool& pool) {
+  for (const RangeAllocator& page : pool.pages) {
+    if (!ValidateRangeAllocator(page)) {
+      return false;
+    }
+  }
+  return true;
+}
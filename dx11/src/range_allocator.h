@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct RangeSpan {
+  uint32_t offset = 0;
+  uint32_t size = 0;
+};
+
+struct RangeAllocatorStats {
+  uint32_t capacity = 0;
+  uint32_t used = 0;
+  uint32_t high_water = 0;
+  uint32_t largest_free = 0;
+  size_t free_ranges = 0;
+  uint64_t allocations = 0;
+  uint64_t frees = 0;
+  uint64_t failures = 0;
+  float fragmentation = 0.0f;
+};
+
+struct RangeAllocator {
+  uint32_t capacity = 0;
+  uint32_t used = 0;
+  uint32_t high_water = 0;
+  uint64_t allocations = 0;
+  uint64_t frees = 0;
+  uint64_t failures = 0;
+  std::vector<RangeSpan> free_list;
+};
+
+void InitRangeAllocator(RangeAllocator& allocator, uint32_t capacity);
+bool AllocateRange(RangeAllocator& allocator, uint32_t size, uint32_t& offset);
+void FreeRange(RangeAllocator& allocator, uint32_t offset, uint32_t size);
+RangeAllocatorStats GetRangeAllocatorStats(const RangeAllocator& allocator);
+bool ValidateRangeAllocator(const RangeAllocator& allocator);
+
+struct VertexPageRange {
+  int page = -1;
+  uint32_t offset = 0;
+  uint32_t size = 0;
+};
+
+struct VertexPagePoolStats {
+  size_t pages = 0;
+  uint64_t capacity = 0;
+  uint64_t used = 0;
+  size_t free_ranges = 0;
+  float waste = 0.0f;
+  float fragmentation = 0.0f;
+};
+
+struct VertexPagePool {
+  uint32_t page_size = 0;
+  uint32_t granule = 1;
+  std::vector<RangeAllocator> pages;
+};
+
+void InitVertexPagePool(VertexPagePool& pool, uint32_t page_size,
+                        uint32_t granule);
+bool AllocateVertexPageRange(VertexPagePool& pool, uint32_t count,
+                             VertexPageRange& range);
+void FreeVertexPageRange(VertexPagePool& pool, VertexPageRange& range);
+VertexPagePoolStats GetVertexPagePoolStats(const VertexPagePool& pool);
+bool ValidateVertexPagePool(const VertexPagePool& pool);
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
@@ -13,6 +14,10 @@
 #include <string>
 #include <vector>
 
+#include "frame_stats.h"
+#include "memory_stats.h"
+#include "profiler.h"
+
 namespace {
 using D3DCompileFn =
     HRESULT(WINAPI*)(LPCVOID, SIZE_T, LPCSTR, const D3D_SHADER_MACRO*, ID3DInclude*,
@@ -26,7 +31,7 @@ struct Glyph {
   std::array<uint8_t, 7> rows;
 };
 
-const std::array<Glyph, 17> kGlyphs = {{
+const std::array<Glyph, 29> kGlyphs = {{
     {'0', {0b01110, 0b10001, 0b10011, 0b10101, 0b11001, 0b10001, 0b01110}},
     {'1', {0b00100, 0b01100, 0b00100, 0b00100, 0b00100, 0b00100, 0b01110}},
     {'2', {0b01110, 0b10001, 0b00001, 0b00010, 0b00100, 0b01000, 0b11111}},
@@ -44,6 +49,18 @@ const std::array<Glyph, 17> kGlyphs = {{
     {'Y', {0b10001, 0b01010, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100}},
     {'Z', {0b11111, 0b00001, 0b00010, 0b00100, 0b01000, 0b10000, 0b11111}},
     {'B', {0b11110, 0b10001, 0b10001, 0b11110, 0b10001, 0b10001, 0b11110}},
+    {'E', {0b11111, 0b10000, 0b10000, 0b11110, 0b10000, 0b10000, 0b11111}},
+    {'M', {0b10001, 0b11011, 0b10101, 0b10101, 0b10001, 0b10001, 0b10001}},
+    {'L', {0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b10000, 0b11111}},
+    {'C', {0b01110, 0b10001, 0b10000, 0b10000, 0b10000, 0b10001, 0b01110}},
+    {'K', {0b10001, 0b10010, 0b10100, 0b11000, 0b10100, 0b10010, 0b10001}},
+    {'T', {0b11111, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100, 0b00100}},
+    {'U', {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01110}},
+    {'A', {0b01110, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001}},
+    {'H', {0b10001, 0b10001, 0b10001, 0b11111, 0b10001, 0b10001, 0b10001}},
+    {'D', {0b11110, 0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b11110}},
+    {'J', {0b00111, 0b00010, 0b00010, 0b00010, 0b00010, 0b10010, 0b01100}},
+    {'V', {0b10001, 0b10001, 0b10001, 0b10001, 0b10001, 0b01010, 0b00100}},
 }};
 
 void ShowError(const char* message, HRESULT hr) {
@@ -174,6 +191,26 @@ bool LoadPPMFile(const char* path, std::vector<uint8_t>& pixels, int& width,
   return true;
 }
 
+void ApplyAtlasAlpha(std::vector<uint8_t>& pixels, int width, int height) {
+  const int tile_width = std::max(1, width / kAtlasTilesX);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      uint8_t* pixel =
+          &pixels[(static_cast<size_t>(y) * static_cast<size_t>(width) +
+                   static_cast<size_t>(x)) * 4];
+      if (pixel[0] == kAtlasKeyColor[0] && pixel[1] == kAtlasKeyColor[1] &&
+          pixel[2] == kAtlasKeyColor[2]) {
+        pixel[0] = 0;
+        pixel[1] = 0;
+        pixel[2] = 0;
+        pixel[3] = 0;
+      } else if (x / tile_width == kTileWater) {
+        pixel[3] = kWaterAlpha;
+      }
+    }
+  }
+}
+
 bool CreateTextureAtlas(RendererState& renderer) {
   std::vector<uint8_t> pixels;
   int width = 0;
@@ -194,6 +231,7 @@ bool CreateTextureAtlas(RendererState& renderer) {
     MessageBoxA(nullptr, "Atlas size does not match tile layout.",
                 "Texture Warning", MB_ICONWARNING);
   }
+  ApplyAtlasAlpha(pixels, width, height);
 
   D3D11_TEXTURE2D_DESC desc{};
   desc.Width = static_cast<UINT>(width);
@@ -215,6 +253,8 @@ bool CreateTextureAtlas(RendererState& renderer) {
     ShowError("Failed to create texture atlas", hr);
     return false;
   }
+  TrackMemoryAlloc(MemoryCategory::RenderState,
+                   static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
 
   D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc{};
   srv_desc.Format = desc.Format;
@@ -252,6 +292,9 @@ bool CreatePipeline(RendererState& renderer) {
     cbuffer Constants : register(b0) {
       float4x4 mvp;
     };
+    cbuffer ChunkConstants : register(b1) {
+      float4 chunkOffset;
+    };
     struct VSInput {
       float3 position : POSITION;
       float4 color : COLOR;
@@ -264,7 +307,8 @@ bool CreatePipeline(RendererState& renderer) {
     };
     VSOutput main(VSInput input) {
       VSOutput output;
-      output.position = mul(float4(input.position, 1.0f), mvp);
+      output.position =
+          mul(float4(input.position + chunkOffset.xyz, 1.0f), mvp);
       output.color = input.color;
       output.uv = input.uv;
       return output;
@@ -281,15 +325,63 @@ bool CreatePipeline(RendererState& renderer) {
     };
     float4 main(PSInput input) : SV_TARGET {
       const float tileIndex = input.color.a;
-      const float2 tileSize = float2(1.0f / 4.0f, 1.0f / 1.0f);
-      const float tileX = fmod(tileIndex, 4.0f);
-      const float tileY = floor(tileIndex / 4.0f);
+      const float2 tileSize = float2(1.0f / 8.0f, 1.0f / 1.0f);
+      const float tileX = fmod(tileIndex, 8.0f);
+      const float tileY = floor(tileIndex / 8.0f);
       const float2 base = float2(tileX, tileY) * tileSize;
       const float2 uv = base + frac(input.uv) * tileSize;
       return atlas.Sample(atlasSampler, uv) * float4(input.color.rgb, 1.0f);
     }
   )";
 
+  const char* cutout_ps_source = R"(
+    Texture2D atlas : register(t0);
+    SamplerState atlasSampler : register(s0);
+    struct PSInput {
+      float4 position : SV_POSITION;
+      float4 color : COLOR;
+      float2 uv : TEXCOORD0;
+    };
+    float4 main(PSInput input) : SV_TARGET {
+      const float tileIndex = input.color.a;
+      const float2 tileSize = float2(1.0f / 8.0f, 1.0f / 1.0f);
+      const float tileX = fmod(tileIndex, 8.0f);
+      const float tileY = floor(tileIndex / 8.0f);
+      const float2 base = float2(tileX, tileY) * tileSize;
+      const float2 uv = base + frac(input.uv) * tileSize;
+      const float4 texel = atlas.Sample(atlasSampler, uv);
+      clip(texel.a - 0.5f);
+      return float4(texel.rgb * input.color.rgb, 1.0f);
+    }
+  )";
+
+  const char* chunk_vs_source = R"(
+    cbuffer Constants : register(b0) {
+      float4x4 mvp;
+    };
+    cbuffer ChunkConstants : register(b1) {
+      float4 chunkOffset;
+    };
+    struct VSInput {
+      uint4 position : POSITION;
+      float4 color : COLOR;
+      uint4 uv : TEXCOORD0;
+    };
+    struct VSOutput {
+      float4 position : SV_POSITION;
+      float4 color : COLOR;
+      float2 uv : TEXCOORD0;
+    };
+    VSOutput main(VSInput input) {
+      VSOutput output;
+      const float3 local = float3(input.position.xyz) * chunkOffset.w;
+      output.position = mul(float4(local + chunkOffset.xyz, 1.0f), mvp);
+      output.color = float4(input.color.rgb, float(input.position.w));
+      output.uv = float2(input.uv.xy);
+      return output;
+    }
+  )";
+
   Microsoft::WRL::ComPtr<ID3DBlob> vs_blob;
   if (!CompileShader(vs_source, "main", "vs_5_0", vs_blob)) {
     return false;
@@ -302,6 +394,18 @@ bool CreatePipeline(RendererState& renderer) {
     return false;
   }
 
+  Microsoft::WRL::ComPtr<ID3DBlob> chunk_vs_blob;
+  if (!CompileShader(chunk_vs_source, "main", "vs_5_0", chunk_vs_blob)) {
+    return false;
+  }
+  hr = renderer.device->CreateVertexShader(
+      chunk_vs_blob->GetBufferPointer(), chunk_vs_blob->GetBufferSize(),
+      nullptr, &renderer.chunk_vertex_shader);
+  if (FAILED(hr)) {
+    ShowError("Failed to create chunk vertex shader", hr);
+    return false;
+  }
+
   Microsoft::WRL::ComPtr<ID3DBlob> ps_blob;
   if (!CompileShader(ps_source, "main", "ps_5_0", ps_blob)) {
     return false;
@@ -314,6 +418,18 @@ bool CreatePipeline(RendererState& renderer) {
     return false;
   }
 
+  Microsoft::WRL::ComPtr<ID3DBlob> cutout_ps_blob;
+  if (!CompileShader(cutout_ps_source, "main", "ps_5_0", cutout_ps_blob)) {
+    return false;
+  }
+  hr = renderer.device->CreatePixelShader(
+      cutout_ps_blob->GetBufferPointer(), cutout_ps_blob->GetBufferSize(),
+      nullptr, &renderer.cutout_pixel_shader);
+  if (FAILED(hr)) {
+    ShowError("Failed to create cutout pixel shader", hr);
+    return false;
+  }
+
   const char* solid_ps_source = R"(
     struct PSInput {
       float4 position : SV_POSITION;
@@ -356,6 +472,27 @@ bool CreatePipeline(RendererState& renderer) {
     return false;
   }
 
+  const D3D11_INPUT_ELEMENT_DESC chunk_layout[] = {
+      {"POSITION", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0,
+       static_cast<UINT>(offsetof(ChunkVertex, position)),
+       D3D11_INPUT_PER_VERTEX_DATA, 0},
+      {"COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0,
+       static_cast<UINT>(offsetof(ChunkVertex, color)),
+       D3D11_INPUT_PER_VERTEX_DATA, 0},
+      {"TEXCOORD", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0,
+       static_cast<UINT>(offsetof(ChunkVertex, uv)),
+       D3D11_INPUT_PER_VERTEX_DATA, 0},
+  };
+  hr = renderer.device->CreateInputLayout(
+      chunk_layout,
+      static_cast<UINT>(sizeof(chunk_layout) / sizeof(chunk_layout[0])),
+      chunk_vs_blob->GetBufferPointer(), chunk_vs_blob->GetBufferSize(),
+      &renderer.chunk_input_layout);
+  if (FAILED(hr)) {
+    ShowError("Failed to create chunk input layout", hr);
+    return false;
+  }
+
   D3D11_BUFFER_DESC constant_desc{};
   constant_desc.ByteWidth = sizeof(DirectX::XMFLOAT4X4);
   constant_desc.Usage = D3D11_USAGE_DEFAULT;
@@ -366,6 +503,16 @@ bool CreatePipeline(RendererState& renderer) {
     ShowError("Failed to create constant buffer", hr);
     return false;
   }
+  TrackMemoryAlloc(MemoryCategory::RenderState, constant_desc.ByteWidth);
+
+  constant_desc.ByteWidth = sizeof(DirectX::XMFLOAT4);
+  hr = renderer.device->CreateBuffer(&constant_desc, nullptr,
+                                     &renderer.chunk_offset_buffer);
+  if (FAILED(hr)) {
+    ShowError("Failed to create chunk offset buffer", hr);
+    return false;
+  }
+  TrackMemoryAlloc(MemoryCategory::RenderState, constant_desc.ByteWidth);
 
   D3D11_RASTERIZER_DESC raster_desc{};
   raster_desc.FillMode = D3D11_FILL_SOLID;
@@ -399,6 +546,33 @@ bool CreatePipeline(RendererState& renderer) {
     return false;
   }
 
+  depth_desc.DepthEnable = TRUE;
+  depth_desc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+  depth_desc.DepthFunc = D3D11_COMPARISON_LESS;
+  hr = renderer.device->CreateDepthStencilState(
+      &depth_desc, &renderer.depth_state_read_only);
+  if (FAILED(hr)) {
+    ShowError("Failed to create read-only depth stencil state", hr);
+    return false;
+  }
+
+  D3D11_BLEND_DESC blend_desc{};
+  blend_desc.RenderTarget[0].BlendEnable = TRUE;
+  blend_desc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+  blend_desc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+  blend_desc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+  blend_desc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+  blend_desc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+  blend_desc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+  blend_desc.RenderTarget[0].RenderTargetWriteMask =
+      D3D11_COLOR_WRITE_ENABLE_ALL;
+  hr = renderer.device->CreateBlendState(&blend_desc,
+                                         &renderer.alpha_blend_state);
+  if (FAILED(hr)) {
+    ShowError("Failed to create alpha blend state", hr);
+    return false;
+  }
+
   D3D11_RASTERIZER_DESC wire_desc = raster_desc;
   wire_desc.FillMode = D3D11_FILL_WIREFRAME;
   wire_desc.CullMode = D3D11_CULL_NONE;
@@ -414,6 +588,7 @@ bool CreatePipeline(RendererState& renderer) {
   }
 
   renderer.vertex_stride = sizeof(Vertex);
+  renderer.chunk_vertex_stride = sizeof(ChunkVertex);
   renderer.vertex_offset = 0;
   return true;
 }
@@ -453,6 +628,11 @@ bool CreateRenderTarget(RendererState& renderer) {
     ShowError("Failed to create depth stencil view", hr);
     return false;
   }
+  const size_t target_bytes = static_cast<size_t>(renderer.width) *
+                              static_cast<size_t>(renderer.height) * 8;
+  TrackMemoryResize(MemoryCategory::RenderState,
+                    renderer.tracked_target_bytes, target_bytes);
+  renderer.tracked_target_bytes = target_bytes;
 
   renderer.context->OMSetRenderTargets(
       1, renderer.render_target.GetAddressOf(),
@@ -468,47 +648,42 @@ bool CreateRenderTarget(RendererState& renderer) {
   return true;
 }
 
-bool UploadChunkMesh(RendererState& renderer, ChunkMesh& mesh,
-                     const std::vector<Vertex>& vertices) {
+bool UploadChunkMesh(RendererState& renderer, const MeshBuffer& mesh,
+                     const std::vector<ChunkVertex>& vertices) {
+  const ScopedProfile profile("UploadChunkMesh");
   if (!renderer.device || !renderer.context) {
     return false;
   }
-  if (vertices.empty()) {
-    mesh.vertex_count = 0;
-    return true;
-  }
-  mesh.vertex_count = static_cast<UINT>(vertices.size());
-  const UINT byte_size = mesh.vertex_count * sizeof(Vertex);
-  if (!mesh.vertex_buffer || byte_size > mesh.vertex_buffer_size) {
-    mesh.vertex_buffer.Reset();
+  const VertexPagePool& pool = renderer.meshes.vertex_pool;
+  while (renderer.vertex_page_buffers.size() < pool.pages.size()) {
     D3D11_BUFFER_DESC buffer_desc{};
-    buffer_desc.ByteWidth = byte_size;
-    buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+    buffer_desc.ByteWidth =
+        pool.pages[renderer.vertex_page_buffers.size()].capacity *
+        sizeof(ChunkVertex);
+    buffer_desc.Usage = D3D11_USAGE_DEFAULT;
     buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    HRESULT hr = renderer.device->CreateBuffer(&buffer_desc, nullptr,
-                                               &mesh.vertex_buffer);
+    Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+    HRESULT hr = renderer.device->CreateBuffer(&buffer_desc, nullptr, &buffer);
     if (FAILED(hr)) {
-      ShowError("Failed to create voxel vertex buffer", hr);
+      ShowError("Failed to create voxel vertex page", hr);
       return false;
     }
-    mesh.vertex_buffer_size = byte_size;
+    renderer.vertex_page_buffers.push_back(std::move(buffer));
   }
 
-  D3D11_MAPPED_SUBRESOURCE mapped{};
-  HRESULT hr = renderer.context->Map(mesh.vertex_buffer.Get(), 0,
-                                     D3D11_MAP_WRITE_DISCARD, 0, &mapped);
-  if (FAILED(hr)) {
-    ShowError("Failed to map voxel vertex buffer", hr);
-    return false;
-  }
-  std::memcpy(mapped.pData, vertices.data(), byte_size);
-  renderer.context->Unmap(mesh.vertex_buffer.Get(), 0);
+  D3D11_BOX box{};
+  box.left = mesh.range.offset * sizeof(ChunkVertex);
+  box.right = box.left + mesh.vertex_count * sizeof(ChunkVertex);
+  box.bottom = 1;
+  box.back = 1;
+  renderer.context->UpdateSubresource(
+      renderer.vertex_page_buffers[static_cast<size_t>(mesh.range.page)].Get(),
+      0, &box, vertices.data(), 0, 0);
   return true;
 }
 
 bool UploadSelectionMesh(RendererState& renderer,
-                         const std::vector<Vertex>& vertices) {
+                         const FrameVector<Vertex>& vertices) {
   if (!renderer.device || !renderer.context) {
     return false;
   }
@@ -532,6 +707,8 @@ bool UploadSelectionMesh(RendererState& renderer,
       ShowError("Failed to create selection vertex buffer", hr);
       return false;
     }
+    TrackMemoryResize(MemoryCategory::RenderState,
+                      renderer.highlight_vertex_buffer_size, byte_size);
     renderer.highlight_vertex_buffer_size = byte_size;
   }
 
@@ -547,7 +724,7 @@ bool UploadSelectionMesh(RendererState& renderer,
   return true;
 }
 
-bool UploadHudMesh(RendererState& renderer, const std::vector<Vertex>& vertices) {
+bool UploadHudMesh(RendererState& renderer, const FrameVector<Vertex>& vertices) {
   if (!renderer.device || !renderer.context) {
     return false;
   }
@@ -571,6 +748,8 @@ bool UploadHudMesh(RendererState& renderer, const std::vector<Vertex>& vertices)
       ShowError("Failed to create HUD vertex buffer", hr);
       return false;
     }
+    TrackMemoryResize(MemoryCategory::RenderState,
+                      renderer.hud_vertex_buffer_size, byte_size);
     renderer.hud_vertex_buffer_size = byte_size;
   }
 
@@ -586,6 +765,48 @@ bool UploadHudMesh(RendererState& renderer, const std::vector<Vertex>& vertices)
   return true;
 }
 
+bool UploadEntityMesh(RendererState& renderer,
+                      const FrameVector<Vertex>& vertices) {
+  if (!renderer.device || !renderer.context) {
+    return false;
+  }
+  if (vertices.empty()) {
+    renderer.entity_vertex_count = 0;
+    return true;
+  }
+  renderer.entity_vertex_count = static_cast<UINT>(vertices.size());
+  const UINT byte_size = renderer.entity_vertex_count * sizeof(Vertex);
+  if (!renderer.entity_vertex_buffer ||
+      byte_size > renderer.entity_vertex_buffer_size) {
+    renderer.entity_vertex_buffer.Reset();
+    D3D11_BUFFER_DESC buffer_desc{};
+    buffer_desc.ByteWidth = byte_size;
+    buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+    buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    HRESULT hr = renderer.device->CreateBuffer(&buffer_desc, nullptr,
+                                               &renderer.entity_vertex_buffer);
+    if (FAILED(hr)) {
+      ShowError("Failed to create entity vertex buffer", hr);
+      return false;
+    }
+    TrackMemoryResize(MemoryCategory::RenderState,
+                      renderer.entity_vertex_buffer_size, byte_size);
+    renderer.entity_vertex_buffer_size = byte_size;
+  }
+
+  D3D11_MAPPED_SUBRESOURCE mapped{};
+  HRESULT hr = renderer.context->Map(renderer.entity_vertex_buffer.Get(), 0,
+                                     D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+  if (FAILED(hr)) {
+    ShowError("Failed to map entity vertex buffer", hr);
+    return false;
+  }
+  std::memcpy(mapped.pData, vertices.data(), byte_size);
+  renderer.context->Unmap(renderer.entity_vertex_buffer.Get(), 0);
+  return true;
+}
+
 const Glyph* FindGlyph(char ch) {
   for (const auto& glyph : kGlyphs) {
     if (glyph.ch == ch) {
@@ -594,7 +815,7 @@ const Glyph* FindGlyph(char ch) {
   }
   return nullptr;
 }
-void AddQuadPixels(std::vector<Vertex>& vertices, float x, float y, float w,
+void AddQuadPixels(FrameVector<Vertex>& vertices, float x, float y, float w,
                    float h, const DirectX::XMFLOAT4& color, float screen_w,
                    float screen_h) {
   const float x0 = (x / screen_w) * 2.0f - 1.0f;
@@ -611,7 +832,7 @@ void AddQuadPixels(std::vector<Vertex>& vertices, float x, float y, float w,
   vertices.push_back({{x0, y1, 0.0f}, color, uv});
 }
 
-void DrawText(std::vector<Vertex>& vertices, float x, float y, float scale,
+void DrawText(FrameVector<Vertex>& vertices, float x, float y, float scale,
               const char* text, const DirectX::XMFLOAT4& color, float screen_w,
               float screen_h) {
   const float advance = 6.0f * scale;
@@ -622,14 +843,15 @@ void DrawText(std::vector<Vertex>& vertices, float x, float y, float scale,
       x += advance;
       continue;
     }
-    if (ch == ':' || ch == '-') {
-      const bool is_colon = (ch == ':');
+    if (ch == ':' || ch == '-' || ch == '.') {
       for (int row = 0; row < 7; ++row) {
         bool on = false;
-        if (is_colon) {
+        if (ch == ':') {
           on = (row == 1 || row == 2 || row == 4 || row == 5);
-        } else {
+        } else if (ch == '-') {
           on = (row == 3);
+        } else {
+          on = (row == 6);
         }
         if (on) {
           AddQuadPixels(vertices, x + 2.0f * pixel, y + row * pixel, pixel,
@@ -658,8 +880,8 @@ void DrawText(std::vector<Vertex>& vertices, float x, float y, float scale,
   }
 }
 
-std::vector<Vertex> BuildSelectionMesh(const Int3& block) {
-  std::vector<Vertex> vertices;
+FrameVector<Vertex> BuildSelectionMesh(const Int3& block) {
+  FrameVector<Vertex> vertices;
   vertices.reserve(36u);
   const float expand = (kSelectionScale - 1.0f) * 0.5f * kBlockSize;
   const DirectX::XMFLOAT3 base{
@@ -675,10 +897,72 @@ std::vector<Vertex> BuildSelectionMesh(const Int3& block) {
   return vertices;
 }
 
-std::vector<Vertex> BuildHudMesh(RendererState& renderer, float fps,
+DirectX::XMFLOAT4 GetEntityColor(EntityKind kind, BlockId item_block) {
+  if (kind == EntityKind::Mob) {
+    return {0.85f, 0.45f, 0.35f, 1.0f};
+  }
+  switch (item_block) {
+    case BlockId::Grass:
+      return {0.35f, 0.7f, 0.3f, 1.0f};
+    case BlockId::Dirt:
+      return {0.5f, 0.36f, 0.24f, 1.0f};
+    case BlockId::Stone:
+      return {0.55f, 0.55f, 0.55f, 1.0f};
+    case BlockId::Water:
+      return {0.25f, 0.4f, 0.85f, 1.0f};
+    case BlockId::Lava:
+      return {0.9f, 0.4f, 0.1f, 1.0f};
+    case BlockId::Glass:
+      return {0.75f, 0.88f, 0.92f, 1.0f};
+    case BlockId::Leaves:
+      return {0.2f, 0.55f, 0.2f, 1.0f};
+    case BlockId::Air:
+      break;
+  }
+  return {1.0f, 1.0f, 1.0f, 1.0f};
+}
+
+void AddBox(FrameVector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
+            const DirectX::XMFLOAT3& size, const DirectX::XMFLOAT4& color) {
+  constexpr int indices[6] = {0, 1, 2, 0, 2, 3};
+  const DirectX::XMFLOAT2 uv{0.0f, 0.0f};
+  for (const auto& face : kFaces) {
+    const DirectX::XMFLOAT4 shaded = ApplyShade(color, face.shade);
+    for (int i = 0; i < 6; ++i) {
+      const DirectX::XMFLOAT3& corner =
+          face.corners[static_cast<size_t>(indices[i])];
+      vertices.push_back({{base.x + corner.x * size.x,
+                           base.y + corner.y * size.y,
+                           base.z + corner.z * size.z},
+                          shaded,
+                          uv});
+    }
+  }
+}
+
+FrameVector<Vertex> BuildEntityMesh(const EntityStore& entities) {
+  FrameVector<Vertex> vertices;
+  const size_t count = GetEntityCount(entities);
+  vertices.reserve(count * 36u);
+  for (size_t i = 0; i < count; ++i) {
+    const float radius = entities.radius[i];
+    const DirectX::XMFLOAT3 base{entities.position_x[i] - radius,
+                                 entities.position_y[i],
+                                 entities.position_z[i] - radius};
+    const DirectX::XMFLOAT3 size{radius * 2.0f, entities.height[i],
+                                 radius * 2.0f};
+    AddBox(vertices, base, size,
+           GetEntityColor(entities.kind[i], entities.item_block[i]));
+  }
+  return vertices;
+}
+
+FrameVector<Vertex> BuildHudMesh(RendererState& renderer, float fps,
                                  const DirectX::XMFLOAT3& position,
-                                 int block_id) {
-  std::vector<Vertex> vertices;
+                                 int block_id,
+                                 const EntityStats& entity_stats,
+                                 const HudWorldStats& world_stats) {
+  FrameVector<Vertex> vertices;
   if (renderer.width == 0 || renderer.height == 0) {
     return vertices;
   }
@@ -720,6 +1004,146 @@ std::vector<Vertex> BuildHudMesh(RendererState& renderer, float fps,
 
   std::snprintf(buffer, sizeof(buffer), "B:%d", block_id);
   DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  std::snprintf(buffer, sizeof(buffer), "E:%d EPMS:%d",
+                entity_stats.entity_count,
+                static_cast<int>(entity_stats.entities_per_ms + 0.5f));
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  const MeshCacheStats& mesh_stats = renderer.meshes.stats;
+  std::snprintf(buffer, sizeof(buffer), "L:%d %d %d %d",
+                mesh_stats.lod_chunks[0], mesh_stats.lod_chunks[1],
+                mesh_stats.lod_chunks[2], mesh_stats.lod_chunks[3]);
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  const uint64_t lookups =
+      mesh_stats.mesh_cache_hits + mesh_stats.mesh_cache_misses;
+  std::snprintf(
+      buffer, sizeof(buffer), "C:%d MS:%d KB:%d CX:%d",
+      lookups > 0
+          ? static_cast<int>(mesh_stats.mesh_cache_hits * 100 / lookups)
+          : 0,
+      static_cast<int>(mesh_stats.mesh_ms_saved + 0.5f),
+      static_cast<int>(mesh_stats.mesh_bytes_saved / 1024),
+      static_cast<int>(mesh_stats.mesh_cache_collisions));
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  std::snprintf(buffer, sizeof(buffer), "T:%d US:%d",
+                renderer.stats.transparent_chunks,
+                static_cast<int>(renderer.stats.alpha_pass_ms * 1000.0f + 0.5f));
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  const FrameArenaStats& frame = GetFrameArena().stats;
+  const AllocStats& allocs = GetLastFrameAllocStats();
+  const auto phase_allocs = [&allocs](FramePhase phase) {
+    return static_cast<int>(
+        allocs.phases[static_cast<size_t>(phase)].allocations);
+  };
+  std::snprintf(buffer, sizeof(buffer), "A:%d %d %d %d-%d %d %d",
+                phase_allocs(FramePhase::Other),
+                phase_allocs(FramePhase::UpdatePlayer),
+                phase_allocs(FramePhase::StreamChunks),
+                phase_allocs(FramePhase::UpdateChunkMeshes),
+                mesh_stats.known_allocs,
+                phase_allocs(FramePhase::UpdateHudMesh),
+                phase_allocs(FramePhase::RenderFrame));
+  const DirectX::XMFLOAT4 flagged{1.0f, 0.3f, 0.3f, 1.0f};
+  DrawText(vertices, x, y, kHudScale, buffer,
+           frame.frame_heap_allocations > 0 || frame.frame_overflows > 0
+               ? flagged
+               : white,
+           screen_w, screen_h);
+  y += line_height;
+
+  uint64_t frame_alloc_bytes = 0;
+  for (const AllocCounters& phase : allocs.phases) {
+    frame_alloc_bytes += phase.bytes;
+  }
+  std::snprintf(buffer, sizeof(buffer), "AK:%d LK:%d PK:%d FK:%d",
+                static_cast<int>(frame_alloc_bytes / 1024),
+                static_cast<int>(allocs.live_bytes / 1024),
+                static_cast<int>(allocs.peak_live_bytes / 1024),
+                static_cast<int>(frame.frame_bytes / 1024));
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  const FrameStats& frame_stats = GetFrameStats();
+  std::snprintf(buffer, sizeof(buffer), "FT:%.1f %.1f %.1f %.1f",
+                frame_stats.p50_ms, frame_stats.p95_ms, frame_stats.p99_ms,
+                frame_stats.max_ms);
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  const auto phase_ms = [&frame_stats](FramePhase phase) {
+    return frame_stats.last_phase_ms[static_cast<size_t>(phase)];
+  };
+  std::snprintf(buffer, sizeof(buffer), "PH:%.1f %.1f %.1f %.1f %.1f",
+                phase_ms(FramePhase::UpdatePlayer),
+                phase_ms(FramePhase::StreamChunks),
+                phase_ms(FramePhase::UpdateChunkMeshes),
+                phase_ms(FramePhase::UpdateHudMesh),
+                phase_ms(FramePhase::RenderFrame));
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  std::snprintf(buffer, sizeof(buffer), "LC:%d DC:%d PJ:%d",
+                world_stats.loaded_chunks, world_stats.dirty_chunks,
+                world_stats.pending_jobs);
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  const MemoryStats memory = GetMemoryStats();
+  const auto memory_mb = [&memory](MemoryCategory category) {
+    return static_cast<float>(
+               memory.categories[static_cast<size_t>(category)].bytes) /
+           (1024.0f * 1024.0f);
+  };
+  std::snprintf(buffer, sizeof(buffer), "MM:%.1f %.1f %.1f %.1f %.1f",
+                memory_mb(MemoryCategory::Voxels),
+                memory_mb(MemoryCategory::CpuMeshes),
+                memory_mb(MemoryCategory::GpuBuffers),
+                memory_mb(MemoryCategory::RenderState),
+                memory_mb(MemoryCategory::Caches));
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+  y += line_height;
+
+  const VertexPagePoolStats pool =
+      GetVertexPagePoolStats(renderer.meshes.vertex_pool);
+  std::snprintf(buffer, sizeof(buffer), "VP:%d %d %d %d",
+                static_cast<int>(pool.pages),
+                static_cast<int>((1.0f - pool.waste) * 100.0f + 0.5f),
+                static_cast<int>(pool.fragmentation * 100.0f + 0.5f),
+                renderer.stats.vertex_page_binds);
+  DrawText(vertices, x, y, kHudScale, buffer, white, screen_w, screen_h);
+
+  const DirectX::XMFLOAT4 graph_ok{0.3f, 0.9f, 0.3f, 0.9f};
+  const DirectX::XMFLOAT4 graph_slow{0.95f, 0.85f, 0.2f, 0.9f};
+  const DirectX::XMFLOAT4 graph_spike{1.0f, 0.3f, 0.3f, 0.9f};
+  const float graph_bottom = screen_h - kHudPadding;
+  const float graph_scale = kHudGraphHeight / kHudGraphMaxMs;
+  for (size_t age = 0; age < frame_stats.sample_count; ++age) {
+    const float sample_ms = GetFrameSample(frame_stats, age);
+    const float bar_h =
+        std::min(sample_ms, kHudGraphMaxMs) * graph_scale;
+    const float bar_x =
+        kHudPadding + static_cast<float>(kFrameHistoryLength - 1 - age);
+    const DirectX::XMFLOAT4& bar_color =
+        sample_ms <= kHudGraphBudgetMs
+            ? graph_ok
+            : (sample_ms <= kHudGraphBudgetMs * 2.0f ? graph_slow
+                                                     : graph_spike);
+    AddQuadPixels(vertices, bar_x, graph_bottom - bar_h, 1.0f, bar_h,
+                  bar_color, screen_w, screen_h);
+  }
+  AddQuadPixels(vertices, kHudPadding,
+                graph_bottom - kHudGraphBudgetMs * graph_scale,
+                static_cast<float>(kFrameHistoryLength), 1.0f, white, screen_w,
+                screen_h);
 
   return vertices;
 }
@@ -794,6 +1218,76 @@ bool IsChunkVisible(const DirectX::XMMATRIX& view_proj, const Int3& coord) {
   };
   return IsAabbVisible(view_proj, min_point, max_point);
 }
+
+void DrawMeshBuffer(RendererState& renderer, const MeshBuffer& mesh) {
+  if (mesh.range.page < 0 || mesh.vertex_count == 0) {
+    return;
+  }
+  if (mesh.range.page != renderer.bound_vertex_page) {
+    ID3D11Buffer* buffer =
+        renderer.vertex_page_buffers[static_cast<size_t>(mesh.range.page)]
+            .Get();
+    renderer.context->IASetVertexBuffers(0, 1, &buffer,
+                                         &renderer.chunk_vertex_stride,
+                                         &renderer.vertex_offset);
+    renderer.bound_vertex_page = mesh.range.page;
+    ++renderer.stats.vertex_page_binds;
+  }
+  renderer.context->Draw(mesh.vertex_count, mesh.range.offset);
+}
+
+void SetDrawOffset(RendererState& renderer, double x, double y, double z) {
+  const DirectX::XMFLOAT4 offset{static_cast<float>(x), static_cast<float>(y),
+                                 static_cast<float>(z), kBlockSize};
+  renderer.context->UpdateSubresource(renderer.chunk_offset_buffer.Get(), 0,
+                                      nullptr, &offset, 0, 0);
+}
+
+void SetChunkOffset(RendererState& renderer, const Int3& coord,
+                    const DirectX::XMFLOAT3& camera_position) {
+  const double chunk_extent = static_cast<double>(kChunkSize) * kBlockSize;
+  SetDrawOffset(renderer, coord.x * chunk_extent - camera_position.x,
+                coord.y * chunk_extent - camera_position.y,
+                coord.z * chunk_extent - camera_position.z);
+}
+
+void DrawChunkLayer(RendererState& renderer, const DirectX::XMMATRIX& view_proj,
+                    const DirectX::XMFLOAT3& camera_position,
+                    RenderLayer layer) {
+  for (const auto& entry : renderer.meshes.chunk_meshes) {
+    const MeshBuffer* mesh = GetChunkLayer(entry.second, layer);
+    if (!mesh || !IsChunkVisible(view_proj, entry.first)) {
+      continue;
+    }
+    SetChunkOffset(renderer, entry.first, camera_position);
+    DrawMeshBuffer(renderer, *mesh);
+  }
+}
+
+int GetChunkDistanceSq(const Int3& a, const Int3& b) {
+  const int dx = a.x - b.x;
+  const int dy = a.y - b.y;
+  const int dz = a.z - b.z;
+  return dx * dx + dy * dy + dz * dz;
+}
+
+void SortTransparentChunks(RendererState& renderer, const Int3& camera_chunk) {
+  renderer.transparent_order.clear();
+  for (const auto& entry : renderer.meshes.chunk_meshes) {
+    if (GetChunkLayer(entry.second, RenderLayer::Transparent)) {
+      renderer.transparent_order.push_back(entry.first);
+    }
+  }
+  std::sort(renderer.transparent_order.begin(),
+            renderer.transparent_order.end(),
+            [&](const Int3& a, const Int3& b) {
+              return GetChunkDistanceSq(a, camera_chunk) >
+                     GetChunkDistanceSq(b, camera_chunk);
+            });
+  renderer.transparent_sort_chunk = camera_chunk;
+  renderer.transparent_order_dirty = false;
+  ++renderer.stats.transparent_sorts;
+}
 }  // namespace
 
 bool InitRenderer(RendererState& renderer, HWND hwnd, UINT width, UINT height) {
@@ -824,6 +1318,7 @@ bool InitRenderer(RendererState& renderer, HWND hwnd, UINT width, UINT height) {
     return false;
   }
 
+  InitChunkMeshCache(renderer.meshes);
   if (!CreateRenderTarget(renderer)) {
     return false;
   }
@@ -855,6 +1350,9 @@ void ResizeRenderer(RendererState& renderer, UINT width, UINT height) {
   renderer.render_target.Reset();
   renderer.depth_stencil_view.Reset();
   renderer.depth_buffer.Reset();
+  TrackMemoryResize(MemoryCategory::RenderState, renderer.tracked_target_bytes,
+                    0);
+  renderer.tracked_target_bytes = 0;
   HRESULT hr = renderer.swap_chain->ResizeBuffers(0, width, height,
                                                   DXGI_FORMAT_UNKNOWN, 0);
   if (FAILED(hr)) {
@@ -864,30 +1362,20 @@ void ResizeRenderer(RendererState& renderer, UINT width, UINT height) {
   CreateRenderTarget(renderer);
 }
 
-bool UpdateChunkMeshes(RendererState& renderer, World& world) {
-  std::vector<Int3> to_remove;
-  for (const auto& entry : renderer.chunk_meshes) {
-    if (world.chunks.find(entry.first) == world.chunks.end()) {
-      to_remove.push_back(entry.first);
-    }
-  }
-  for (const Int3& coord : to_remove) {
-    renderer.chunk_meshes.erase(coord);
-  }
-
-  for (auto& entry : world.chunks) {
-    Chunk& chunk = entry.second;
-    ChunkMesh& mesh = renderer.chunk_meshes[entry.first];
-    if (!chunk.dirty && mesh.vertex_buffer) {
-      continue;
-    }
-    const std::vector<Vertex> vertices = BuildVoxelMesh(world, chunk);
-    if (!UploadChunkMesh(renderer, mesh, vertices)) {
-      return false;
-    }
-    chunk.dirty = false;
-  }
-  return true;
+bool UpdateChunkMeshes(RendererState& renderer, World& world,
+                       const DirectX::XMFLOAT3& camera_position) {
+  const ScopedFramePhase frame_phase(FramePhase::UpdateChunkMeshes);
+  const bool uploaded = UpdateChunkMeshCache(
+      renderer.meshes, world, camera_position,
+      [&renderer](const MeshBuffer& mesh,
+                  const std::vector<ChunkVertex>& vertices) {
+        return UploadChunkMesh(renderer, mesh, vertices);
+      });
+  if (renderer.meshes.transparent_changed) {
+    renderer.transparent_order_dirty = true;
+    renderer.meshes.transparent_changed = false;
+  }
+  return uploaded;
 }
 
 void UpdateSelectionMesh(RendererState& renderer, const Int3* block) {
@@ -895,18 +1383,27 @@ void UpdateSelectionMesh(RendererState& renderer, const Int3* block) {
     renderer.highlight_vertex_count = 0;
     return;
   }
-  const std::vector<Vertex> vertices = BuildSelectionMesh(*block);
+  const FrameVector<Vertex> vertices = BuildSelectionMesh(*block);
   UploadSelectionMesh(renderer, vertices);
 }
 
+void UpdateEntityMesh(RendererState& renderer, const EntityStore& entities) {
+  const FrameVector<Vertex> vertices = BuildEntityMesh(entities);
+  UploadEntityMesh(renderer, vertices);
+}
+
 bool UpdateHudMesh(RendererState& renderer, float fps,
-                   const DirectX::XMFLOAT3& position, int block_id) {
-  const std::vector<Vertex> vertices =
-      BuildHudMesh(renderer, fps, position, block_id);
+                   const DirectX::XMFLOAT3& position, int block_id,
+                   const EntityStats& entity_stats,
+                   const HudWorldStats& world_stats) {
+  const ScopedFramePhase frame_phase(FramePhase::UpdateHudMesh);
+  const FrameVector<Vertex> vertices = BuildHudMesh(
+      renderer, fps, position, block_id, entity_stats, world_stats);
   return UploadHudMesh(renderer, vertices);
 }
 void RenderFrame(RendererState& renderer, const World& world,
                  const CameraState& camera) {
+  const ScopedFramePhase frame_phase(FramePhase::RenderFrame);
   if (!renderer.context || !renderer.render_target || !renderer.swap_chain) {
     return;
   }
@@ -926,36 +1423,42 @@ void RenderFrame(RendererState& renderer, const World& world,
         D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
   }
 
-  if (renderer.vertex_shader && renderer.pixel_shader && renderer.input_layout &&
-      renderer.constant_buffer && renderer.texture_srv &&
+  if (renderer.vertex_shader && renderer.chunk_vertex_shader &&
+      renderer.pixel_shader && renderer.input_layout &&
+      renderer.chunk_input_layout && renderer.constant_buffer &&
+      renderer.chunk_offset_buffer && renderer.texture_srv &&
       renderer.sampler_state) {
     const float aspect =
         (renderer.height == 0)
             ? 1.0f
             : static_cast<float>(renderer.width) /
                   static_cast<float>(renderer.height);
-    const DirectX::XMMATRIX world_matrix = DirectX::XMMatrixIdentity();
     const DirectX::XMVECTOR eye = DirectX::XMLoadFloat3(&camera.position);
     const DirectX::XMVECTOR forward = GetCameraForward(camera);
     const DirectX::XMVECTOR up = DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
     const DirectX::XMMATRIX view = DirectX::XMMatrixLookToLH(eye, forward, up);
+    const DirectX::XMMATRIX relative_view =
+        DirectX::XMMatrixLookToLH(DirectX::XMVectorZero(), forward, up);
     const DirectX::XMMATRIX proj =
         DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f),
                                           aspect, 0.1f, 200.0f);
     const DirectX::XMMATRIX view_proj = view * proj;
     const DirectX::XMMATRIX mvp =
-        DirectX::XMMatrixTranspose(world_matrix * view * proj);
+        DirectX::XMMatrixTranspose(relative_view * proj);
     DirectX::XMFLOAT4X4 mvp_matrix;
     DirectX::XMStoreFloat4x4(&mvp_matrix, mvp);
     renderer.context->UpdateSubresource(renderer.constant_buffer.Get(), 0,
                                         nullptr, &mvp_matrix, 0, 0);
 
-    renderer.context->IASetInputLayout(renderer.input_layout.Get());
+    renderer.context->IASetInputLayout(renderer.chunk_input_layout.Get());
     renderer.context->IASetPrimitiveTopology(
         D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    renderer.context->VSSetShader(renderer.vertex_shader.Get(), nullptr, 0);
+    renderer.context->VSSetShader(renderer.chunk_vertex_shader.Get(), nullptr,
+                                  0);
     renderer.context->VSSetConstantBuffers(
         0, 1, renderer.constant_buffer.GetAddressOf());
+    renderer.context->VSSetConstantBuffers(
+        1, 1, renderer.chunk_offset_buffer.GetAddressOf());
     renderer.context->PSSetShader(renderer.pixel_shader.Get(), nullptr, 0);
     renderer.context->PSSetShaderResources(0, 1,
                                            renderer.texture_srv.GetAddressOf());
@@ -963,21 +1466,76 @@ void RenderFrame(RendererState& renderer, const World& world,
                                     renderer.sampler_state.GetAddressOf());
     renderer.context->RSSetState(renderer.rasterizer_state.Get());
 
-    for (const auto& entry : renderer.chunk_meshes) {
-      const Int3& coord = entry.first;
-      const ChunkMesh& mesh = entry.second;
-      if (!mesh.vertex_buffer || mesh.vertex_count == 0) {
+    renderer.bound_vertex_page = -1;
+    renderer.stats.vertex_page_binds = 0;
+    DrawChunkLayer(renderer, view_proj, camera.position, RenderLayer::Opaque);
+
+    const auto cutout_start = std::chrono::steady_clock::now();
+    renderer.context->PSSetShader(renderer.cutout_pixel_shader.Get(), nullptr,
+                                  0);
+    DrawChunkLayer(renderer, view_proj, camera.position, RenderLayer::Cutout);
+    const auto cutout_end = std::chrono::steady_clock::now();
+
+    SetDrawOffset(renderer, -camera.position.x, -camera.position.y,
+                  -camera.position.z);
+    if (renderer.solid_pixel_shader && renderer.entity_vertex_buffer &&
+        renderer.entity_vertex_count > 0) {
+      renderer.context->IASetInputLayout(renderer.input_layout.Get());
+      renderer.context->VSSetShader(renderer.vertex_shader.Get(), nullptr, 0);
+      renderer.context->IASetVertexBuffers(
+          0, 1, renderer.entity_vertex_buffer.GetAddressOf(),
+          &renderer.vertex_stride, &renderer.vertex_offset);
+      renderer.context->PSSetShader(renderer.solid_pixel_shader.Get(), nullptr,
+                                    0);
+      renderer.context->Draw(renderer.entity_vertex_count, 0);
+    }
+
+    const auto transparent_start = std::chrono::steady_clock::now();
+    const Int3 camera_block = WorldBlockFromPosition(camera.position);
+    const Int3 camera_chunk =
+        WorldToChunkCoord(camera_block.x, camera_block.y, camera_block.z);
+    if (renderer.transparent_order_dirty ||
+        !(camera_chunk == renderer.transparent_sort_chunk)) {
+      SortTransparentChunks(renderer, camera_chunk);
+    }
+    renderer.context->OMSetBlendState(renderer.alpha_blend_state.Get(),
+                                      nullptr, 0xFFFFFFFFu);
+    renderer.context->OMSetDepthStencilState(
+        renderer.depth_state_read_only.Get(), 0);
+    renderer.context->IASetInputLayout(renderer.chunk_input_layout.Get());
+    renderer.context->VSSetShader(renderer.chunk_vertex_shader.Get(), nullptr,
+                                  0);
+    renderer.context->PSSetShader(renderer.pixel_shader.Get(), nullptr, 0);
+    renderer.bound_vertex_page = -1;
+    int transparent_chunks = 0;
+    for (const Int3& coord : renderer.transparent_order) {
+      const auto it = renderer.meshes.chunk_meshes.find(coord);
+      if (it == renderer.meshes.chunk_meshes.end() ||
+          !IsChunkVisible(view_proj, coord)) {
         continue;
       }
-      if (!IsChunkVisible(view_proj, coord)) {
+      const MeshBuffer* mesh =
+          GetChunkLayer(it->second, RenderLayer::Transparent);
+      if (!mesh) {
         continue;
       }
-      ID3D11Buffer* buffer = mesh.vertex_buffer.Get();
-      renderer.context->IASetVertexBuffers(0, 1, &buffer,
-                                           &renderer.vertex_stride,
-                                           &renderer.vertex_offset);
-      renderer.context->Draw(mesh.vertex_count, 0);
+      SetChunkOffset(renderer, coord, camera.position);
+      DrawMeshBuffer(renderer, *mesh);
+      ++transparent_chunks;
     }
+    SetDrawOffset(renderer, -camera.position.x, -camera.position.y,
+                  -camera.position.z);
+    renderer.context->OMSetBlendState(nullptr, nullptr, 0xFFFFFFFFu);
+    renderer.context->OMSetDepthStencilState(renderer.depth_state.Get(), 0);
+    const auto transparent_end = std::chrono::steady_clock::now();
+
+    renderer.stats.transparent_chunks = transparent_chunks;
+    renderer.stats.alpha_pass_ms =
+        std::chrono::duration<float, std::milli>(cutout_end - cutout_start)
+            .count() +
+        std::chrono::duration<float, std::milli>(transparent_end -
+                                                 transparent_start)
+            .count();
   }
 
   if (renderer.wireframe_state && renderer.solid_pixel_shader &&
@@ -1003,6 +1561,9 @@ void RenderFrame(RendererState& renderer, const World& world,
     DirectX::XMStoreFloat4x4(&mvp_matrix, identity);
     renderer.context->UpdateSubresource(renderer.constant_buffer.Get(), 0,
                                         nullptr, &mvp_matrix, 0, 0);
+    if (renderer.chunk_offset_buffer) {
+      SetDrawOffset(renderer, 0.0, 0.0, 0.0);
+    }
     renderer.context->OMSetDepthStencilState(
         renderer.depth_state_no_depth.Get(), 0);
     renderer.context->IASetInputLayout(renderer.input_layout.Get());
@@ -8,10 +8,11 @@
 
 #include <DirectXMath.h>
 
-#include <unordered_map>
 #include <vector>
 
 #include "camera.h"
+#include "chunk_mesh_cache.h"
+#include "entity.h"
 #include "world.h"
 
 constexpr float kSelectionScale = 1.03f;
@@ -20,11 +21,23 @@ constexpr float kHudPadding = 12.0f;
 constexpr float kCrosshairLength = 10.0f;
 constexpr float kCrosshairGap = 6.0f;
 constexpr float kCrosshairThickness = 2.0f;
+constexpr float kHudGraphHeight = 64.0f;
+constexpr float kHudGraphMaxMs = 50.0f;
+constexpr float kHudGraphBudgetMs = 1000.0f / 60.0f;
+constexpr uint8_t kAtlasKeyColor[3] = {255, 0, 255};
+constexpr uint8_t kWaterAlpha = 170;
 
-struct ChunkMesh {
-  Microsoft::WRL::ComPtr<ID3D11Buffer> vertex_buffer;
-  UINT vertex_count = 0;
-  UINT vertex_buffer_size = 0;
+struct RendererStats {
+  int transparent_chunks = 0;
+  int transparent_sorts = 0;
+  float alpha_pass_ms = 0.0f;
+  int vertex_page_binds = 0;
+};
+
+struct HudWorldStats {
+  int loaded_chunks = 0;
+  int dirty_chunks = 0;
+  int pending_jobs = 0;
 };
 
 struct RendererState {
@@ -38,33 +51,54 @@ struct RendererState {
   Microsoft::WRL::ComPtr<ID3D11Texture2D> depth_buffer;
   Microsoft::WRL::ComPtr<ID3D11DepthStencilView> depth_stencil_view;
   Microsoft::WRL::ComPtr<ID3D11VertexShader> vertex_shader;
+  Microsoft::WRL::ComPtr<ID3D11VertexShader> chunk_vertex_shader;
   Microsoft::WRL::ComPtr<ID3D11PixelShader> pixel_shader;
   Microsoft::WRL::ComPtr<ID3D11InputLayout> input_layout;
+  Microsoft::WRL::ComPtr<ID3D11InputLayout> chunk_input_layout;
   Microsoft::WRL::ComPtr<ID3D11Buffer> constant_buffer;
+  Microsoft::WRL::ComPtr<ID3D11Buffer> chunk_offset_buffer;
   Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterizer_state;
   Microsoft::WRL::ComPtr<ID3D11PixelShader> solid_pixel_shader;
+  Microsoft::WRL::ComPtr<ID3D11PixelShader> cutout_pixel_shader;
+  Microsoft::WRL::ComPtr<ID3D11BlendState> alpha_blend_state;
   Microsoft::WRL::ComPtr<ID3D11Buffer> highlight_vertex_buffer;
   Microsoft::WRL::ComPtr<ID3D11RasterizerState> wireframe_state;
   Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depth_state;
   Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depth_state_no_depth;
+  Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depth_state_read_only;
   Microsoft::WRL::ComPtr<ID3D11Buffer> hud_vertex_buffer;
+  Microsoft::WRL::ComPtr<ID3D11Buffer> entity_vertex_buffer;
   Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> texture_srv;
   Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler_state;
   UINT vertex_stride = 0;
+  UINT chunk_vertex_stride = 0;
   UINT vertex_offset = 0;
   UINT highlight_vertex_count = 0;
   UINT highlight_vertex_buffer_size = 0;
   UINT hud_vertex_count = 0;
   UINT hud_vertex_buffer_size = 0;
-  std::unordered_map<Int3, ChunkMesh, Int3Hash> chunk_meshes;
+  UINT entity_vertex_count = 0;
+  UINT entity_vertex_buffer_size = 0;
+  ChunkMeshCache meshes;
+  std::vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> vertex_page_buffers;
+  int bound_vertex_page = -1;
+  std::vector<Int3> transparent_order;
+  Int3 transparent_sort_chunk{0, 0, 0};
+  bool transparent_order_dirty = true;
+  size_t tracked_target_bytes = 0;
+  RendererStats stats;
 };
 
 bool InitRenderer(RendererState& renderer, HWND hwnd, UINT width, UINT height);
 void ShutdownRenderer(RendererState& renderer);
 void ResizeRenderer(RendererState& renderer, UINT width, UINT height);
-bool UpdateChunkMeshes(RendererState& renderer, World& world);
+bool UpdateChunkMeshes(RendererState& renderer, World& world,
+                       const DirectX::XMFLOAT3& camera_position);
 void UpdateSelectionMesh(RendererState& renderer, const Int3* block);
+void UpdateEntityMesh(RendererState& renderer, const EntityStore& entities);
 bool UpdateHudMesh(RendererState& renderer, float fps,
-                   const DirectX::XMFLOAT3& position, int block_id);
+                   const DirectX::XMFLOAT3& position, int block_id,
+                   const EntityStats& entity_stats,
+                   const HudWorldStats& world_stats);
 void RenderFrame(RendererState& renderer, const World& world,
                  const CameraState& camera);
@@ -0,0 +1,631 @@
+#include "server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "profiler.h"
+
+namespace {
+bool QueueClientMessage(ServerState& server, ServerClient& client,
+                        MessageType type, const std::vector<uint8_t>& payload) {
+  const size_t bytes = kNetMessageHeaderSize + payload.size();
+  if (GetQueuedBytes(client.connection) + bytes > kServerMaxQueuedBytes) {
+    ++server.backlog_rejects;
+    return false;
+  }
+  QueueMessage(client.connection, static_cast<uint8_t>(type), payload.data(),
+               payload.size());
+  return true;
+}
+
+Int3 GetClientChunk(const ServerClient& client) {
+  const Int3 block = WorldBlockFromPosition(client.player.position);
+  return WorldToChunkCoord(block.x, block.y, block.z);
+}
+
+bool IsInClientView(const Int3& center, const Int3& coord) {
+  return coord.x >= center.x - kServerViewRadiusChunks &&
+         coord.x <= center.x + kServerViewRadiusChunks &&
+         coord.z >= center.z - kServerViewRadiusChunks &&
+         coord.z <= center.z + kServerViewRadiusChunks &&
+         coord.y >= kWorldMinChunkY && coord.y <= kWorldMaxChunkY;
+}
+
+const std::vector<Int3>& GetViewOffsets() {
+  static const std::vector<Int3> offsets = [] {
+    std::vector<Int3> result;
+    for (int cy = kWorldMinChunkY; cy <= kWorldMaxChunkY; ++cy) {
+      for (int dz = -kServerViewRadiusChunks; dz <= kServerViewRadiusChunks;
+           ++dz) {
+        for (int dx = -kServerViewRadiusChunks; dx <= kServerViewRadiusChunks;
+             ++dx) {
+          result.push_back({dx, cy, dz});
+        }
+      }
+    }
+    std::stable_sort(result.begin(), result.end(),
+                     [](const Int3& a, const Int3& b) {
+                       return a.x * a.x + a.z * a.z < b.x * b.x + b.z * b.z;
+                     });
+    return result;
+  }();
+  return offsets;
+}
+
+void AcceptClients(ServerState& server) {
+  for (;;) {
+    auto client = std::make_unique<ServerClient>();
+    if (!AcceptConnection(server.listener, client->connection)) {
+      return;
+    }
+    client->id = server.next_client_id++;
+    InitPlayer(client->player, kServerSpawnPosition);
+    client->camera = {GetPlayerEyePosition(client->player), 0.0f, 0.0f,
+                      kMoveSpeed, kMouseSensitivity};
+    client->input.mouse_captured = true;
+    std::printf("client %u connected\n", client->id);
+    server.clients.push_back(std::move(client));
+  }
+}
+
+void HandleClientInput(ServerClient& client, const ClientInputMessage& input) {
+  client.last_input_sequence = input.sequence;
+  client.camera.yaw = input.yaw;
+  client.camera.pitch = std::clamp(input.pitch, -kMaxPitch, kMaxPitch);
+  client.input.move_forward = std::clamp<int>(input.move_forward, -1, 1);
+  client.input.move_right = std::clamp<int>(input.move_right, -1, 1);
+  const bool jump = (input.buttons & kButtonJump) != 0;
+  client.input.jump_pressed =
+      client.input.jump_pressed || (jump && !client.input.jump_down);
+  client.input.jump_down = jump;
+  client.input.crouch_down = (input.buttons & kButtonCrouch) != 0;
+  client.input.speed_boost = (input.buttons & kButtonSprint) != 0;
+  client.input.hotbar_slot =
+      std::min<int>(input.hotbar_slot,
+                    static_cast<int>(kHotbarBlocks.size()) - 1);
+  client.pending_break =
+      client.pending_break || (input.buttons & kButtonBreak) != 0;
+  client.pending_place =
+      client.pending_place || (input.buttons & kButtonPlace) != 0;
+}
+
+void ReceiveClientMessages(ServerState& server, ServerClient& client) {
+  if (!ReceiveFromConnection(client.connection)) {
+    return;
+  }
+  NetMessageView message;
+  while (NextMessage(client.connection, message)) {
+    ByteReader reader{message.data, message.size};
+    switch (static_cast<MessageType>(message.type)) {
+      case MessageType::ClientHello: {
+        ClientHelloMessage hello;
+        if (!ReadClientHello(reader, hello) ||
+            hello.version != kProtocolVersion) {
+          CloseConnection(client.connection);
+          return;
+        }
+        server.scratch.clear();
+        WriteServerWelcome(server.scratch,
+                           {client.id, static_cast<uint32_t>(server.tick_rate)});
+        QueueClientMessage(server, client, MessageType::ServerWelcome,
+                           server.scratch);
+        client.welcomed = true;
+        break;
+      }
+      case MessageType::ClientInput: {
+        ClientInputMessage input;
+        if (ReadClientInput(reader, input)) {
+          HandleClientInput(client, input);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+bool IntersectsAnyPlayer(const ServerState& server, const Int3& block) {
+  for (const auto& client : server.clients) {
+    if (WouldIntersectBlock(client->player, block.x, block.y, block.z)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ApplyClientEdits(ServerState& server, ServerClient& client) {
+  if (!client.pending_break && !client.pending_place) {
+    return;
+  }
+  const bool break_block = client.pending_break;
+  bool place_block = client.pending_place;
+  client.pending_break = false;
+  client.pending_place = false;
+
+  DirectX::XMFLOAT3 forward{};
+  DirectX::XMStoreFloat3(&forward, GetCameraForward(client.camera));
+  const RayHit hit = RaycastVoxel(server.world, client.camera.position, forward,
+                                  kRaycastDistance);
+  if (!hit.hit) {
+    return;
+  }
+  if (place_block && IntersectsAnyPlayer(server, hit.previous)) {
+    place_block = false;
+  }
+  HandleBlockInteraction(
+      server.world, hit, break_block, place_block,
+      kHotbarBlocks[static_cast<size_t>(client.input.hotbar_slot)]);
+}
+
+void BatchChunkDeltas(ServerState& server) {
+  server.delta_batches.clear();
+  server.delta_open_slots.clear();
+  const std::vector<BlockChange>& changes = server.world.changes;
+  server.delta_slots.resize(changes.size());
+  for (size_t i = 0; i < changes.size(); ++i) {
+    const Int3 coord = WorldToChunkCoord(changes[i].block.x,
+                                         changes[i].block.y,
+                                         changes[i].block.z);
+    auto [open, inserted] =
+        server.delta_open_slots.try_emplace(coord, server.delta_batches.size());
+    if (!inserted &&
+        server.delta_batches[open->second].count >= kMaxChunkDeltaEntries) {
+      open->second = server.delta_batches.size();
+    }
+    const size_t slot = open->second;
+    if (slot == server.delta_batches.size()) {
+      server.delta_batches.push_back({coord, 0, 0, 0});
+    }
+    ++server.delta_batches[slot].count;
+    server.delta_slots[i] = slot;
+  }
+
+  size_t begin = 0;
+  for (ChunkDeltaBatch& batch : server.delta_batches) {
+    batch.begin = begin;
+    begin += batch.count;
+    batch.count = 0;
+    Chunk* chunk = FindChunk(server.world, batch.coord);
+    batch.sequence = chunk ? ++chunk->sequence : 0;
+  }
+  server.delta_changes.resize(changes.size());
+  for (size_t i = 0; i < changes.size(); ++i) {
+    ChunkDeltaBatch& batch = server.delta_batches[server.delta_slots[i]];
+    server.delta_changes[batch.begin + batch.count++] = changes[i];
+  }
+  server.world.changes.clear();
+}
+
+void AcquireChunk(ServerState& server, const Int3& coord) {
+  int& refs = server.chunk_refs[coord];
+  if (refs++ == 0) {
+    GetOrCreateChunk(server.world, coord);
+    ++server.chunks_loaded;
+  }
+}
+
+void ReleaseChunk(ServerState& server, const Int3& coord) {
+  auto it = server.chunk_refs.find(coord);
+  if (it == server.chunk_refs.end()) {
+    return;
+  }
+  if (--it->second == 0) {
+    server.chunk_refs.erase(it);
+    RemoveChunk(server.world, coord);
+    ++server.chunks_unloaded;
+  }
+}
+
+void UpdateClientInterest(ServerState& server, ServerClient& client) {
+  const Int3 center = GetClientChunk(client);
+  if (client.has_view && center == client.view_center) {
+    return;
+  }
+  const Int3 old_center = client.view_center;
+  for (const Int3& offset : GetViewOffsets()) {
+    if (client.has_view) {
+      const Int3 old{old_center.x + offset.x, offset.y, old_center.z + offset.z};
+      if (!IsInClientView(center, old)) {
+        ReleaseChunk(server, old);
+        if (client.sent_chunks.erase(old) > 0) {
+          client.pending_unloads.push_back(old);
+        }
+      }
+    }
+    const Int3 coord{center.x + offset.x, offset.y, center.z + offset.z};
+    if (!client.has_view || !IsInClientView(old_center, coord)) {
+      AcquireChunk(server, coord);
+    }
+  }
+  client.view_center = center;
+  client.has_view = true;
+  client.send_queue_dirty = true;
+}
+
+void ReleaseClientInterest(ServerState& server, ServerClient& client) {
+  if (!client.has_view) {
+    return;
+  }
+  for (const Int3& offset : GetViewOffsets()) {
+    ReleaseChunk(server, {client.view_center.x + offset.x, offset.y,
+                          client.view_center.z + offset.z});
+  }
+  client.has_view = false;
+  client.sent_chunks.clear();
+  client.send_queue.clear();
+  client.pending_unloads.clear();
+}
+
+float GetChunkSendPriority(const ServerClient& client, const Int3& coord,
+                           float forward_x, float forward_z) {
+  const float half_chunk = static_cast<float>(kChunkSize) * kBlockSize * 0.5f;
+  const float dx = static_cast<float>(coord.x * kChunkSize) * kBlockSize +
+                   half_chunk - client.player.position.x;
+  const float dz = static_cast<float>(coord.z * kChunkSize) * kBlockSize +
+                   half_chunk - client.player.position.z;
+  const float distance = std::sqrt(dx * dx + dz * dz);
+  if (distance <= half_chunk) {
+    return distance;
+  }
+  const float facing = (dx * forward_x + dz * forward_z) / distance;
+  return distance * (1.0f + kServerBehindPenalty * 0.5f * (1.0f - facing));
+}
+
+void RebuildSendQueue(ServerClient& client) {
+  client.send_queue.clear();
+  const float forward_x = std::sin(client.camera.yaw);
+  const float forward_z = std::cos(client.camera.yaw);
+  for (const Int3& offset : GetViewOffsets()) {
+    const Int3 coord{client.view_center.x + offset.x, offset.y,
+                     client.view_center.z + offset.z};
+    if (client.sent_chunks.find(coord) == client.sent_chunks.end()) {
+      client.send_queue.push_back(coord);
+    }
+  }
+  std::sort(client.send_queue.begin(), client.send_queue.end(),
+            [&](const Int3& a, const Int3& b) {
+              return GetChunkSendPriority(client, a, forward_x, forward_z) >
+                     GetChunkSendPriority(client, b, forward_x, forward_z);
+            });
+  client.send_queue_dirty = false;
+  client.send_queue_yaw = client.camera.yaw;
+}
+
+void SendClientChunks(ServerState& server, ServerClient& client,
+                      size_t budget) {
+  const bool turned = std::abs(client.camera.yaw - client.send_queue_yaw) >
+                      kServerResortYawThreshold;
+  if (client.send_queue_dirty || (turned && !client.send_queue.empty())) {
+    RebuildSendQueue(client);
+  }
+
+  size_t spent = 0;
+  while (!client.send_queue.empty() && spent < budget &&
+         GetQueuedBytes(client.connection) < kServerMaxQueuedBytes) {
+    const Int3 coord = client.send_queue.back();
+    const Chunk* chunk = FindChunk(server.world, coord);
+    if (!chunk || client.sent_chunks.find(coord) != client.sent_chunks.end()) {
+      client.send_queue.pop_back();
+      continue;
+    }
+    server.scratch.clear();
+    WriteChunkData(server.scratch, coord, chunk->sequence, chunk->voxels);
+    if (!QueueClientMessage(server, client, MessageType::ServerChunkData,
+                            server.scratch)) {
+      break;
+    }
+    client.send_queue.pop_back();
+    server.chunk_bytes_sum += server.scratch.size();
+    ++server.chunk_sends;
+    spent += server.scratch.size();
+    client.sent_chunks.insert(coord);
+  }
+}
+
+void SendClientUnloads(ServerState& server, ServerClient& client) {
+  size_t sent = 0;
+  for (; sent < client.pending_unloads.size(); ++sent) {
+    server.scratch.clear();
+    WriteChunkUnload(server.scratch, client.pending_unloads[sent]);
+    if (!QueueClientMessage(server, client, MessageType::ServerChunkUnload,
+                            server.scratch)) {
+      break;
+    }
+  }
+  client.pending_unloads.erase(
+      client.pending_unloads.begin(),
+      client.pending_unloads.begin() + static_cast<std::ptrdiff_t>(sent));
+}
+
+int GetPlayerStateInterval(const Int3& center, const Int3& coord) {
+  if (!IsInClientView(center, coord)) {
+    return 0;
+  }
+  const int distance = std::max({std::abs(coord.x - center.x),
+                                 std::abs(coord.y - center.y),
+                                 std::abs(coord.z - center.z)});
+  if (distance <= kServerPlayerNearChunks) {
+    return 1;
+  }
+  return distance <= kServerPlayerMidChunks ? kServerPlayerMidInterval
+                                            : kServerPlayerFarInterval;
+}
+
+bool QueuePlayerState(ServerState& server, ServerClient& client,
+                      const ServerClient& other) {
+  PlayerStateMessage state;
+  state.client_id = other.id;
+  state.last_input_sequence = other.last_input_sequence;
+  state.position = other.player.position;
+  state.velocity = other.player.velocity;
+  state.on_ground = other.player.on_ground;
+  state.crouching = other.player.crouching;
+  server.scratch.clear();
+  WritePlayerState(server.scratch, state);
+  return QueueClientMessage(server, client, MessageType::ServerPlayerState,
+                            server.scratch);
+}
+
+void SendClientUpdates(ServerState& server, ServerClient& client,
+                       size_t budget) {
+  const size_t start = GetQueuedBytes(client.connection);
+  for (const ChunkDeltaBatch& batch : server.delta_batches) {
+    if (batch.sequence == 0 ||
+        client.sent_chunks.find(batch.coord) == client.sent_chunks.end()) {
+      continue;
+    }
+    server.scratch.clear();
+    WriteChunkDelta(server.scratch, batch.coord, batch.sequence,
+                    server.delta_changes.data() + batch.begin, batch.count);
+    if (!QueueClientMessage(server, client, MessageType::ServerChunkDelta,
+                            server.scratch)) {
+      client.sent_chunks.erase(batch.coord);
+      client.send_queue_dirty = true;
+    }
+  }
+
+  QueuePlayerState(server, client, client);
+  const Int3 center = GetClientChunk(client);
+  const size_t count = server.clients.size();
+  int sent = 1;
+  size_t visited = 0;
+  for (; visited < count && sent < kServerMaxPlayerStatesPerTick &&
+         GetQueuedBytes(client.connection) - start < budget;
+       ++visited) {
+    const ServerClient& other =
+        *server.clients[(client.player_state_cursor + visited) % count];
+    if (&other == &client) {
+      continue;
+    }
+    const int interval = GetPlayerStateInterval(center, GetClientChunk(other));
+    if (interval > 0 && (server.tick + other.id) % interval == 0 &&
+        QueuePlayerState(server, client, other)) {
+      ++sent;
+    }
+  }
+  if (count > 0) {
+    client.player_state_cursor = (client.player_state_cursor + visited) % count;
+  }
+}
+
+float GetPercentile(const std::vector<float>& sorted, float percentile) {
+  const size_t index = static_cast<size_t>(
+      percentile * static_cast<float>(sorted.size() - 1) + 0.5f);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void UpdateServerStats(ServerState& server, float dt, float tick_ms) {
+  server.tick_times.push_back(tick_ms);
+  server.stats_timer += dt;
+  if (server.stats_timer < kServerStatsInterval) {
+    return;
+  }
+
+  uint64_t bytes_sent = 0;
+  for (auto& client : server.clients) {
+    bytes_sent +=
+        client->connection.bytes_sent - client->bytes_sent_at_window_start;
+    client->bytes_sent_at_window_start = client->connection.bytes_sent;
+  }
+  int queued_chunks = 0;
+  for (const auto& client : server.clients) {
+    queued_chunks += static_cast<int>(client->send_queue.size());
+  }
+  const int client_count = static_cast<int>(server.clients.size());
+  server.stats.client_count = client_count;
+  server.stats.loaded_chunks = static_cast<int>(server.world.chunks.size());
+  server.stats.queued_chunks = queued_chunks;
+  server.stats.chunk_memory_bytes = 0;
+  for (const auto& entry : server.world.chunks) {
+    server.stats.chunk_memory_bytes += GetChunkMemoryBytes(entry.second);
+  }
+  const ChunkPoolStats pool = GetChunkPoolStats();
+  server.stats.chunk_slabs = pool.slabs_in_use;
+  server.stats.chunk_slabs_high_water = pool.slabs_high_water;
+  std::sort(server.tick_times.begin(), server.tick_times.end());
+  float tick_ms_sum = 0.0f;
+  for (float sample : server.tick_times) {
+    tick_ms_sum += sample;
+  }
+  server.stats.tick_ms_avg =
+      tick_ms_sum / static_cast<float>(server.tick_times.size());
+  server.stats.tick_ms_p50 = GetPercentile(server.tick_times, 0.50f);
+  server.stats.tick_ms_p95 = GetPercentile(server.tick_times, 0.95f);
+  server.stats.tick_ms_p99 = GetPercentile(server.tick_times, 0.99f);
+  server.stats.tick_ms_max = server.tick_times.back();
+  server.stats.block_tick_ms =
+      server.block_tick_ms_sum / static_cast<float>(server.tick_times.size());
+  server.stats.block_tick_chunks = server.block_tick_chunks_max;
+  server.stats.fluid_ms =
+      server.fluid_ms_sum / static_cast<float>(server.tick_times.size());
+  server.stats.fluid_cells = server.fluid_cells_max;
+  server.stats.fluid_cells_per_second =
+      static_cast<float>(server.fluid_cell_updates) / server.stats_timer;
+  server.stats.chunks_loaded_per_second =
+      static_cast<float>(server.chunks_loaded) / server.stats_timer;
+  server.stats.chunks_unloaded_per_second =
+      static_cast<float>(server.chunks_unloaded) / server.stats_timer;
+  server.stats.chunk_bytes_avg =
+      (server.chunk_sends > 0)
+          ? static_cast<float>(server.chunk_bytes_sum) /
+                static_cast<float>(server.chunk_sends)
+          : 0.0f;
+  server.stats.bytes_per_client_per_second =
+      (client_count > 0)
+          ? static_cast<float>(bytes_sent) /
+                (server.stats_timer * static_cast<float>(client_count))
+          : 0.0f;
+  server.stats.backlog_rejects = server.backlog_rejects;
+  server.stats_timer = 0.0f;
+  server.tick_times.clear();
+  server.block_tick_ms_sum = 0.0f;
+  server.block_tick_chunks_max = 0;
+  server.fluid_ms_sum = 0.0f;
+  server.fluid_cells_max = 0;
+  server.fluid_cell_updates = 0;
+  server.chunks_loaded = 0;
+  server.chunks_unloaded = 0;
+  server.chunk_bytes_sum = 0;
+  server.chunk_sends = 0;
+  server.backlog_rejects = 0;
+  server.stats_ready = true;
+}
+}  // namespace
+
+void InitServer(ServerState& server) {
+  InitJobSystem(server.jobs, -1);
+  server.world.record_changes = true;
+  server.tick_times.reserve(static_cast<size_t>(
+      static_cast<float>(server.tick_rate) * kServerStatsInterval * 2.0f));
+}
+
+void ShutdownServer(ServerState& server) { ShutdownJobSystem(server.jobs); }
+
+bool StartServer(ServerState& server, uint16_t port) {
+  if (!InitNetwork()) {
+    return false;
+  }
+  if (!ListenOnPort(server.listener, port)) {
+    ShutdownNetwork();
+    return false;
+  }
+  InitServer(server);
+  return true;
+}
+
+void StopServer(ServerState& server) {
+  for (auto& client : server.clients) {
+    CloseConnection(client->connection);
+  }
+  server.clients.clear();
+  CloseListener(server.listener);
+  ShutdownNetwork();
+  ShutdownServer(server);
+}
+
+void AddSimulatedClient(ServerState& server, uint32_t seed) {
+  auto client = std::make_unique<ServerClient>();
+  client->id = server.next_client_id++;
+  client->simulated = true;
+  client->welcomed = true;
+  client->connection.open = true;
+  InitBotBrain(client->bot, seed);
+  const DirectX::XMFLOAT3 spawn{
+      kServerSpawnPosition.x +
+          (NextBotRandom(client->bot) * 2.0f - 1.0f) * kBotSpawnSpread,
+      kServerSpawnPosition.y,
+      kServerSpawnPosition.z +
+          (NextBotRandom(client->bot) * 2.0f - 1.0f) * kBotSpawnSpread};
+  InitPlayer(client->player, spawn);
+  client->camera = {GetPlayerEyePosition(client->player), 0.0f, 0.0f,
+                    kMoveSpeed, kMouseSensitivity};
+  client->input.mouse_captured = true;
+  server.clients.push_back(std::move(client));
+}
+
+void TickServer(ServerState& server, float dt) {
+  const ScopedProfile profile("TickServer");
+  const auto start = std::chrono::steady_clock::now();
+  ++server.tick;
+
+  AcceptClients(server);
+  for (auto& client : server.clients) {
+    if (client->simulated) {
+      HandleClientInput(*client, UpdateBotBrain(client->bot, dt));
+    } else {
+      ReceiveClientMessages(server, *client);
+    }
+  }
+
+  for (auto& client : server.clients) {
+    UpdateClientInterest(server, *client);
+  }
+  for (auto& client : server.clients) {
+    UpdatePlayer(client->player, server.world, client->camera, client->input,
+                 dt);
+    client->input.jump_pressed = false;
+    client->camera.position = GetPlayerEyePosition(client->player);
+  }
+  for (auto& client : server.clients) {
+    ApplyClientEdits(server, *client);
+  }
+  UpdateBlockTicks(server.block_ticks, server.world, server.jobs, dt,
+                   server.block_tick_stats);
+  server.block_tick_ms_sum += server.block_tick_stats.update_ms;
+  server.block_tick_chunks_max = std::max(
+      server.block_tick_chunks_max, server.block_tick_stats.active_chunks);
+  UpdateFluids(server.fluids, server.world, server.jobs, dt,
+               server.fluid_stats);
+  server.fluid_ms_sum += server.fluid_stats.update_ms;
+  server.fluid_cells_max =
+      std::max(server.fluid_cells_max, server.fluid_stats.active_cells);
+  server.fluid_cell_updates += server.fluid_stats.cell_updates;
+  BatchChunkDeltas(server);
+
+  for (auto& client : server.clients) {
+    if (client->welcomed) {
+      SendClientUnloads(server, *client);
+      const size_t queued = GetQueuedBytes(client->connection);
+      SendClientUpdates(server, *client,
+                        kServerClientBytesPerTick - kServerChunkReserveBytes);
+      const size_t updates = GetQueuedBytes(client->connection) - queued;
+      SendClientChunks(
+          server, *client,
+          std::max(kServerChunkReserveBytes,
+                   kServerClientBytesPerTick -
+                       std::min(updates, kServerClientBytesPerTick)));
+    }
+    if (client->simulated) {
+      DiscardQueuedBytes(client->connection);
+    } else {
+      FlushConnection(client->connection);
+    }
+  }
+
+  std::erase_if(server.clients,
+                [&](const std::unique_ptr<ServerClient>& client) {
+                  if (client->connection.open) {
+                    return false;
+                  }
+                  ReleaseClientInterest(server, *client);
+                  std::printf("client %u disconnected\n", client->id);
+                  return true;
+                });
+
+  const auto end = std::chrono::steady_clock::now();
+  UpdateServerStats(server, dt,
+                    std::chrono::duration<float, std::milli>(end - start).count());
+}
+
+bool ConsumeServerStats(ServerState& server, ServerStats& stats) {
+  if (!server.stats_ready) {
+    return false;
+  }
+  server.stats_ready = false;
+  stats = server.stats;
+  return true;
+}
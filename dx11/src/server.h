@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "block_tick.h"
+#include "bot.h"
+#include "camera.h"
+#include "fluid.h"
+#include "input.h"
+#include "job_system.h"
+#include "net.h"
+#include "player.h"
+#include "protocol.h"
+#include "world.h"
+
+constexpr int kServerTickRate = 60;
+constexpr int kServerViewRadiusChunks = kWorldRadiusChunks;
+constexpr size_t kServerClientBytesPerTick = 16 * 1024;
+constexpr size_t kServerChunkReserveBytes = 4 * 1024;
+constexpr int kServerPlayerNearChunks = 1;
+constexpr int kServerPlayerMidChunks = 3;
+constexpr int kServerPlayerMidInterval = 4;
+constexpr int kServerPlayerFarInterval = 16;
+constexpr int kServerMaxPlayerStatesPerTick = 16;
+constexpr size_t kServerMaxQueuedBytes = 256 * 1024;
+constexpr float kServerBehindPenalty = 2.0f;
+constexpr float kServerResortYawThreshold = 0.35f;
+constexpr float kServerStatsInterval = 1.0f;
+constexpr DirectX::XMFLOAT3 kServerSpawnPosition{8.0f, 4.0f, -14.0f};
+
+struct ServerClient {
+  uint32_t id = 0;
+  NetConnection connection;
+  PlayerState player;
+  CameraState camera{};
+  InputState input;
+  uint32_t last_input_sequence = 0;
+  BotBrain bot;
+  bool simulated = false;
+  bool welcomed = false;
+  bool pending_break = false;
+  bool pending_place = false;
+  Int3 view_center{0, 0, 0};
+  bool has_view = false;
+  std::unordered_set<Int3, Int3Hash> sent_chunks;
+  std::vector<Int3> send_queue;
+  std::vector<Int3> pending_unloads;
+  size_t player_state_cursor = 0;
+  bool send_queue_dirty = true;
+  float send_queue_yaw = 0.0f;
+  uint64_t bytes_sent_at_window_start = 0;
+};
+
+struct ChunkDeltaBatch {
+  Int3 coord{0, 0, 0};
+  uint32_t sequence = 0;
+  size_t begin = 0;
+  size_t count = 0;
+};
+
+struct ServerStats {
+  int client_count = 0;
+  int loaded_chunks = 0;
+  int queued_chunks = 0;
+  size_t chunk_memory_bytes = 0;
+  size_t chunk_slabs = 0;
+  size_t chunk_slabs_high_water = 0;
+  float tick_ms_avg = 0.0f;
+  float tick_ms_p50 = 0.0f;
+  float tick_ms_p95 = 0.0f;
+  float tick_ms_p99 = 0.0f;
+  float tick_ms_max = 0.0f;
+  float chunks_loaded_per_second = 0.0f;
+  float chunks_unloaded_per_second = 0.0f;
+  float block_tick_ms = 0.0f;
+  int block_tick_chunks = 0;
+  float fluid_ms = 0.0f;
+  int fluid_cells = 0;
+  float fluid_cells_per_second = 0.0f;
+  float bytes_per_client_per_second = 0.0f;
+  float chunk_bytes_avg = 0.0f;
+  int backlog_rejects = 0;
+};
+
+struct ServerState {
+  NetListener listener;
+  World world;
+  JobSystem jobs;
+  BlockTickState block_ticks;
+  BlockTickStats block_tick_stats;
+  FluidState fluids;
+  FluidStats fluid_stats;
+  std::unordered_map<Int3, int, Int3Hash> chunk_refs;
+  std::vector<std::unique_ptr<ServerClient>> clients;
+  std::vector<ChunkDeltaBatch> delta_batches;
+  std::vector<BlockChange> delta_changes;
+  std::vector<size_t> delta_slots;
+  std::unordered_map<Int3, size_t, Int3Hash> delta_open_slots;
+  std::vector<uint8_t> scratch;
+  uint32_t next_client_id = 1;
+  uint64_t tick = 0;
+  int tick_rate = kServerTickRate;
+  ServerStats stats;
+  float stats_timer = 0.0f;
+  std::vector<float> tick_times;
+  int chunks_loaded = 0;
+  int chunks_unloaded = 0;
+  float block_tick_ms_sum = 0.0f;
+  int block_tick_chunks_max = 0;
+  float fluid_ms_sum = 0.0f;
+  int fluid_cells_max = 0;
+  int fluid_cell_updates = 0;
+  uint64_t chunk_bytes_sum = 0;
+  int chunk_sends = 0;
+  int backlog_rejects = 0;
+  bool stats_ready = false;
+};
+
+void InitServer(ServerState& server);
+void ShutdownServer(ServerState& server);
+bool StartServer(ServerState& server, uint16_t port);
+void StopServer(ServerState& server);
+void AddSimulatedClient(ServerState& server, uint32_t seed);
+void TickServer(ServerState& server, float dt);
+bool ConsumeServerStats(ServerState& server, ServerStats& stats);
@@ -0,0 +1,246 @@
+#include <windows.h>
+#include <psapi.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "bot.h"
+#include "chunk_pool.h"
+#include "command_line.h"
+#include "memory_stats.h"
+#include "profiler.h"
+#include "server.h"
+
+namespace {
+std::atomic<bool> g_running{true};
+
+BOOL WINAPI HandleConsoleCtrl(DWORD) {
+  g_running = false;
+  return TRUE;
+}
+
+float GetWorkingSetMegabytes() {
+  PROCESS_MEMORY_COUNTERS counters{};
+  if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                               sizeof(counters))) {
+    return 0.0f;
+  }
+  return static_cast<float>(counters.WorkingSetSize) / (1024.0f * 1024.0f);
+}
+
+void PrintServerStats(const ServerStats& stats) {
+  std::printf(
+      "clients:%d chunks:%d queued:%d tick_avg:%.3fms tick_p99:%.3fms "
+      "tick_max:%.3fms load:%.0f/s unload:%.0f/s out:%.1fKB/s/client "
+      "chunk_avg:%.0fB chunk_mem:%.1fMB slabs:%zu/%zu "
+      "block_ticks:%d/%.3fms fluids:%d/%.3fms/%.0f/s rejects:%d "
+      "ws:%.1fMB\n",
+      stats.client_count, stats.loaded_chunks, stats.queued_chunks,
+      stats.tick_ms_avg, stats.tick_ms_p99, stats.tick_ms_max,
+      stats.chunks_loaded_per_second, stats.chunks_unloaded_per_second,
+      stats.bytes_per_client_per_second / 1024.0f, stats.chunk_bytes_avg,
+      static_cast<float>(stats.chunk_memory_bytes) / (1024.0f * 1024.0f),
+      stats.chunk_slabs, stats.chunk_slabs_high_water, stats.block_tick_chunks,
+      stats.block_tick_ms, stats.fluid_cells, stats.fluid_ms,
+      stats.fluid_cells_per_second, stats.backlog_rejects,
+      GetWorkingSetMegabytes());
+}
+
+constexpr int kBotScaleCounts[] = {1, 10, 50, 100, 250, 500, 1000};
+constexpr float kBotScaleSeconds = 10.0f;
+
+void RunBotScaling(int max_bots, int tick_rate) {
+  std::printf("%6s %9s %9s %9s %9s %9s %9s %8s %10s %9s\n", "bots",
+              "tick_p50", "tick_p95", "tick_p99", "tick_max", "load/s",
+              "unload/s", "chunks", "KB/s/bot", "ws_MB");
+  const float dt = 1.0f / static_cast<float>(tick_rate);
+  const int ticks = static_cast<int>(kBotScaleSeconds * tick_rate);
+  for (int count : kBotScaleCounts) {
+    if (count > max_bots || !g_running) {
+      break;
+    }
+    ServerState server;
+    server.tick_rate = tick_rate;
+    InitServer(server);
+    for (int i = 0; i < count; ++i) {
+      AddSimulatedClient(server, static_cast<uint32_t>(i + 1));
+    }
+    ServerStats stats;
+    for (int tick = 0; tick < ticks && g_running; ++tick) {
+      TickServer(server, dt);
+      ConsumeServerStats(server, stats);
+    }
+    std::printf("%6d %8.3fms %8.3fms %8.3fms %8.3fms %9.0f %9.0f %8d "
+                "%10.1f %9.1f\n",
+                count, stats.tick_ms_p50, stats.tick_ms_p95,
+                stats.tick_ms_p99, stats.tick_ms_max,
+                stats.chunks_loaded_per_second,
+                stats.chunks_unloaded_per_second, stats.loaded_chunks,
+                stats.bytes_per_client_per_second / 1024.0f,
+                GetWorkingSetMegabytes());
+    ShutdownServer(server);
+  }
+}
+
+int RunRemoteBots(const char* host, uint16_t port, int count, int tick_rate) {
+  if (!InitNetwork()) {
+    return 1;
+  }
+  std::vector<RemoteBot> bots(static_cast<size_t>(count));
+  for (int i = 0; i < count; ++i) {
+    if (!ConnectRemoteBot(bots[static_cast<size_t>(i)], host, port,
+                          static_cast<uint32_t>(i + 1))) {
+      std::fprintf(stderr, "bot %d failed to connect\n", i);
+    }
+  }
+  std::printf("driving %d bots against %s:%u\n", count, host, port);
+
+  const float dt = 1.0f / static_cast<float>(tick_rate);
+  const auto tick_duration = std::chrono::duration_cast<
+      std::chrono::steady_clock::duration>(std::chrono::duration<float>(dt));
+  auto next_tick = std::chrono::steady_clock::now();
+  RemoteBotStats window;
+  float window_time = 0.0f;
+  while (g_running) {
+    RemoteBotStats tick_stats;
+    for (RemoteBot& bot : bots) {
+      TickRemoteBot(bot, dt, tick_stats);
+    }
+    window.connected = tick_stats.connected;
+    window.bytes_received += tick_stats.bytes_received;
+    window.chunk_messages += tick_stats.chunk_messages;
+    window.unload_messages += tick_stats.unload_messages;
+    window.delta_messages += tick_stats.delta_messages;
+    window_time += dt;
+    if (window_time >= kServerStatsInterval) {
+      const float per_bot =
+          (window.connected > 0) ? static_cast<float>(window.connected) : 1.0f;
+      std::printf("connected:%d in:%.1fKB/s/bot chunks:%d unloads:%d "
+                  "deltas:%d\n",
+                  window.connected,
+                  static_cast<float>(window.bytes_received) /
+                      (1024.0f * window_time * per_bot),
+                  window.chunk_messages, window.unload_messages,
+                  window.delta_messages);
+      window = {};
+      window_time = 0.0f;
+    }
+
+    next_tick += tick_duration;
+    const auto now = std::chrono::steady_clock::now();
+    if (next_tick < now) {
+      next_tick = now;
+    }
+    std::this_thread::sleep_until(next_tick);
+  }
+
+  for (RemoteBot& bot : bots) {
+    CloseConnection(bot.connection);
+  }
+  ShutdownNetwork();
+  return 0;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (HasArg(argc, argv, "--large-pages")) {
+    ChunkPoolConfig pool;
+    pool.large_pages = true;
+    ConfigureChunkPool(pool);
+  }
+
+  const int port = ParseIntArg(argc, argv, "--port", kDefaultServerPort);
+  const int tick_rate =
+      ParseIntArg(argc, argv, "--tick-rate", kServerTickRate);
+  const int bots = ParseIntArg(argc, argv, "--bots", 0);
+  const int remote_bots = ParseIntArg(argc, argv, "--remote-bots", 0);
+  const int bot_scale = ParseIntArg(argc, argv, "--bot-scale", 0);
+  if (port <= 0 || port > 65535 || tick_rate <= 0 || bots < 0 ||
+      remote_bots < 0 || bot_scale < 0) {
+    std::fprintf(stderr,
+                 "usage: %s [--port N] [--tick-rate N] [--bots N] "
+                 "[--remote-bots N [--host H]] [--bot-scale N] "
+                 "[--large-pages] [--profile] [--memory-report]\n",
+                 argv[0]);
+    return 1;
+  }
+  SetConsoleCtrlHandler(HandleConsoleCtrl, TRUE);
+
+  if (bot_scale > 0) {
+    RunBotScaling(bot_scale, tick_rate);
+    return 0;
+  }
+  if (remote_bots > 0) {
+    return RunRemoteBots(ParseStringArg(argc, argv, "--host", "127.0.0.1"),
+                         static_cast<uint16_t>(port), remote_bots, tick_rate);
+  }
+
+  ServerState server;
+  server.tick_rate = tick_rate;
+  if (!StartServer(server, static_cast<uint16_t>(port))) {
+    return 1;
+  }
+  for (int i = 0; i < bots; ++i) {
+    AddSimulatedClient(server, static_cast<uint32_t>(i + 1));
+  }
+  std::printf("listening on port %d at %d ticks/s with %d bots\n", port,
+              tick_rate, bots);
+
+  SetProfilerThreadName("server");
+  SetProfilerEnabled(HasArg(argc, argv, "--profile"));
+  float trace_cooldown = kProfileSpikeCooldown;
+  int trace_count = 0;
+  const bool memory_report = HasArg(argc, argv, "--memory-report");
+  float memory_report_timer = 0.0f;
+  double run_seconds = 0.0;
+
+  const float dt = 1.0f / static_cast<float>(tick_rate);
+  const auto tick_duration = std::chrono::duration_cast<
+      std::chrono::steady_clock::duration>(std::chrono::duration<float>(dt));
+  auto next_tick = std::chrono::steady_clock::now();
+  while (g_running) {
+    const auto tick_start = std::chrono::steady_clock::now();
+    TickServer(server, dt);
+    const float tick_ms = std::chrono::duration<float, std::milli>(
+                              std::chrono::steady_clock::now() - tick_start)
+                              .count();
+    trace_cooldown = std::max(0.0f, trace_cooldown - dt);
+    if (IsProfilerEnabled() && tick_ms > kProfileSpikeMs &&
+        trace_cooldown <= 0.0f) {
+      char path[64];
+      std::snprintf(path, sizeof(path), "server_trace_spike_%d.json",
+                    trace_count++);
+      WriteChromeTrace(path);
+      trace_cooldown = kProfileSpikeCooldown;
+    }
+
+    run_seconds += dt;
+    memory_report_timer += dt;
+    if (memory_report && memory_report_timer >= kMemoryReportInterval) {
+      AppendMemoryReport("server_memory.jsonl", run_seconds);
+      memory_report_timer = 0.0f;
+    }
+
+    ServerStats stats;
+    if (ConsumeServerStats(server, stats)) {
+      PrintServerStats(stats);
+    }
+
+    next_tick += tick_duration;
+    const auto now = std::chrono::steady_clock::now();
+    if (next_tick < now) {
+      next_tick = now;
+    }
+    std::this_thread::sleep_until(next_tick);
+  }
+
+  if (IsProfilerEnabled()) {
+    WriteChromeTrace("server_trace.json");
+  }
+  StopServer(server);
+  return 0;
+}
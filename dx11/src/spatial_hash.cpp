@@ -0,0 +1,109 @@
+#include "spatial_hash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+Int3 SpatialCellFromPosition(float x, float y, float z) {
+  return WorldToChunkCoord(static_cast<int>(std::floor(x)),
+                           static_cast<int>(std::floor(y)),
+                           static_cast<int>(std::floor(z)));
+}
+
+void RebuildSpatialHash(SpatialHash& hash, const float* xs, const float* ys,
+                        const float* zs, size_t count) {
+  for (auto& entry : hash.cells) {
+    entry.second.count = 0;
+  }
+  hash.entry_cells.resize(count);
+  hash.bounds = {};
+  for (size_t i = 0; i < count; ++i) {
+    hash.bounds = i == 0 ? Aabb{xs[i], ys[i], zs[i], xs[i], ys[i], zs[i]}
+                         : Aabb{std::min(hash.bounds.min_x, xs[i]),
+                                std::min(hash.bounds.min_y, ys[i]),
+                                std::min(hash.bounds.min_z, zs[i]),
+                                std::max(hash.bounds.max_x, xs[i]),
+                                std::max(hash.bounds.max_y, ys[i]),
+                                std::max(hash.bounds.max_z, zs[i])};
+    const Int3 cell = SpatialCellFromPosition(xs[i], ys[i], zs[i]);
+    hash.entry_cells[i] = cell;
+    ++hash.cells[cell].count;
+  }
+  std::erase_if(hash.cells,
+                [](const auto& entry) { return entry.second.count == 0; });
+
+  uint32_t offset = 0;
+  for (auto& entry : hash.cells) {
+    entry.second.begin = offset;
+    offset += entry.second.count;
+    entry.second.count = 0;
+  }
+
+  hash.entries.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    SpatialCell& cell = hash.cells.find(hash.entry_cells[i])->second;
+    hash.entries[cell.begin + cell.count] = {static_cast<uint32_t>(i), xs[i],
+                                             ys[i], zs[i]};
+    ++cell.count;
+  }
+}
+
+void QuerySpatialAabb(const SpatialHash& hash, const Aabb& box,
+                      std::vector<uint32_t>& out) {
+  out.clear();
+  VisitSpatialAabb(hash, box,
+                   [&out](const SpatialEntry& entry) { out.push_back(entry.id); });
+}
+
+void QuerySpatialRadius(const SpatialHash& hash,
+                        const DirectX::XMFLOAT3& center, float radius,
+                        std::vector<uint32_t>& out) {
+  out.clear();
+  VisitSpatialRadius(hash, center, radius, [&out](const SpatialEntry& entry) {
+    out.push_back(entry.id);
+  });
+}
+
+void QuerySpatialNearest(const SpatialHash& hash,
+                         const DirectX::XMFLOAT3& center, size_t k,
+                         float max_radius, std::vector<uint32_t>& out) {
+  out.clear();
+  if (k == 0 || hash.entries.empty() || max_radius <= 0.0f) {
+    return;
+  }
+
+  const float far_x = std::max(std::abs(center.x - hash.bounds.min_x),
+                               std::abs(center.x - hash.bounds.max_x));
+  const float far_y = std::max(std::abs(center.y - hash.bounds.min_y),
+                               std::abs(center.y - hash.bounds.max_y));
+  const float far_z = std::max(std::abs(center.z - hash.bounds.min_z),
+                               std::abs(center.z - hash.bounds.max_z));
+  max_radius = std::min(
+      max_radius,
+      std::sqrt(far_x * far_x + far_y * far_y + far_z * far_z) + 1.0f);
+
+  std::vector<std::pair<float, uint32_t>> candidates;
+  float radius = std::min(static_cast<float>(kChunkSize) * 0.5f, max_radius);
+  for (;;) {
+    candidates.clear();
+    VisitSpatialRadius(hash, center, radius, [&](const SpatialEntry& entry) {
+      const float dx = entry.x - center.x;
+      const float dy = entry.y - center.y;
+      const float dz = entry.z - center.z;
+      candidates.emplace_back(dx * dx + dy * dy + dz * dz, entry.id);
+    });
+    if (candidates.size() >= k || radius >= max_radius) {
+      break;
+    }
+    radius = std::min(radius * 2.0f, max_radius);
+  }
+
+  const size_t found = std::min(k, candidates.size());
+  std::partial_sort(candidates.begin(),
+                    candidates.begin() + static_cast<std::ptrdiff_t>(found),
+                    candidates.end());
+  out.reserve(found);
+  for (size_t i = 0; i < found; ++i) {
+    out.push_back(candidates[i].second);
+  }
+}
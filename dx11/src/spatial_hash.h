@@ -0,0 +1,116 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "collision.h"
+#include "world.h"
+
+struct SpatialCell {
+  uint32_t begin = 0;
+  uint32_t count = 0;
+};
+
+struct SpatialEntry {
+  uint32_t id;
+  float x;
+  float y;
+  float z;
+};
+
+struct SpatialHash {
+  std::unordered_map<Int3, SpatialCell, Int3Hash> cells;
+  std::vector<SpatialEntry> entries;
+  std::vector<Int3> entry_cells;
+  Aabb bounds{};
+};
+
+Int3 SpatialCellFromPosition(float x, float y, float z);
+void RebuildSpatialHash(SpatialHash& hash, const float* xs, const float* ys,
+                        const float* zs, size_t count);
+
+template <typename Visitor>
+void VisitSpatialAabb(const SpatialHash& hash, const Aabb& box,
+                      Visitor&& visit) {
+  if (hash.entries.empty()) {
+    return;
+  }
+  const Aabb clamped{std::max(box.min_x, hash.bounds.min_x),
+                     std::max(box.min_y, hash.bounds.min_y),
+                     std::max(box.min_z, hash.bounds.min_z),
+                     std::min(box.max_x, hash.bounds.max_x),
+                     std::min(box.max_y, hash.bounds.max_y),
+                     std::min(box.max_z, hash.bounds.max_z)};
+  if (clamped.min_x > clamped.max_x || clamped.min_y > clamped.max_y ||
+      clamped.min_z > clamped.max_z) {
+    return;
+  }
+  const Int3 min_cell =
+      SpatialCellFromPosition(clamped.min_x, clamped.min_y, clamped.min_z);
+  const Int3 max_cell =
+      SpatialCellFromPosition(clamped.max_x, clamped.max_y, clamped.max_z);
+  const auto visit_cell = [&](const SpatialCell& cell) {
+    for (uint32_t i = cell.begin; i < cell.begin + cell.count; ++i) {
+      const SpatialEntry& entry = hash.entries[i];
+      if (entry.x >= box.min_x && entry.x <= box.max_x &&
+          entry.y >= box.min_y && entry.y <= box.max_y &&
+          entry.z >= box.min_z && entry.z <= box.max_z) {
+        visit(entry);
+      }
+    }
+  };
+  const int64_t box_cells = int64_t{max_cell.x - min_cell.x + 1} *
+                            (max_cell.y - min_cell.y + 1) *
+                            (max_cell.z - min_cell.z + 1);
+  if (box_cells > static_cast<int64_t>(hash.cells.size())) {
+    for (const auto& [coord, cell] : hash.cells) {
+      if (coord.x >= min_cell.x && coord.x <= max_cell.x &&
+          coord.y >= min_cell.y && coord.y <= max_cell.y &&
+          coord.z >= min_cell.z && coord.z <= max_cell.z) {
+        visit_cell(cell);
+      }
+    }
+    return;
+  }
+  for (int cz = min_cell.z; cz <= max_cell.z; ++cz) {
+    for (int cy = min_cell.y; cy <= max_cell.y; ++cy) {
+      for (int cx = min_cell.x; cx <= max_cell.x; ++cx) {
+        const auto it = hash.cells.find({cx, cy, cz});
+        if (it != hash.cells.end()) {
+          visit_cell(it->second);
+        }
+      }
+    }
+  }
+}
+
+template <typename Visitor>
+void VisitSpatialRadius(const SpatialHash& hash,
+                        const DirectX::XMFLOAT3& center, float radius,
+                        Visitor&& visit) {
+  const Aabb box{center.x - radius, center.y - radius, center.z - radius,
+                 center.x + radius, center.y + radius, center.z + radius};
+  const float radius_sq = radius * radius;
+  VisitSpatialAabb(hash, box, [&](const SpatialEntry& entry) {
+    const float dx = entry.x - center.x;
+    const float dy = entry.y - center.y;
+    const float dz = entry.z - center.z;
+    if (dx * dx + dy * dy + dz * dz <= radius_sq) {
+      visit(entry);
+    }
+  });
+}
+
+void QuerySpatialAabb(const SpatialHash& hash, const Aabb& box,
+                      std::vector<uint32_t>& out);
+void QuerySpatialRadius(const SpatialHash& hash,
+                        const DirectX::XMFLOAT3& center, float radius,
+                        std::vector<uint32_t>& out);
+void QuerySpatialNearest(const SpatialHash& hash,
+                         const DirectX::XMFLOAT3& center, size_t k,
+                         float max_radius, std::vector<uint32_t>& out);
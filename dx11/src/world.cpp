@@ -1,9 +1,16 @@
 #include "world.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <limits>
 #include <utility>
 
+#include "frame_stats.h"
+#include "light.h"
+#include "profiler.h"
+
 bool operator==(const Int3& lhs, const Int3& rhs) {
   return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
 }
@@ -54,16 +61,47 @@ const std::array<FaceDef, 6> kFaces = {{
      0.85f, FaceDir::NegZ},
 }};
 
-VoxelChunk::VoxelChunk() : blocks(kChunkVolume, BlockId::Air) {}
+bool IsValidBlockId(uint8_t value) { return value < kBlockIdCount; }
+
+bool IsFluidBlock(BlockId id) {
+  return id == BlockId::Water || id == BlockId::Lava;
+}
+
+bool IsSolidBlock(BlockId id) { return id != BlockId::Air && !IsFluidBlock(id); }
+
+RenderLayer GetRenderLayer(BlockId id) {
+  switch (id) {
+    case BlockId::Water:
+    case BlockId::Glass:
+      return RenderLayer::Transparent;
+    case BlockId::Leaves:
+      return RenderLayer::Cutout;
+    default:
+      return RenderLayer::Opaque;
+  }
+}
 
-BlockId VoxelChunk::Get(int x, int y, int z) const {
-  const int index = x + (y * kChunkSize) + (z * kChunkSize * kChunkSize);
-  return blocks[static_cast<size_t>(index)];
+bool IsOpaqueBlock(BlockId id) {
+  return id != BlockId::Air && GetRenderLayer(id) == RenderLayer::Opaque;
 }
 
-void VoxelChunk::Set(int x, int y, int z, BlockId id) {
-  const int index = x + (y * kChunkSize) + (z * kChunkSize * kChunkSize);
-  blocks[static_cast<size_t>(index)] = id;
+bool IsFaceVisible(BlockId id, BlockId neighbor) {
+  if (id == BlockId::Air || IsOpaqueBlock(neighbor)) {
+    return false;
+  }
+  return GetRenderLayer(id) != RenderLayer::Transparent || neighbor != id;
+}
+
+bool HasRandomTicks(BlockId id) { return id == BlockId::Grass; }
+
+int CountRandomTickBlocks(const VoxelChunk& chunk) {
+  int count = 0;
+  for (BlockId id : chunk.blocks) {
+    if (HasRandomTicks(id)) {
+      ++count;
+    }
+  }
+  return count;
 }
 
 int FloorDiv(int value, int divisor) {
@@ -84,12 +122,13 @@ int Mod(int value, int divisor) {
 }
 
 Int3 WorldToChunkCoord(int x, int y, int z) {
-  return {FloorDiv(x, kChunkSize), FloorDiv(y, kChunkSize),
-          FloorDiv(z, kChunkSize)};
+  return {ChunkDims::ChunkCoord(x), ChunkDims::ChunkCoord(y),
+          ChunkDims::ChunkCoord(z)};
 }
 
 Int3 WorldToLocalCoord(int x, int y, int z) {
-  return {Mod(x, kChunkSize), Mod(y, kChunkSize), Mod(z, kChunkSize)};
+  return {ChunkDims::LocalCoord(x), ChunkDims::LocalCoord(y),
+          ChunkDims::LocalCoord(z)};
 }
 
 Int3 WorldBlockFromPosition(const DirectX::XMFLOAT3& position) {
@@ -121,13 +160,101 @@ void MarkChunkDirty(World& world, const Int3& coord) {
   }
 }
 
-void MarkNeighborChunksDirty(World& world, const Int3& coord) {
-  MarkChunkDirty(world, {coord.x + 1, coord.y, coord.z});
-  MarkChunkDirty(world, {coord.x - 1, coord.y, coord.z});
-  MarkChunkDirty(world, {coord.x, coord.y + 1, coord.z});
-  MarkChunkDirty(world, {coord.x, coord.y - 1, coord.z});
-  MarkChunkDirty(world, {coord.x, coord.y, coord.z + 1});
-  MarkChunkDirty(world, {coord.x, coord.y, coord.z - 1});
+size_t GetNeighborSlot(int axis, int sign) {
+  return static_cast<size_t>(axis * 2 + (sign > 0 ? 0 : 1));
+}
+
+template <typename ChunkT>
+ChunkT* FollowNeighborLinks(ChunkT* chunk, const Int3& offset) {
+  const int steps[3] = {offset.x, offset.y, offset.z};
+  for (int axis = 0; axis < 3 && chunk; ++axis) {
+    if (steps[axis] != 0) {
+      chunk = chunk->neighbors[GetNeighborSlot(axis, steps[axis])];
+    }
+  }
+  return chunk;
+}
+
+Chunk* FindNearbyChunk(World& world, Chunk& chunk, const Int3& offset) {
+  if (Chunk* linked = FollowNeighborLinks(&chunk, offset)) {
+    return linked;
+  }
+  return FindChunk(world, {chunk.coord.x + offset.x, chunk.coord.y + offset.y,
+                           chunk.coord.z + offset.z});
+}
+
+const Chunk* FindNearbyChunk(const World& world, const Chunk& chunk,
+                             const Int3& offset) {
+  if (const Chunk* linked = FollowNeighborLinks(&chunk, offset)) {
+    return linked;
+  }
+  return FindChunk(world, {chunk.coord.x + offset.x, chunk.coord.y + offset.y,
+                           chunk.coord.z + offset.z});
+}
+
+BlockId GetBlockRelative(const World& world, const Chunk& chunk, int x, int y,
+                         int z) {
+  const Int3 offset{ChunkDims::ChunkCoord(x), ChunkDims::ChunkCoord(y),
+                    ChunkDims::ChunkCoord(z)};
+  const Chunk* source = &chunk;
+  if (offset.x != 0 || offset.y != 0 || offset.z != 0) {
+    source = FindNearbyChunk(world, chunk, offset);
+    if (!source) {
+      return BlockId::Air;
+    }
+  }
+  return source->voxels.Get(ChunkDims::LocalCoord(x), ChunkDims::LocalCoord(y),
+                            ChunkDims::LocalCoord(z));
+}
+
+void LinkChunkNeighbors(World& world, Chunk& chunk) {
+  for (size_t slot = 0; slot < chunk.neighbors.size(); ++slot) {
+    const Int3& step = kFaces[slot].neighbor;
+    Chunk* neighbor = FindChunk(world, {chunk.coord.x + step.x,
+                                        chunk.coord.y + step.y,
+                                        chunk.coord.z + step.z});
+    chunk.neighbors[slot] = neighbor;
+    if (neighbor) {
+      neighbor->neighbors[slot ^ 1] = &chunk;
+    }
+  }
+}
+
+void UnlinkChunkNeighbors(Chunk& chunk) {
+  for (size_t slot = 0; slot < chunk.neighbors.size(); ++slot) {
+    if (Chunk* neighbor = chunk.neighbors[slot]) {
+      neighbor->neighbors[slot ^ 1] = nullptr;
+      chunk.neighbors[slot] = nullptr;
+    }
+  }
+}
+
+void MarkNeighborChunksDirty(Chunk& chunk) {
+  for (Chunk* neighbor : chunk.neighbors) {
+    if (neighbor) {
+      neighbor->dirty = true;
+    }
+  }
+}
+
+void MarkBorderChunksDirty(World& world, Chunk& chunk, const Int3& local) {
+  const auto border_sign = [](int coord) {
+    return coord == 0 ? -1 : (coord == kChunkSize - 1 ? 1 : 0);
+  };
+  const Int3 sign{border_sign(local.x), border_sign(local.y),
+                  border_sign(local.z)};
+  for (int dz = std::min(sign.z, 0); dz <= std::max(sign.z, 0); ++dz) {
+    for (int dy = std::min(sign.y, 0); dy <= std::max(sign.y, 0); ++dy) {
+      for (int dx = std::min(sign.x, 0); dx <= std::max(sign.x, 0); ++dx) {
+        if (dx == 0 && dy == 0 && dz == 0) {
+          continue;
+        }
+        if (Chunk* neighbor = FindNearbyChunk(world, chunk, {dx, dy, dz})) {
+          neighbor->dirty = true;
+        }
+      }
+    }
+  }
 }
 
 BlockId GetBlock(const World& world, int x, int y, int z) {
@@ -147,29 +274,51 @@ bool SetBlock(World& world, int x, int y, int z, BlockId id) {
     return false;
   }
   const Int3 local = WorldToLocalCoord(x, y, z);
-  if (chunk->voxels.Get(local.x, local.y, local.z) == id) {
+  const BlockId previous = chunk->voxels.Get(local.x, local.y, local.z);
+  if (previous == id) {
     return false;
   }
+  chunk->random_tick_blocks +=
+      (HasRandomTicks(id) ? 1 : 0) - (HasRandomTicks(previous) ? 1 : 0);
+  if (chunk->random_tick_blocks > 0) {
+    AddTickChunk(world, *chunk);
+  }
   chunk->voxels.Set(local.x, local.y, local.z, id);
   chunk->dirty = true;
-  if (local.x == 0) {
-    MarkChunkDirty(world, {chunk_coord.x - 1, chunk_coord.y, chunk_coord.z});
-  } else if (local.x == kChunkSize - 1) {
-    MarkChunkDirty(world, {chunk_coord.x + 1, chunk_coord.y, chunk_coord.z});
+  if (world.record_changes) {
+    world.changes.push_back({{x, y, z}, id});
   }
-  if (local.y == 0) {
-    MarkChunkDirty(world, {chunk_coord.x, chunk_coord.y - 1, chunk_coord.z});
-  } else if (local.y == kChunkSize - 1) {
-    MarkChunkDirty(world, {chunk_coord.x, chunk_coord.y + 1, chunk_coord.z});
-  }
-  if (local.z == 0) {
-    MarkChunkDirty(world, {chunk_coord.x, chunk_coord.y, chunk_coord.z - 1});
-  } else if (local.z == kChunkSize - 1) {
-    MarkChunkDirty(world, {chunk_coord.x, chunk_coord.y, chunk_coord.z + 1});
+  MarkBorderChunksDirty(world, *chunk, local);
+  if (world.lighting) {
+    RelightBlock(world, {x, y, z}, previous, id);
   }
   return true;
 }
 
+WorldCursor::WorldCursor(const World& world_ref, const Int3& start)
+    : world(&world_ref),
+      chunk_coord(WorldToChunkCoord(start.x, start.y, start.z)) {
+  chunk = FindChunk(*world, chunk_coord);
+  Seek(start);
+}
+
+void WorldCursor::Resolve(const Int3& coord) {
+  const Int3 offset{coord.x - chunk_coord.x, coord.y - chunk_coord.y,
+                    coord.z - chunk_coord.z};
+  chunk = (chunk && std::abs(offset.x) <= 1 && std::abs(offset.y) <= 1 &&
+           std::abs(offset.z) <= 1)
+              ? FindNearbyChunk(*world, *chunk, offset)
+              : FindChunk(*world, coord);
+  chunk_coord = coord;
+}
+
+void WorldCursor::CrossBorder(int axis, int sign) {
+  (axis == 0 ? chunk_coord.x : (axis == 1 ? chunk_coord.y : chunk_coord.z)) +=
+      sign;
+  chunk = chunk ? chunk->neighbors[GetNeighborSlot(axis, sign)]
+                : FindChunk(*world, chunk_coord);
+}
+
 RayHit RaycastVoxel(const World& world, const DirectX::XMFLOAT3& origin,
                     const DirectX::XMFLOAT3& direction, float max_distance) {
   RayHit result;
@@ -192,8 +341,8 @@ RayHit RaycastVoxel(const World& world, const DirectX::XMFLOAT3& origin,
   int x = static_cast<int>(std::floor(ox));
   int y = static_cast<int>(std::floor(oy));
   int z = static_cast<int>(std::floor(oz));
-  Int3 current{x, y, z};
-  Int3 previous = current;
+  WorldCursor cursor(world, {x, y, z});
+  Int3 previous = cursor.block;
 
   const int step_x = (dx > 0.0f) ? 1 : (dx < 0.0f ? -1 : 0);
   const int step_y = (dy > 0.0f) ? 1 : (dy < 0.0f ? -1 : 0);
@@ -226,36 +375,33 @@ RayHit RaycastVoxel(const World& world, const DirectX::XMFLOAT3& origin,
     t_delta_z = 1.0f / std::abs(dz);
   }
 
-  if (GetBlock(world, current.x, current.y, current.z) != BlockId::Air) {
+  if (IsSolidBlock(cursor.Get())) {
     result.hit = true;
-    result.block = current;
-    result.previous = current;
+    result.block = cursor.block;
+    result.previous = cursor.block;
     return result;
   }
 
   float distance = 0.0f;
   while (distance <= max_distance) {
+    previous = cursor.block;
     if (t_max_x < t_max_y) {
       if (t_max_x < t_max_z) {
-        previous = current;
-        current.x += step_x;
+        cursor.Step(step_x, 0, 0);
         distance = t_max_x;
         t_max_x += t_delta_x;
       } else {
-        previous = current;
-        current.z += step_z;
+        cursor.Step(0, 0, step_z);
         distance = t_max_z;
         t_max_z += t_delta_z;
       }
     } else {
       if (t_max_y < t_max_z) {
-        previous = current;
-        current.y += step_y;
+        cursor.Step(0, step_y, 0);
         distance = t_max_y;
         t_max_y += t_delta_y;
       } else {
-        previous = current;
-        current.z += step_z;
+        cursor.Step(0, 0, step_z);
         distance = t_max_z;
         t_max_z += t_delta_z;
       }
@@ -265,9 +411,9 @@ RayHit RaycastVoxel(const World& world, const DirectX::XMFLOAT3& origin,
       break;
     }
 
-    if (GetBlock(world, current.x, current.y, current.z) != BlockId::Air) {
+    if (IsSolidBlock(cursor.Get())) {
       result.hit = true;
-      result.block = current;
+      result.block = cursor.block;
       result.previous = previous;
       return result;
     }
@@ -277,17 +423,16 @@ RayHit RaycastVoxel(const World& world, const DirectX::XMFLOAT3& origin,
 }
 
 bool HandleBlockInteraction(World& world, const RayHit& hit, bool lmb_pressed,
-                            bool rmb_pressed) {
+                            bool rmb_pressed, BlockId place_block) {
   bool changed = false;
   if (lmb_pressed) {
     changed = SetBlock(world, hit.block.x, hit.block.y, hit.block.z,
                        BlockId::Air);
   }
   if (rmb_pressed) {
-    if (GetBlock(world, hit.previous.x, hit.previous.y, hit.previous.z) ==
-        BlockId::Air) {
+    if (!IsSolidBlock(WorldCursor(world, hit.previous).Get())) {
       changed = SetBlock(world, hit.previous.x, hit.previous.y, hit.previous.z,
-                         BlockId::Dirt) ||
+                         place_block) ||
                 changed;
     }
   }
@@ -306,18 +451,66 @@ void GenerateFlatChunk(VoxelChunk& chunk) {
   }
 }
 
+void ResetChunk(Chunk& chunk) {
+  std::fill(chunk.voxels.blocks.begin(), chunk.voxels.blocks.end(),
+            BlockId::Air);
+  chunk.light.clear();
+  chunk.scheduled_ticks.clear();
+  chunk.random_tick_blocks = 0;
+  chunk.tick_slot = -1;
+  chunk.fluid_levels.clear();
+  chunk.fluid_active.clear();
+  chunk.fluid_queued = false;
+  chunk.sequence = 0;
+  chunk.dirty = true;
+}
+
+size_t GetChunkMemoryBytes(const Chunk& chunk) {
+  return sizeof(Chunk) + chunk.voxels.blocks.capacity() * sizeof(BlockId) +
+         chunk.light.capacity() + chunk.fluid_levels.capacity() +
+         chunk.scheduled_ticks.capacity() * sizeof(ScheduledTick) +
+         chunk.fluid_active.capacity() * sizeof(ChunkIndex);
+}
+
+Chunk& AcquireChunk(World& world, const Int3& coord) {
+  auto it = world.chunks.find(coord);
+  if (it != world.chunks.end()) {
+    return it->second;
+  }
+  Chunk* chunk = nullptr;
+  if (!world.spare_chunks.empty()) {
+    World::ChunkMap::node_type node = std::move(world.spare_chunks.back());
+    world.spare_chunks.pop_back();
+    node.key() = coord;
+    chunk = &world.chunks.insert(std::move(node)).position->second;
+    ++world.chunks_recycled;
+  } else {
+    chunk = &world.chunks.try_emplace(coord).first->second;
+    ++world.chunks_created;
+  }
+  chunk->coord = coord;
+  chunk->dirty = true;
+  LinkChunkNeighbors(world, *chunk);
+  return *chunk;
+}
+
 Chunk& GetOrCreateChunk(World& world, const Int3& coord) {
   auto it = world.chunks.find(coord);
   if (it != world.chunks.end()) {
     return it->second;
   }
-  Chunk chunk;
-  chunk.coord = coord;
+  const ScopedProfile profile("GenerateChunk");
+  Chunk& chunk = AcquireChunk(world, coord);
   GenerateFlatChunk(chunk.voxels);
-  chunk.dirty = true;
-  auto inserted = world.chunks.emplace(coord, std::move(chunk));
-  MarkNeighborChunksDirty(world, coord);
-  return inserted.first->second;
+  chunk.random_tick_blocks = CountRandomTickBlocks(chunk.voxels);
+  if (chunk.random_tick_blocks > 0) {
+    AddTickChunk(world, chunk);
+  }
+  MarkNeighborChunksDirty(chunk);
+  if (world.lighting) {
+    InitChunkLight(world, chunk);
+  }
+  return chunk;
 }
 
 void RemoveChunk(World& world, const Int3& coord) {
@@ -325,25 +518,47 @@ void RemoveChunk(World& world, const Int3& coord) {
   if (it == world.chunks.end()) {
     return;
   }
-  MarkNeighborChunksDirty(world, coord);
-  world.chunks.erase(it);
+  MarkNeighborChunksDirty(it->second);
+  UnlinkChunkNeighbors(it->second);
+  RemoveTickChunk(world, it->second);
+  if (world.spare_chunks.size() >= kMaxSpareChunks) {
+    world.chunks.erase(it);
+    return;
+  }
+  World::ChunkMap::node_type node = world.chunks.extract(it);
+  ResetChunk(node.mapped());
+  if (world.spare_chunks.capacity() == 0) {
+    world.spare_chunks.reserve(kMaxSpareChunks);
+  }
+  world.spare_chunks.push_back(std::move(node));
+}
+
+void AddTickChunk(World& world, Chunk& chunk) {
+  if (chunk.tick_slot >= 0) {
+    return;
+  }
+  chunk.tick_slot = static_cast<int>(world.tick_chunks.size());
+  world.tick_chunks.push_back(&chunk);
+}
+
+void RemoveTickChunk(World& world, Chunk& chunk) {
+  if (chunk.tick_slot < 0) {
+    return;
+  }
+  Chunk* last = world.tick_chunks.back();
+  world.tick_chunks[static_cast<size_t>(chunk.tick_slot)] = last;
+  last->tick_slot = chunk.tick_slot;
+  world.tick_chunks.pop_back();
+  chunk.tick_slot = -1;
 }
 
 void StreamChunks(World& world, const DirectX::XMFLOAT3& camera_position) {
+  const ScopedFramePhase frame_phase(FramePhase::StreamChunks);
   const Int3 camera_block = WorldBlockFromPosition(camera_position);
   const Int3 center =
       WorldToChunkCoord(camera_block.x, camera_block.y, camera_block.z);
 
-  for (int cy = kWorldMinChunkY; cy <= kWorldMaxChunkY; ++cy) {
-    for (int dz = -kWorldRadiusChunks; dz <= kWorldRadiusChunks; ++dz) {
-      for (int dx = -kWorldRadiusChunks; dx <= kWorldRadiusChunks; ++dx) {
-        const Int3 coord{center.x + dx, cy, center.z + dz};
-        GetOrCreateChunk(world, coord);
-      }
-    }
-  }
-
-  std::vector<Int3> to_remove;
+  FrameVector<Int3> to_remove;
   for (const auto& entry : world.chunks) {
     const Int3& coord = entry.first;
     if (coord.x < center.x - kWorldRadiusChunks ||
@@ -357,6 +572,25 @@ void StreamChunks(World& world, const DirectX::XMFLOAT3& camera_position) {
   for (const Int3& coord : to_remove) {
     RemoveChunk(world, coord);
   }
+
+  for (int cy = kWorldMinChunkY; cy <= kWorldMaxChunkY; ++cy) {
+    for (int dz = -kWorldRadiusChunks; dz <= kWorldRadiusChunks; ++dz) {
+      for (int dx = -kWorldRadiusChunks; dx <= kWorldRadiusChunks; ++dx) {
+        const Int3 coord{center.x + dx, cy, center.z + dz};
+        GetOrCreateChunk(world, coord);
+      }
+    }
+  }
+}
+
+int CountDirtyChunks(const World& world) {
+  int dirty = 0;
+  for (const auto& entry : world.chunks) {
+    if (entry.second.dirty) {
+      ++dirty;
+    }
+  }
+  return dirty;
 }
 
 DirectX::XMFLOAT4 ApplyShade(const DirectX::XMFLOAT4& color, float shade) {
@@ -377,6 +611,14 @@ int GetTileIndex(BlockId id, FaceDir dir) {
       return kTileDirt;
     case BlockId::Stone:
       return kTileStone;
+    case BlockId::Water:
+      return kTileWater;
+    case BlockId::Lava:
+      return kTileLava;
+    case BlockId::Glass:
+      return kTileGlass;
+    case BlockId::Leaves:
+      return kTileLeaves;
     case BlockId::Air:
       break;
   }
@@ -400,7 +642,7 @@ std::array<DirectX::XMFLOAT2, 4> GetTileUVs(int tile_index) {
   }};
 }
 
-void AddFace(std::vector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
+void AddFace(FrameVector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
              const FaceDef& face, const DirectX::XMFLOAT4& color,
              int tile_index) {
   constexpr int indices[6] = {0, 1, 2, 0, 2, 3};
@@ -427,7 +669,7 @@ void AddFace(std::vector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
   }
 }
 
-void AddFaceScaled(std::vector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
+void AddFaceScaled(FrameVector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
                    float scale, const FaceDef& face,
                    const DirectX::XMFLOAT4& color, int tile_index) {
   constexpr int indices[6] = {0, 1, 2, 0, 2, 3};
@@ -469,175 +711,423 @@ int AxisSign(const DirectX::XMFLOAT3& axis, int axis_index) {
   return (value >= 0.0f) ? 1 : -1;
 }
 
-void AddGreedyFace(std::vector<Vertex>& vertices, const Int3& block,
-                   const FaceDef& face, int width, int height, BlockId id) {
-  const DirectX::XMFLOAT3 axis_u =
-      Subtract(face.corners[1], face.corners[0]);
-  const DirectX::XMFLOAT3 axis_v =
-      Subtract(face.corners[3], face.corners[0]);
-  const float w = static_cast<float>(width) * kBlockSize;
-  const float h = static_cast<float>(height) * kBlockSize;
-  const DirectX::XMFLOAT3 origin{
-      (static_cast<float>(block.x) + face.corners[0].x) * kBlockSize,
-      (static_cast<float>(block.y) + face.corners[0].y) * kBlockSize,
-      (static_cast<float>(block.z) + face.corners[0].z) * kBlockSize,
+Int3 ToInt3(const DirectX::XMFLOAT3& value) {
+  return {static_cast<int>(value.x), static_cast<int>(value.y),
+          static_cast<int>(value.z)};
+}
+
+size_t GetGridIndex(const MeshGrid& grid, int x, int y, int z) {
+  return static_cast<size_t>((x + 1) + (y + 1) * grid.stride +
+                             (z + 1) * grid.stride * grid.stride);
+}
+
+BlockId GetGridBlock(const MeshGrid& grid, const Int3& cell) {
+  return grid.blocks[GetGridIndex(grid, cell.x, cell.y, cell.z)];
+}
+
+void SampleGridCell(const Chunk* chunk, const Int3& local, int scale,
+                    BlockId& id, uint8_t& light) {
+  if (!chunk) {
+    id = BlockId::Air;
+    light = kFullSkyLight;
+    return;
+  }
+  std::array<int, kBlockIdCount> tops{};
+  int columns = 0;
+  int sky = 0;
+  int block = 0;
+  for (int z = local.z; z < local.z + scale; ++z) {
+    for (int x = local.x; x < local.x + scale; ++x) {
+      bool found_top = false;
+      for (int y = local.y + scale - 1; y >= local.y; --y) {
+        const BlockId voxel = chunk->voxels.Get(x, y, z);
+        if (!found_top && voxel != BlockId::Air) {
+          ++tops[static_cast<size_t>(voxel)];
+          ++columns;
+          found_top = true;
+        }
+        const uint8_t level =
+            chunk->light.empty()
+                ? kFullSkyLight
+                : chunk->light[static_cast<size_t>(ChunkDims::Index(x, y, z))];
+        sky = std::max(sky, level >> kSkyLightShift);
+        block = std::max(block, level & kBlockLightMask);
+      }
+    }
+  }
+  id = BlockId::Air;
+  if (columns * 2 > scale * scale) {
+    int best = 0;
+    for (size_t i = 1; i < tops.size(); ++i) {
+      if (tops[i] > best) {
+        best = tops[i];
+        id = static_cast<BlockId>(i);
+      }
+    }
+  }
+  light = static_cast<uint8_t>((sky << kSkyLightShift) | block);
+}
+
+void FillMeshGrid(const World& world, const Chunk& chunk, int lod,
+                  MeshGrid& grid) {
+  lod = std::clamp(lod, 0, kMaxChunkLod);
+  grid.scale = 1 << lod;
+  grid.size = kChunkSize >> lod;
+  grid.stride = grid.size + 2;
+  const size_t cells =
+      static_cast<size_t>(grid.stride * grid.stride * grid.stride);
+  grid.blocks.resize(cells);
+  grid.light.resize(cells);
+  std::array<const Chunk*, 27> neighbors{};
+  for (int dz = -1; dz <= 1; ++dz) {
+    for (int dy = -1; dy <= 1; ++dy) {
+      for (int dx = -1; dx <= 1; ++dx) {
+        neighbors[static_cast<size_t>((dx + 1) + (dy + 1) * 3 +
+                                      (dz + 1) * 9)] =
+            FindNearbyChunk(world, chunk, {dx, dy, dz});
+      }
+    }
+  }
+  for (int z = -1; z <= grid.size; ++z) {
+    for (int y = -1; y <= grid.size; ++y) {
+      for (int x = -1; x <= grid.size; ++x) {
+        const Int3 block{x * grid.scale, y * grid.scale, z * grid.scale};
+        const Int3 offset{ChunkDims::ChunkCoord(block.x),
+                          ChunkDims::ChunkCoord(block.y),
+                          ChunkDims::ChunkCoord(block.z)};
+        const Chunk* source = neighbors[static_cast<size_t>(
+            (offset.x + 1) + (offset.y + 1) * 3 + (offset.z + 1) * 9)];
+        const size_t index = GetGridIndex(grid, x, y, z);
+        SampleGridCell(source,
+                       {ChunkDims::LocalCoord(block.x),
+                        ChunkDims::LocalCoord(block.y),
+                        ChunkDims::LocalCoord(block.z)},
+                       grid.scale, grid.blocks[index], grid.light[index]);
+      }
+    }
+  }
+}
+
+uint64_t MixMeshGrid(const MeshGrid& grid, uint64_t basis, uint64_t prime) {
+  uint64_t hash = basis ^ static_cast<uint64_t>(grid.scale);
+  const auto mix = [&](const uint8_t* data, size_t size) {
+    size_t offset = 0;
+    for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+      uint64_t word = 0;
+      std::memcpy(&word, data + offset, sizeof(word));
+      hash = (hash ^ word) * prime;
+      hash ^= hash >> 29;
+    }
+    for (; offset < size; ++offset) {
+      hash = (hash ^ data[offset]) * prime;
+    }
   };
+  mix(reinterpret_cast<const uint8_t*>(grid.blocks.data()), grid.blocks.size());
+  mix(grid.light.data(), grid.light.size());
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  return hash;
+}
 
-  const DirectX::XMFLOAT3 p0 = origin;
-  const DirectX::XMFLOAT3 p1{origin.x + axis_u.x * w, origin.y + axis_u.y * w,
-                             origin.z + axis_u.z * w};
-  const DirectX::XMFLOAT3 p2{p1.x + axis_v.x * h, p1.y + axis_v.y * h,
-                             p1.z + axis_v.z * h};
-  const DirectX::XMFLOAT3 p3{origin.x + axis_v.x * h, origin.y + axis_v.y * h,
-                             origin.z + axis_v.z * h};
-
-  const int tile_index = GetTileIndex(id, face.dir);
-  const DirectX::XMFLOAT4 base_color{1.0f, 1.0f, 1.0f, 1.0f};
-  const DirectX::XMFLOAT4 shaded = ApplyShade(base_color, face.shade);
-  const DirectX::XMFLOAT4 packed_color{shaded.x, shaded.y, shaded.z,
-                                       static_cast<float>(tile_index)};
-  const std::array<DirectX::XMFLOAT2, 4> uvs = {{
-      {0.0f, 0.0f},
-      {static_cast<float>(width), 0.0f},
-      {static_cast<float>(width), static_cast<float>(height)},
-      {0.0f, static_cast<float>(height)},
+uint64_t HashMeshGrid(const MeshGrid& grid) {
+  return MixMeshGrid(grid, 0xCBF29CE484222325ull, 0x100000001B3ull);
+}
+
+uint64_t CheckMeshGrid(const MeshGrid& grid) {
+  return MixMeshGrid(grid, 0x84222325CBF29CE4ull, 0x9E3779B97F4A7C15ull);
+}
+
+bool IsOccluder(const MeshGrid& grid, const Int3& cell, int du, int dv,
+                const Int3& axis_u, const Int3& axis_v) {
+  return IsOpaqueBlock(GetGridBlock(
+      grid, {cell.x + axis_u.x * du + axis_v.x * dv,
+             cell.y + axis_u.y * du + axis_v.y * dv,
+             cell.z + axis_u.z * du + axis_v.z * dv}));
+}
+
+uint8_t ComputeFaceAo(const MeshGrid& grid, const Int3& front,
+                      const FaceDef& face) {
+  const Int3 axis_u = ToInt3(Subtract(face.corners[1], face.corners[0]));
+  const Int3 axis_v = ToInt3(Subtract(face.corners[3], face.corners[0]));
+  constexpr int kCornerU[4] = {-1, 1, 1, -1};
+  constexpr int kCornerV[4] = {-1, -1, 1, 1};
+  uint8_t ao = 0;
+  for (int corner = 0; corner < 4; ++corner) {
+    const int du = kCornerU[corner];
+    const int dv = kCornerV[corner];
+    const bool side_u = IsOccluder(grid, front, du, 0, axis_u, axis_v);
+    const bool side_v = IsOccluder(grid, front, 0, dv, axis_u, axis_v);
+    const bool diagonal = IsOccluder(grid, front, du, dv, axis_u, axis_v);
+    const int level =
+        (side_u && side_v) ? 0 : 3 - (side_u ? 1 : 0) - (side_v ? 1 : 0) -
+                                     (diagonal ? 1 : 0);
+    ao |= static_cast<uint8_t>(level << (corner * 2));
+  }
+  return ao;
+}
+
+int GetCornerAo(uint8_t ao, int corner) { return (ao >> (corner * 2)) & 3; }
+
+uint8_t PackShade(float shade) {
+  return static_cast<uint8_t>(std::clamp(shade, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+void AddGreedyFace(std::vector<ChunkVertex>& vertices, const Int3& block,
+                   const FaceDef& face, int width, int height, int scale,
+                   BlockId id, uint8_t light, uint8_t ao) {
+  const Int3 axis_u = ToInt3(Subtract(face.corners[1], face.corners[0]));
+  const Int3 axis_v = ToInt3(Subtract(face.corners[3], face.corners[0]));
+  const Int3 corner = ToInt3(face.corners[0]);
+  const int w = width * scale;
+  const int h = height * scale;
+  const Int3 p0{block.x + corner.x * scale, block.y + corner.y * scale,
+                block.z + corner.z * scale};
+  const Int3 p1{p0.x + axis_u.x * w, p0.y + axis_u.y * w, p0.z + axis_u.z * w};
+  const Int3 p2{p1.x + axis_v.x * h, p1.y + axis_v.y * h, p1.z + axis_v.z * h};
+  const Int3 p3{p0.x + axis_v.x * h, p0.y + axis_v.y * h, p0.z + axis_v.z * h};
+
+  const uint8_t tile_index = static_cast<uint8_t>(GetTileIndex(id, face.dir));
+  const float shade = face.shade * GetLightBrightness(light);
+  std::array<uint8_t, 4> shades{};
+  for (int corner_index = 0; corner_index < 4; ++corner_index) {
+    shades[static_cast<size_t>(corner_index)] = PackShade(
+        shade * kAmbientOcclusionLevels[static_cast<size_t>(
+                    GetCornerAo(ao, corner_index))]);
+  }
+  const uint8_t tiles_u = static_cast<uint8_t>(w);
+  const uint8_t tiles_v = static_cast<uint8_t>(h);
+  const std::array<std::array<uint8_t, 2>, 4> uvs = {{
+      {0, 0},
+      {tiles_u, 0},
+      {tiles_u, tiles_v},
+      {0, tiles_v},
   }};
-  const DirectX::XMFLOAT3 positions[4] = {p0, p1, p2, p3};
+  const Int3 positions[4] = {p0, p1, p2, p3};
   constexpr int indices[6] = {0, 1, 2, 0, 2, 3};
+  constexpr int flipped_indices[6] = {1, 2, 3, 1, 3, 0};
+  const bool flip = GetCornerAo(ao, 0) + GetCornerAo(ao, 2) <
+                    GetCornerAo(ao, 1) + GetCornerAo(ao, 3);
   for (int i = 0; i < 6; ++i) {
-    const int idx = indices[i];
-    Vertex vertex;
-    vertex.position = positions[idx];
-    vertex.color = packed_color;
-    vertex.uv = uvs[static_cast<size_t>(idx)];
+    const int idx = flip ? flipped_indices[i] : indices[i];
+    const Int3& position = positions[idx];
+    const uint8_t shade_byte = shades[static_cast<size_t>(idx)];
+    ChunkVertex vertex;
+    vertex.position = {static_cast<uint8_t>(position.x),
+                       static_cast<uint8_t>(position.y),
+                       static_cast<uint8_t>(position.z), tile_index};
+    vertex.color = {shade_byte, shade_byte, shade_byte, 255};
+    vertex.uv = {uvs[static_cast<size_t>(idx)][0],
+                 uvs[static_cast<size_t>(idx)][1], 0, 0};
     vertices.push_back(vertex);
   }
 }
 
-std::vector<Vertex> BuildVoxelMesh(const World& world, const Chunk& chunk) {
-  std::vector<Vertex> vertices;
-  vertices.reserve(static_cast<size_t>(kChunkVolume) * 36u);
-  const int base_x = chunk.coord.x * kChunkSize;
-  const int base_y = chunk.coord.y * kChunkSize;
-  const int base_z = chunk.coord.z * kChunkSize;
-  const int dims[3] = {kChunkSize, kChunkSize, kChunkSize};
+struct FaceMaskCell {
+  BlockId id = BlockId::Air;
+  uint8_t light = 0;
+  uint8_t ao = kAmbientOcclusionNone;
+  bool visible = false;
+};
 
-  struct MaskCell {
-    BlockId id = BlockId::Air;
-    FaceDir dir = FaceDir::PosX;
-    bool visible = false;
-  };
+bool MatchesMaskCell(const FaceMaskCell& cell, const FaceMaskCell& next) {
+  return next.visible && next.id == cell.id && next.light == cell.light &&
+         next.ao == cell.ao;
+}
+
+template <int N>
+using FaceMask = std::array<FaceMaskCell, static_cast<size_t>(N * N)>;
+
+template <int N>
+void EmitMaskQuads(ChunkMeshData& mesh, FaceMask<N>& mask, int scale,
+                   FaceDir dir, int d, int slice) {
+  constexpr int n = N;
+  const int u = (d + 1) % 3;
+  const int v = (d + 2) % 3;
+  const FaceDef& face = GetFaceDef(dir);
+  const DirectX::XMFLOAT3 axis_u = Subtract(face.corners[1], face.corners[0]);
+  const DirectX::XMFLOAT3 axis_v = Subtract(face.corners[3], face.corners[0]);
+  const bool positive =
+      dir == FaceDir::PosX || dir == FaceDir::PosY || dir == FaceDir::PosZ;
+
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < n;) {
+      const FaceMaskCell cell = mask[static_cast<size_t>(i + j * n)];
+      if (!cell.visible) {
+        ++i;
+        continue;
+      }
+
+      int width = 1;
+      while (i + width < n &&
+             MatchesMaskCell(cell, mask[static_cast<size_t>(i + width +
+                                                            j * n)])) {
+        ++width;
+      }
+
+      int height = 1;
+      bool done = false;
+      while (j + height < n && !done) {
+        for (int k = 0; k < width; ++k) {
+          if (!MatchesMaskCell(cell, mask[static_cast<size_t>(
+                                         i + k + (j + height) * n)])) {
+            done = true;
+            break;
+          }
+        }
+        if (!done) {
+          ++height;
+        }
+      }
+
+      int block_coords[3] = {0, 0, 0};
+      block_coords[d] = positive ? (slice - 1) : slice;
+      block_coords[u] = i;
+      block_coords[v] = j;
+      if (AxisSign(axis_u, u) < 0) {
+        block_coords[u] += width - 1;
+      }
+      if (AxisSign(axis_v, v) < 0) {
+        block_coords[v] += height - 1;
+      }
+
+      const Int3 block{block_coords[0] * scale, block_coords[1] * scale,
+                       block_coords[2] * scale};
+      AddGreedyFace(
+          mesh.layers[static_cast<size_t>(GetRenderLayer(cell.id))], block,
+          face, width, height, scale, cell.id, cell.light, cell.ao);
+
+      for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+          mask[static_cast<size_t>(i + x + (j + y) * n)].visible = false;
+        }
+      }
+      i += width;
+    }
+  }
+}
+
+bool IsSkirtFace(const MeshGrid& grid, BlockId id, const Int3& cell) {
+  return id != BlockId::Air &&
+         IsFaceVisible(id, GetGridBlock(grid, {cell.x, cell.y + 1, cell.z}));
+}
+
+int SelectChunkLod(const Int3& coord, const Int3& camera_chunk) {
+  const int distance = std::max(std::abs(coord.x - camera_chunk.x),
+                                std::abs(coord.z - camera_chunk.z));
+  int lod = 0;
+  while (lod < kMaxChunkLod &&
+         distance >= kChunkLodDistances[static_cast<size_t>(lod)]) {
+    ++lod;
+  }
+  return lod;
+}
+
+template <int N>
+void BuildVoxelMeshN(const MeshGrid& grid, bool ambient_occlusion,
+                     ChunkMeshData& mesh) {
+  constexpr int n = N;
+  constexpr int stride = N + 2;
+  constexpr FaceDir kPositiveDirs[3] = {FaceDir::PosX, FaceDir::PosY,
+                                        FaceDir::PosZ};
+  constexpr FaceDir kNegativeDirs[3] = {FaceDir::NegX, FaceDir::NegY,
+                                        FaceDir::NegZ};
+  FaceMask<N> positive_mask;
+  FaceMask<N> negative_mask;
 
   for (int d = 0; d < 3; ++d) {
     const int u = (d + 1) % 3;
     const int v = (d + 2) % 3;
-    const int du = dims[u];
-    const int dv = dims[v];
-    std::vector<MaskCell> mask(static_cast<size_t>(du * dv));
+    const FaceDef& positive_face = GetFaceDef(kPositiveDirs[d]);
+    const FaceDef& negative_face = GetFaceDef(kNegativeDirs[d]);
+    const bool skirts = grid.scale > 1 && d != 1;
 
-    for (int slice = 0; slice <= dims[d]; ++slice) {
-      for (int j = 0; j < dv; ++j) {
-        for (int i = 0; i < du; ++i) {
+    for (int slice = 0; slice <= n; ++slice) {
+      for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
           int coords[3] = {0, 0, 0};
           coords[d] = slice;
           coords[u] = i;
           coords[v] = j;
-          const int wx = base_x + coords[0];
-          const int wy = base_y + coords[1];
-          const int wz = base_z + coords[2];
-
-          const int wx_a = wx - (d == 0 ? 1 : 0);
-          const int wy_a = wy - (d == 1 ? 1 : 0);
-          const int wz_a = wz - (d == 2 ? 1 : 0);
-
-          const BlockId a = GetBlock(world, wx_a, wy_a, wz_a);
-          const BlockId b = GetBlock(world, wx, wy, wz);
-          MaskCell cell{};
-          if (a != BlockId::Air && b == BlockId::Air) {
-            cell.visible = true;
-            cell.id = a;
-            cell.dir = (d == 0) ? FaceDir::PosX
-                                : (d == 1 ? FaceDir::PosY : FaceDir::PosZ);
-          } else if (a == BlockId::Air && b != BlockId::Air) {
-            cell.visible = true;
-            cell.id = b;
-            cell.dir = (d == 0) ? FaceDir::NegX
-                                : (d == 1 ? FaceDir::NegY : FaceDir::NegZ);
-          }
-          mask[static_cast<size_t>(i + j * du)] = cell;
-        }
-      }
-
-      for (int j = 0; j < dv; ++j) {
-        for (int i = 0; i < du;) {
-          MaskCell cell = mask[static_cast<size_t>(i + j * du)];
-          if (!cell.visible) {
-            ++i;
-            continue;
-          }
+          const Int3 b_cell{coords[0], coords[1], coords[2]};
+          const Int3 a_cell{b_cell.x - (d == 0 ? 1 : 0),
+                            b_cell.y - (d == 1 ? 1 : 0),
+                            b_cell.z - (d == 2 ? 1 : 0)};
+          const size_t b_index = static_cast<size_t>(
+              (b_cell.x + 1) + (b_cell.y + 1) * stride +
+              (b_cell.z + 1) * stride * stride);
+          const size_t a_index =
+              b_index - static_cast<size_t>(d == 0   ? 1
+                                            : d == 1 ? stride
+                                                     : stride * stride);
+          const BlockId a = grid.blocks[a_index];
+          const BlockId b = grid.blocks[b_index];
+          const size_t index = static_cast<size_t>(i + j * n);
 
-          int width = 1;
-          while (i + width < du) {
-            const MaskCell& next = mask[static_cast<size_t>(i + width + j * du)];
-            if (!next.visible || next.id != cell.id || next.dir != cell.dir) {
-              break;
+          FaceMaskCell positive{};
+          if (slice > 0 &&
+              (IsFaceVisible(a, b) ||
+               (skirts && slice == n && IsSkirtFace(grid, a, a_cell)))) {
+            positive.visible = true;
+            positive.id = a;
+            positive.light = grid.light[b_index];
+            if (ambient_occlusion) {
+              positive.ao = ComputeFaceAo(grid, b_cell, positive_face);
             }
-            ++width;
-          }
-
-          int height = 1;
-          bool done = false;
-          while (j + height < dv && !done) {
-            for (int k = 0; k < width; ++k) {
-              const MaskCell& next =
-                  mask[static_cast<size_t>(i + k + (j + height) * du)];
-              if (!next.visible || next.id != cell.id || next.dir != cell.dir) {
-                done = true;
-                break;
-              }
-            }
-            if (!done) {
-              ++height;
-            }
-          }
-
-          const FaceDef& face = GetFaceDef(cell.dir);
-          const DirectX::XMFLOAT3 axis_u =
-              Subtract(face.corners[1], face.corners[0]);
-          const DirectX::XMFLOAT3 axis_v =
-              Subtract(face.corners[3], face.corners[0]);
-          int block_coords[3] = {0, 0, 0};
-          block_coords[d] =
-              (cell.dir == FaceDir::PosX || cell.dir == FaceDir::PosY ||
-               cell.dir == FaceDir::PosZ)
-                  ? (slice - 1)
-                  : slice;
-          block_coords[u] = i;
-          block_coords[v] = j;
-
-          if (AxisSign(axis_u, u) < 0) {
-            block_coords[u] += width - 1;
           }
-          if (AxisSign(axis_v, v) < 0) {
-            block_coords[v] += height - 1;
-          }
-
-          const Int3 block{
-              base_x + block_coords[0],
-              base_y + block_coords[1],
-              base_z + block_coords[2],
-          };
-          AddGreedyFace(vertices, block, face, width, height, cell.id);
+          positive_mask[index] = positive;
 
-          for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-              mask[static_cast<size_t>(i + x + (j + y) * du)].visible = false;
+          FaceMaskCell negative{};
+          if (slice < n &&
+              (IsFaceVisible(b, a) ||
+               (skirts && slice == 0 && IsSkirtFace(grid, b, b_cell)))) {
+            negative.visible = true;
+            negative.id = b;
+            negative.light = grid.light[a_index];
+            if (ambient_occlusion) {
+              negative.ao = ComputeFaceAo(grid, a_cell, negative_face);
             }
           }
-          i += width;
+          negative_mask[index] = negative;
         }
       }
+
+      EmitMaskQuads<N>(mesh, positive_mask, grid.scale, kPositiveDirs[d], d,
+                       slice);
+      EmitMaskQuads<N>(mesh, negative_mask, grid.scale, kNegativeDirs[d], d,
+                       slice);
     }
   }
-  return vertices;
+}
+
+template <int N>
+bool DispatchVoxelMesh(const MeshGrid& grid, bool ambient_occlusion,
+                       ChunkMeshData& mesh) {
+  if (grid.size == N && grid.stride == N + 2) {
+    BuildVoxelMeshN<N>(grid, ambient_occlusion, mesh);
+    return true;
+  }
+  if constexpr (N > (kChunkSize >> kMaxChunkLod)) {
+    return DispatchVoxelMesh<N / 2>(grid, ambient_occlusion, mesh);
+  }
+  return false;
+}
+
+void BuildVoxelMesh(const MeshGrid& grid, bool ambient_occlusion,
+                    ChunkMeshData& mesh) {
+  for (std::vector<ChunkVertex>& vertices : mesh.layers) {
+    vertices.clear();
+  }
+  DispatchVoxelMesh<kChunkSize>(grid, ambient_occlusion, mesh);
+}
+
+void ReserveMeshScratch(MeshGrid& grid, ChunkMeshData& mesh) {
+  const size_t cells = static_cast<size_t>(kChunkSize + 2) *
+                       static_cast<size_t>(kChunkSize + 2) *
+                       static_cast<size_t>(kChunkSize + 2);
+  grid.blocks.reserve(cells);
+  grid.light.reserve(cells);
+  for (std::vector<ChunkVertex>& vertices : mesh.layers) {
+    vertices.reserve(kMeshScratchLayerVertices);
+  }
 }
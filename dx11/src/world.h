@@ -5,23 +5,133 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
-constexpr int kChunkSize = 16;
-constexpr int kChunkVolume = kChunkSize * kChunkSize * kChunkSize;
+#include "chunk_pool.h"
+#include "frame_arena.h"
+
+#ifndef MINECRAFT_CHUNK_SHIFT
+#define MINECRAFT_CHUNK_SHIFT 4
+#endif
+
+#ifndef MINECRAFT_CHUNK_MORTON
+#define MINECRAFT_CHUNK_MORTON 0
+#endif
+
+enum class ChunkLayout : uint8_t {
+  Linear = 0,
+  Morton = 1,
+};
+
+template <int Shift, ChunkLayout Layout = ChunkLayout::Linear>
+struct ChunkShape {
+  static_assert(Shift >= 4 && Shift <= 6, "chunk edge must be 16, 32 or 64");
+  static constexpr int kShift = Shift;
+  static constexpr int kSize = 1 << Shift;
+  static constexpr int kMask = kSize - 1;
+  static constexpr int kVolume = kSize * kSize * kSize;
+  static constexpr ChunkLayout kLayout = Layout;
+
+  static constexpr uint32_t SpreadBits(uint32_t value) {
+    value &= 0x3FFu;
+    value = (value | (value << 16)) & 0xFF0000FFu;
+    value = (value | (value << 8)) & 0x0300F00Fu;
+    value = (value | (value << 4)) & 0x030C30C3u;
+    value = (value | (value << 2)) & 0x09249249u;
+    return value;
+  }
+  static constexpr uint32_t CompactBits(uint32_t value) {
+    value &= 0x09249249u;
+    value = (value ^ (value >> 2)) & 0x030C30C3u;
+    value = (value ^ (value >> 4)) & 0x0300F00Fu;
+    value = (value ^ (value >> 8)) & 0xFF0000FFu;
+    value = (value ^ (value >> 16)) & 0x000003FFu;
+    return value;
+  }
+  static constexpr uint32_t AxisMask(int axis) {
+    if constexpr (Layout == ChunkLayout::Morton) {
+      return SpreadBits(kMask) << axis;
+    } else {
+      return static_cast<uint32_t>(kMask) << (axis * Shift);
+    }
+  }
+
+  static constexpr int Index(int x, int y, int z) {
+    if constexpr (Layout == ChunkLayout::Morton) {
+      return static_cast<int>(SpreadBits(static_cast<uint32_t>(x)) |
+                              (SpreadBits(static_cast<uint32_t>(y)) << 1) |
+                              (SpreadBits(static_cast<uint32_t>(z)) << 2));
+    } else {
+      return x | (y << Shift) | (z << (Shift * 2));
+    }
+  }
+  static constexpr int Local(int index, int axis) {
+    if constexpr (Layout == ChunkLayout::Morton) {
+      return static_cast<int>(CompactBits(static_cast<uint32_t>(index) >> axis));
+    } else {
+      return (index >> (axis * Shift)) & kMask;
+    }
+  }
+  static constexpr int ChunkCoord(int block) { return block >> Shift; }
+  static constexpr int LocalCoord(int block) { return block & kMask; }
+
+  static constexpr bool AtMin(int index, int axis) {
+    return (static_cast<uint32_t>(index) & AxisMask(axis)) == 0;
+  }
+  static constexpr bool AtMax(int index, int axis) {
+    return (static_cast<uint32_t>(index) & AxisMask(axis)) == AxisMask(axis);
+  }
+  static constexpr int Next(int index, int axis) {
+    const uint32_t mask = AxisMask(axis);
+    const uint32_t value = static_cast<uint32_t>(index);
+    return static_cast<int>((value & ~mask) | (((value | ~mask) + 1) & mask));
+  }
+  static constexpr int Prev(int index, int axis) {
+    const uint32_t mask = AxisMask(axis);
+    const uint32_t value = static_cast<uint32_t>(index);
+    return static_cast<int>((value & ~mask) | (((value & mask) - 1) & mask));
+  }
+  static constexpr int Step(int index, int axis, int sign) {
+    return sign > 0 ? Next(index, axis) : Prev(index, axis);
+  }
+  static constexpr bool CrossesBorder(int index, int axis, int sign) {
+    return sign > 0 ? AtMax(index, axis) : AtMin(index, axis);
+  }
+};
+
+constexpr ChunkLayout kChunkLayout =
+    MINECRAFT_CHUNK_MORTON ? ChunkLayout::Morton : ChunkLayout::Linear;
+using ChunkDims = ChunkShape<MINECRAFT_CHUNK_SHIFT, kChunkLayout>;
+constexpr int kChunkShift = ChunkDims::kShift;
+constexpr int kChunkSize = ChunkDims::kSize;
+constexpr int kChunkMask = ChunkDims::kMask;
+constexpr int kChunkVolume = ChunkDims::kVolume;
+using ChunkIndex =
+    std::conditional_t<(kChunkVolume <= 0x10000), uint16_t, uint32_t>;
 constexpr int kGroundHeight = 2;
 constexpr float kBlockSize = 1.0f;
-constexpr int kAtlasTilesX = 4;
+constexpr int kAtlasTilesX = 8;
 constexpr int kAtlasTilesY = 1;
 constexpr int kTileGrassTop = 0;
 constexpr int kTileGrassSide = 1;
 constexpr int kTileDirt = 2;
 constexpr int kTileStone = 3;
+constexpr int kTileWater = 4;
+constexpr int kTileLava = 5;
+constexpr int kTileGlass = 6;
+constexpr int kTileLeaves = 7;
+constexpr uint8_t kAmbientOcclusionNone = 0xFF;
+constexpr std::array<float, 4> kAmbientOcclusionLevels = {0.5f, 0.68f, 0.84f,
+                                                          1.0f};
 constexpr float kRaycastDistance = 8.0f;
 constexpr int kWorldRadiusChunks = 3;
 constexpr int kWorldMinChunkY = 0;
 constexpr int kWorldMaxChunkY = 0;
+constexpr int kMaxChunkLod = 3;
+constexpr std::array<int, kMaxChunkLod> kChunkLodDistances = {3, 6, 12};
+constexpr int kMeshScratchLayerVertices = kChunkVolume * 2;
 
 struct Vertex {
   DirectX::XMFLOAT3 position;
@@ -29,13 +139,42 @@ struct Vertex {
   DirectX::XMFLOAT2 uv;
 };
 
+struct ChunkVertex {
+  std::array<uint8_t, 4> position;
+  std::array<uint8_t, 4> color;
+  std::array<uint8_t, 4> uv;
+};
+
+static_assert(sizeof(ChunkVertex) == 12);
+
+constexpr uint32_t kVertexPageBytes = 8 * 1024 * 1024;
+constexpr uint32_t kVertexPageVertices = kVertexPageBytes / sizeof(ChunkVertex);
+constexpr uint32_t kVertexPageGranule = 48;
+
 enum class BlockId : uint8_t {
   Air = 0,
   Grass = 1,
   Dirt = 2,
   Stone = 3,
+  Water = 4,
+  Lava = 5,
+  Glass = 6,
+  Leaves = 7,
+};
+
+constexpr int kBlockIdCount = 8;
+constexpr std::array<BlockId, 7> kHotbarBlocks = {
+    BlockId::Dirt,  BlockId::Stone, BlockId::Grass, BlockId::Water,
+    BlockId::Lava,  BlockId::Glass, BlockId::Leaves};
+
+enum class RenderLayer : uint8_t {
+  Opaque = 0,
+  Cutout = 1,
+  Transparent = 2,
 };
 
+constexpr int kRenderLayerCount = 3;
+
 struct Int3 {
   int x;
   int y;
@@ -67,22 +206,146 @@ struct FaceDef {
 
 extern const std::array<FaceDef, 6> kFaces;
 
-struct VoxelChunk {
-  std::vector<BlockId> blocks;
+template <typename T>
+using ChunkBuffer = std::vector<T, ChunkSlabAllocator<T>>;
+
+template <int Shift, ChunkLayout Layout>
+struct BasicVoxelChunk {
+  using Shape = ChunkShape<Shift, Layout>;
+
+  ChunkBuffer<BlockId> blocks;
+
+  BasicVoxelChunk() : blocks(Shape::kVolume, BlockId::Air) {}
+  BlockId Get(int x, int y, int z) const {
+    return blocks[static_cast<size_t>(Shape::Index(x, y, z))];
+  }
+  void Set(int x, int y, int z, BlockId id) {
+    blocks[static_cast<size_t>(Shape::Index(x, y, z))] = id;
+  }
+};
+
+using VoxelChunk = BasicVoxelChunk<kChunkShift, kChunkLayout>;
 
-  VoxelChunk();
-  BlockId Get(int x, int y, int z) const;
-  void Set(int x, int y, int z, BlockId id);
+struct ScheduledTick {
+  uint64_t time = 0;
+  uint32_t order = 0;
+  ChunkIndex index = 0;
 };
 
+constexpr int kChunkNeighborCount = 6;
+
 struct Chunk {
   Int3 coord{0, 0, 0};
+  std::array<Chunk*, kChunkNeighborCount> neighbors{};
   VoxelChunk voxels;
+  ChunkBuffer<uint8_t> light;
+  std::vector<ScheduledTick> scheduled_ticks;
+  int random_tick_blocks = 0;
+  int tick_slot = -1;
+  ChunkBuffer<uint8_t> fluid_levels;
+  std::vector<ChunkIndex> fluid_active;
+  bool fluid_queued = false;
+  uint32_t sequence = 0;
   bool dirty = true;
 };
 
+struct BlockChange {
+  Int3 block{0, 0, 0};
+  BlockId id = BlockId::Air;
+};
+
+struct LightNode {
+  Chunk* chunk = nullptr;
+  ChunkIndex index = 0;
+  uint8_t level = 0;
+};
+
+struct LightQueues {
+  std::vector<LightNode> add;
+  std::vector<LightNode> remove;
+};
+
+constexpr size_t kMaxSpareChunks = 64;
+
 struct World {
-  std::unordered_map<Int3, Chunk, Int3Hash> chunks;
+  using ChunkMap = std::unordered_map<Int3, Chunk, Int3Hash>;
+
+  ChunkMap chunks;
+  std::vector<ChunkMap::node_type> spare_chunks;
+  uint64_t chunks_created = 0;
+  uint64_t chunks_recycled = 0;
+  std::vector<BlockChange> changes;
+  std::vector<Chunk*> tick_chunks;
+  LightQueues light_queues;
+  bool record_changes = false;
+  bool lighting = false;
+};
+
+struct MeshGrid {
+  int size = kChunkSize;
+  int scale = 1;
+  int stride = kChunkSize + 2;
+  std::vector<BlockId> blocks;
+  std::vector<uint8_t> light;
+};
+
+struct ChunkMeshData {
+  std::array<std::vector<ChunkVertex>, kRenderLayerCount> layers;
+};
+
+struct WorldCursor {
+  const World* world = nullptr;
+  const Chunk* chunk = nullptr;
+  Int3 block{0, 0, 0};
+  Int3 chunk_coord{0, 0, 0};
+  int index = 0;
+
+  WorldCursor(const World& world_ref, const Int3& start);
+  void Seek(const Int3& target) {
+    block = target;
+    index = ChunkDims::Index(ChunkDims::LocalCoord(target.x),
+                             ChunkDims::LocalCoord(target.y),
+                             ChunkDims::LocalCoord(target.z));
+    const Int3 coord{ChunkDims::ChunkCoord(target.x),
+                     ChunkDims::ChunkCoord(target.y),
+                     ChunkDims::ChunkCoord(target.z)};
+    if (coord.x != chunk_coord.x || coord.y != chunk_coord.y ||
+        coord.z != chunk_coord.z) {
+      Resolve(coord);
+    }
+  }
+  void Step(int dx, int dy, int dz) {
+    if (dx != 0) {
+      StepAxis(0, dx);
+    }
+    if (dy != 0) {
+      StepAxis(1, dy);
+    }
+    if (dz != 0) {
+      StepAxis(2, dz);
+    }
+  }
+  BlockId Get() const {
+    return chunk ? chunk->voxels.blocks[static_cast<size_t>(index)]
+                 : BlockId::Air;
+  }
+
+ private:
+  void StepAxis(int axis, int sign) {
+    if (sign < -1 || sign > 1) {
+      Seek({block.x + (axis == 0 ? sign : 0), block.y + (axis == 1 ? sign : 0),
+            block.z + (axis == 2 ? sign : 0)});
+      return;
+    }
+    (axis == 0 ? block.x : (axis == 1 ? block.y : block.z)) += sign;
+    const bool crosses = ChunkDims::CrossesBorder(index, axis, sign);
+    index = ChunkDims::Step(index, axis, sign);
+    if (crosses) {
+      CrossBorder(axis, sign);
+    }
+  }
+  void Resolve(const Int3& coord);
+  void CrossBorder(int axis, int sign);
 };
 
 struct RayHit {
@@ -91,6 +354,14 @@ struct RayHit {
   Int3 previous{0, 0, 0};
 };
 
+bool IsValidBlockId(uint8_t value);
+bool IsFluidBlock(BlockId id);
+bool IsSolidBlock(BlockId id);
+RenderLayer GetRenderLayer(BlockId id);
+bool IsOpaqueBlock(BlockId id);
+bool IsFaceVisible(BlockId id, BlockId neighbor);
+bool HasRandomTicks(BlockId id);
+int CountRandomTickBlocks(const VoxelChunk& chunk);
 int FloorDiv(int value, int divisor);
 int Mod(int value, int divisor);
 Int3 WorldToChunkCoord(int x, int y, int z);
@@ -100,28 +371,46 @@ Int3 WorldBlockFromPosition(const DirectX::XMFLOAT3& position);
 Chunk* FindChunk(World& world, const Int3& coord);
 const Chunk* FindChunk(const World& world, const Int3& coord);
 void MarkChunkDirty(World& world, const Int3& coord);
-void MarkNeighborChunksDirty(World& world, const Int3& coord);
+Chunk* FindNearbyChunk(World& world, Chunk& chunk, const Int3& offset);
+const Chunk* FindNearbyChunk(const World& world, const Chunk& chunk,
+                             const Int3& offset);
+BlockId GetBlockRelative(const World& world, const Chunk& chunk, int x, int y,
+                         int z);
+void MarkNeighborChunksDirty(Chunk& chunk);
+void MarkBorderChunksDirty(World& world, Chunk& chunk, const Int3& local);
 BlockId GetBlock(const World& world, int x, int y, int z);
 bool SetBlock(World& world, int x, int y, int z, BlockId id);
 
 RayHit RaycastVoxel(const World& world, const DirectX::XMFLOAT3& origin,
                     const DirectX::XMFLOAT3& direction, float max_distance);
 bool HandleBlockInteraction(World& world, const RayHit& hit, bool lmb_pressed,
-                            bool rmb_pressed);
+                            bool rmb_pressed, BlockId place_block);
 
 void GenerateFlatChunk(VoxelChunk& chunk);
+Chunk& AcquireChunk(World& world, const Int3& coord);
 Chunk& GetOrCreateChunk(World& world, const Int3& coord);
+size_t GetChunkMemoryBytes(const Chunk& chunk);
 void RemoveChunk(World& world, const Int3& coord);
+void AddTickChunk(World& world, Chunk& chunk);
+void RemoveTickChunk(World& world, Chunk& chunk);
 void StreamChunks(World& world, const DirectX::XMFLOAT3& camera_position);
+int CountDirtyChunks(const World& world);
 
 DirectX::XMFLOAT4 ApplyShade(const DirectX::XMFLOAT4& color, float shade);
 int GetTileIndex(BlockId id, FaceDir dir);
 std::array<DirectX::XMFLOAT2, 4> GetTileUVs(int tile_index);
-void AddFace(std::vector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
+void AddFace(FrameVector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
              const FaceDef& face, const DirectX::XMFLOAT4& color,
              int tile_index);
-void AddFaceScaled(std::vector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
+void AddFaceScaled(FrameVector<Vertex>& vertices, const DirectX::XMFLOAT3& base,
                    float scale, const FaceDef& face,
                    const DirectX::XMFLOAT4& color, int tile_index);
 
-std::vector<Vertex> BuildVoxelMesh(const World& world, const Chunk& chunk);
+int SelectChunkLod(const Int3& coord, const Int3& camera_chunk);
+void FillMeshGrid(const World& world, const Chunk& chunk, int lod,
+                  MeshGrid& grid);
+uint64_t HashMeshGrid(const MeshGrid& grid);
+uint64_t CheckMeshGrid(const MeshGrid& grid);
+void BuildVoxelMesh(const MeshGrid& grid, bool ambient_occlusion,
+                    ChunkMeshData& mesh);
+void ReserveMeshScratch(MeshGrid& grid, ChunkMeshData& mesh);
@@ -247,6 +247,50 @@ class World {
     }
   }
 
+  class Cursor {
+   public:
+    Cursor(const World& world, Int3 block) : world_(world) { Seek(block); }
+
+    void Seek(Int3 block) {
+      const Int3 chunk_coord{FloorDiv(block.x, kChunkSize),
+                             FloorDiv(block.y, kChunkSize),
+                             FloorDiv(block.z, kChunkSize)};
+      if (!resolved_ || !(chunk_coord == chunk_coord_)) {
+        chunk_ = world_.GetChunk(chunk_coord);
+        chunk_coord_ = chunk_coord;
+        resolved_ = true;
+      }
+      block_ = block;
+      local_ = {Mod(block.x, kChunkSize), Mod(block.y, kChunkSize),
+                Mod(block.z, kChunkSize)};
+    }
+
+    void Step(int dx, int dy, int dz) {
+      const Int3 local{local_.x + dx, local_.y + dy, local_.z + dz};
+      if (local.x < 0 || local.x >= kChunkSize || local.y < 0 ||
+          local.y >= kChunkSize || local.z < 0 || local.z >= kChunkSize) {
+        Seek({block_.x + dx, block_.y + dy, block_.z + dz});
+        return;
+      }
+      block_ = {block_.x + dx, block_.y + dy, block_.z + dz};
+      local_ = local;
+    }
+
+    BlockId Get() const {
+      return chunk_ ? chunk_->Get(local_.x, local_.y, local_.z) : BlockId::Air;
+    }
+
+    Int3 block() const { return block_; }
+
+   private:
+    const World& world_;
+    const Chunk* chunk_ = nullptr;
+    Int3 chunk_coord_{0, 0, 0};
+    Int3 block_{0, 0, 0};
+    Int3 local_{0, 0, 0};
+    bool resolved_ = false;
+  };
+
  private:
   struct MeshBuffers {
     std::vector<float> positions;
@@ -423,8 +467,10 @@ RayHit RaycastVoxels(const World& world, Vector3 origin, Vector3 direction,
   direction.y /= length;
   direction.z /= length;
 
-  Int3 current{FloorToInt(origin.x), FloorToInt(origin.y), FloorToInt(origin.z)};
-  Int3 previous = current;
+  World::Cursor cursor(
+      world, {FloorToInt(origin.x), FloorToInt(origin.y), FloorToInt(origin.z)});
+  const Int3 start = cursor.block();
+  Int3 previous = start;
 
   const int step_x = (direction.x > 0.0f) ? 1 : (direction.x < 0.0f ? -1 : 0);
   const int step_y = (direction.y > 0.0f) ? 1 : (direction.y < 0.0f ? -1 : 0);
@@ -439,28 +485,28 @@ RayHit RaycastVoxels(const World& world, Vector3 origin, Vector3 direction,
   float t_delta_z = inf;
 
   if (step_x != 0) {
-    const float next = (step_x > 0) ? static_cast<float>(current.x + 1)
-                                    : static_cast<float>(current.x);
+    const float next = (step_x > 0) ? static_cast<float>(start.x + 1)
+                                    : static_cast<float>(start.x);
     t_max_x = (next - origin.x) / direction.x;
     t_delta_x = 1.0f / std::abs(direction.x);
   }
   if (step_y != 0) {
-    const float next = (step_y > 0) ? static_cast<float>(current.y + 1)
-                                    : static_cast<float>(current.y);
+    const float next = (step_y > 0) ? static_cast<float>(start.y + 1)
+                                    : static_cast<float>(start.y);
     t_max_y = (next - origin.y) / direction.y;
     t_delta_y = 1.0f / std::abs(direction.y);
   }
   if (step_z != 0) {
-    const float next = (step_z > 0) ? static_cast<float>(current.z + 1)
-                                    : static_cast<float>(current.z);
+    const float next = (step_z > 0) ? static_cast<float>(start.z + 1)
+                                    : static_cast<float>(start.z);
     t_max_z = (next - origin.z) / direction.z;
     t_delta_z = 1.0f / std::abs(direction.z);
   }
 
-  if (world.GetBlock(current.x, current.y, current.z) != BlockId::Air) {
+  if (cursor.Get() != BlockId::Air) {
     result.hit = true;
-    result.block = current;
-    result.previous = current;
+    result.block = start;
+    result.previous = start;
     return result;
   }
 
@@ -470,28 +516,28 @@ RayHit RaycastVoxels(const World& world, Vector3 origin, Vector3 direction,
   while (distance <= max_distance) {
     if (t_max_x < t_max_y) {
       if (t_max_x < t_max_z) {
-        previous = current;
-        current.x += step_x;
+        previous = cursor.block();
+        cursor.Step(step_x, 0, 0);
         distance = t_max_x;
         t_max_x += t_delta_x;
         hit_normal = {-static_cast<float>(step_x), 0.0f, 0.0f};
       } else {
-        previous = current;
-        current.z += step_z;
+        previous = cursor.block();
+        cursor.Step(0, 0, step_z);
         distance = t_max_z;
         t_max_z += t_delta_z;
         hit_normal = {0.0f, 0.0f, -static_cast<float>(step_z)};
       }
     } else {
       if (t_max_y < t_max_z) {
-        previous = current;
-        current.y += step_y;
+        previous = cursor.block();
+        cursor.Step(0, step_y, 0);
         distance = t_max_y;
         t_max_y += t_delta_y;
         hit_normal = {0.0f, -static_cast<float>(step_y), 0.0f};
       } else {
-        previous = current;
-        current.z += step_z;
+        previous = cursor.block();
+        cursor.Step(0, 0, step_z);
         distance = t_max_z;
         t_max_z += t_delta_z;
         hit_normal = {0.0f, 0.0f, -static_cast<float>(step_z)};
@@ -502,9 +548,9 @@ RayHit RaycastVoxels(const World& world, Vector3 origin, Vector3 direction,
       break;
     }
 
-    if (world.GetBlock(current.x, current.y, current.z) != BlockId::Air) {
+    if (cursor.Get() != BlockId::Air) {
       result.hit = true;
-      result.block = current;
+      result.block = cursor.block();
       result.previous = previous;
       result.normal = hit_normal;
       return result;
@@ -550,7 +596,7 @@ int main() {
                 world.SetBlock(hit.block.x, hit.block.y, hit.block.z, BlockId::Air);
     }
     if (hit.hit && IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
-      if (world.GetBlock(hit.previous.x, hit.previous.y, hit.previous.z) == BlockId::Air) {
+      if (World::Cursor(world, hit.previous).Get() == BlockId::Air) {
         changed = changed || world.SetBlock(hit.previous.x, hit.previous.y,
                                             hit.previous.z, BlockId::Dirt);
       }